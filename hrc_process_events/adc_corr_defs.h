@@ -124,4 +124,15 @@ extern void apply_adc_correction(ADC_CORR_P_T,
                                  INPUT_PARMS_P_T, 
                                  EVENT_REC_P_T);
 
+/* 10/2026 - routines to set up, apply and free the per tap calibration
+ * records of both axes (hpe_tap_cal.c) */
+extern HPE_TAP_CAL_TABLE_P_T allocate_tap_cal_table(INPUT_PARMS_P_T,
+                                                    ADC_CORR_P_T,
+                                                    ADC_CORR_P_T,
+                                                    DEGAP_CONFIG_P_T,
+                                                    dsErrList*);
+extern void apply_tap_cal_adc(HPE_TAP_CAL_TABLE_P_T,
+                              EVENT_REC_P_T);
+extern void deallocate_tap_cal_table(HPE_TAP_CAL_TABLE_P_T*);
+
 #endif   /* last line of header file- closes #ifndef ADC_CORR_DEFS_H */
@@ -37,6 +37,7 @@
   check_evt_flatness()
   check_hyperbolic()  
   hyperbolic_help()
+  check_adc_filters()
 
   For details on the functionality of any of the above listed modules, 
   please see the 'description' comment preceding the specific module's 
@@ -58,6 +59,8 @@
   JCC(6/7/01) - passing maxlen-1 to dmGetScalar_c
   JCC(7/2003)-reset status bit before reapply any correction, such as,
                   hyperbolic amp_saturation evt_flatness 
+  10/2026-add check_adc_filters(), which performs the three tests on a
+          range of events in one pass (batch stage hpe_stage_filters).
 *H***********************************************************************/
 
 #ifndef HRC_PROCESS_EVENTS_H
@@ -657,3 +660,166 @@ void check_evt_flatness(
      bad_bit_mask = HDET_V_AMP_FLAT_STS;
   }    
 }
+
+
+/*---------------------------------------------------------
+ * 10/2026 - routine to evaluate the hyperbolic, saturation and
+ *           flatness tests on the events evt_p[0..num_evt-1] in one
+ *           pass. A test is skipped if its coefficients are NULL; the
+ *           results are those of check_hyperbolic(),
+ *           check_amp_saturation() and check_evt_flatness().
+ *           The six amplitudes of an event are read once, the sums,
+ *           fp and fb are computed once, and the fb bounds of the
+ *           hyperbolic test and the saturation and flatness tests are
+ *           evaluated without branches into one status mask. The events
+ *           within the fb bounds are collected, ADC_FILTER_CHUNK at a
+ *           time, for the (sqrt) hyperbola test of hyperbolic_help().
+ *---------------------------------------------------------*/
+#define ADC_FILTER_CHUNK   64
+
+void check_adc_filters(
+     EVENT_REC_P_T evt_p,             /* i/o: first event */
+     long          num_evt,           /* i: number of events */
+     HYP_TEST_P_T  hyp_coeffs_p,      /* i: hyperbolic test (or NULL) */
+     SAT_TEST_P_T  sat_test_coeffs_p, /* i: saturation test (or NULL) */
+     double*       flat_coeff_p)      /* i: flatness limit (or NULL) */
+{
+  HRC_STATUS_T hyp_mask[HDET_NUM_PLANES] = {HDET_U_HYP_STS, HDET_V_HYP_STS};
+  HRC_STATUS_T sat_mask[HDET_NUM_PLANES] = {HDET_U_AMP_SAT_STS,
+                                            HDET_V_AMP_SAT_STS};
+  HRC_STATUS_T flat_mask[HDET_NUM_PLANES] = {HDET_U_AMP_FLAT_STS,
+                                             HDET_V_AMP_FLAT_STS};
+  HRC_STATUS_T clear_mask = 0;
+  double C[HDET_NUM_PLANES], A[HDET_NUM_PLANES], B[HDET_NUM_PLANES];
+  double H_plus_delta[HDET_NUM_PLANES], H_minus_delta[HDET_NUM_PLANES];
+  double H_dplus_A[HDET_NUM_PLANES], H_dminus_A[HDET_NUM_PLANES];
+  int    a_ok[HDET_NUM_PLANES];
+  double flat_coeff = (flat_coeff_p != NULL) ? *flat_coeff_p : 0.0;
+  int    do_hyp = (hyp_coeffs_p != NULL);
+  int    do_sat = (sat_test_coeffs_p != NULL);
+  int    do_flat = (flat_coeff_p != NULL);
+  double fp_v[ADC_FILTER_CHUNK * HDET_NUM_PLANES];
+  double fb_v[ADC_FILTER_CHUNK * HDET_NUM_PLANES];
+  long   hyp_index[ADC_FILTER_CHUNK * HDET_NUM_PLANES];
+  long   first, last, num_hyp, ii, jj;
+  short  pp;
+
+  if (do_hyp)
+  {
+     clear_mask |= (HDET_U_HYP_STS | HDET_V_HYP_STS);
+     for (pp = 0; pp < HDET_NUM_PLANES; pp++)
+     {
+        short cc = (pp == HDET_PLANE_X) ? hyp_coeffs_p->U_index :
+                                          hyp_coeffs_p->V_index;
+        A[pp] = hyp_coeffs_p->A[cc];
+        B[pp] = hyp_coeffs_p->B[cc];
+        C[pp] = hyp_coeffs_p->C[cc];
+        H_plus_delta[pp] = hyp_coeffs_p->H[cc] + hyp_coeffs_p->H_delta[cc];
+        H_minus_delta[pp] = hyp_coeffs_p->H[cc] - hyp_coeffs_p->H_delta[cc];
+        H_dminus_A[pp] = H_minus_delta[pp] - A[pp];
+        H_dplus_A[pp] = H_plus_delta[pp] - A[pp];
+        a_ok[pp] = (fabs(A[pp]) >= DBL_EPSILON);
+     }
+  }
+  if (do_sat)
+  {
+     clear_mask |= (HDET_U_AMP_SAT_STS | HDET_V_AMP_SAT_STS);
+  }
+  if (do_flat)
+  {
+     clear_mask |= (HDET_U_AMP_FLAT_STS | HDET_V_AMP_FLAT_STS);
+  }
+  if (clear_mask == 0)
+  {
+     return;
+  }
+
+  for (first = 0; first < num_evt; first = last)
+  {
+     last = (num_evt - first > ADC_FILTER_CHUNK) ? first + ADC_FILTER_CHUNK :
+                                                   num_evt;
+     num_hyp = 0;
+
+     for (ii = first; ii < last; ii++)
+     {
+        HRC_STATUS_T bits = 0;
+        double low = 0.0;
+        double high = 0.0;
+        short  num_amps = 0;
+
+        if (do_sat)
+        {
+           short cc = sat_test_coeffs_p->ampsf_index[evt_p[ii].amp_sf];
+           low = sat_test_coeffs_p->adc_low[cc];
+           high = sat_test_coeffs_p->adc_high[cc];
+           num_amps = sat_test_coeffs_p->ntaps[cc];
+        }
+
+        for (pp = 0; pp < HDET_NUM_PLANES; pp++)
+        {
+           /* the amplitudes are read once */
+           double ADC1 = evt_p[ii].amps_dd[pp][HDET_1ST_AMP];
+           double ADC2 = evt_p[ii].amps_dd[pp][HDET_2ND_AMP];
+           double ADC3 = evt_p[ii].amps_dd[pp][HDET_3RD_AMP];
+
+           if (do_hyp)
+           {
+              double sum_ADC = ADC1 + ADC2 + ADC3;
+              int    sum_ok = (fabs(sum_ADC) > DBL_EPSILON);
+              double sum_div = (sum_ok) ? sum_ADC : 1.0;
+              double fb = ADC2 / sum_div;
+              int    out = (fb < C[pp]) | (fb < 0.0) | (fb > H_dplus_A[pp]);
+
+              bits |= hyp_mask[pp] * (HRC_STATUS_T) (sum_ok & out);
+
+              /* within the bounds: left to the hyperbola */
+              fp_v[num_hyp] = fabs((ADC3 - ADC1) / sum_div);
+              fb_v[num_hyp] = fb;
+              hyp_index[num_hyp] = (ii << 1) | pp;
+              num_hyp += (sum_ok & !out & a_ok[pp]);
+           }
+           if (do_sat)
+           {
+              int below1 = (ADC1 < low);
+              int below2 = (ADC2 < low);
+              int below3 = (ADC3 < low);
+              int num_below = below1 + below2 + below3;
+              int num_above = (!below1 & (ADC1 > high)) +
+                              (!below2 & (ADC2 > high)) +
+                              (!below3 & (ADC3 > high));
+
+              bits |= sat_mask[pp] * (HRC_STATUS_T)
+                      ((num_above >= num_amps) | (num_below >= num_amps));
+           }
+           if (do_flat)
+           {
+              int    adc2_ok = (fabs(ADC2) > DBL_EPSILON);
+              double adc2_div = (adc2_ok) ? ADC2 : 1.0;
+
+              bits |= flat_mask[pp] * (HRC_STATUS_T)
+                      (adc2_ok & ((ADC1 / adc2_div) >= flat_coeff) &
+                                 ((ADC3 / adc2_div) >= flat_coeff));
+           }
+        }
+
+        evt_p[ii].status = (evt_p[ii].status & ~clear_mask) | bits;
+     }
+
+     for (jj = 0; jj < num_hyp; jj++)
+     {
+        double fp = fp_v[jj];
+        double fb = fb_v[jj];
+        ii = hyp_index[jj] >> 1;
+        pp = (short) (hyp_index[jj] & 1);
+
+        if ( ((fb <= H_dminus_A[pp]) &&
+              !((fp > hyperbolic_help(fb, H_minus_delta[pp], A[pp], B[pp])) &&
+                (fp < hyperbolic_help(fb, H_plus_delta[pp],  A[pp], B[pp])))) ||
+             ((fb > H_dminus_A[pp]) &&
+              (fp >= hyperbolic_help(fb, H_plus_delta[pp],  A[pp], B[pp]))) )
+        {
+           evt_p[ii].status |= hyp_mask[pp];
+        }
+     }
+  }
+} /* end: check_adc_filters */
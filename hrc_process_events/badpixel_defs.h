@@ -73,10 +73,52 @@ typedef struct bad_pix_t {
    long  x[2];    /* chip x coords */
    long  y[2];    /* chip y coords */
    unsigned short status; 
-   struct bad_pix_t *next;   /* pointer to next bad pixel in list */
 } BAD_PIX_T,  *BAD_PIX_P_T;
 
-typedef BAD_PIX_P_T BAD_PIX_A_T[4];
+
+/*  the following structure holds the hot spots of a chip, sorted on x[0]
+ *  then y[0] without duplicates (see sort_bad_pixel_list()).
+ *
+ *  BAD PIXEL ARRAY STRUCTURE
+ */
+
+#define BPIX_NUM_CHIPS    4
+
+typedef struct bad_pix_list_t {
+   BAD_PIX_P_T  pix;      /* hot spots of the chip  */
+   long         num_pix;  /* number of hot spots    */
+} BAD_PIX_LIST_T, *BAD_PIX_LIST_P_T;
+
+typedef BAD_PIX_LIST_T BAD_PIX_A_T[BPIX_NUM_CHIPS];
+
+
+
+/*  the following defines and structure hold the per chip index of the hot
+ *  spots used by check_for_bad_pixels(). The bounding box of the hot spots
+ *  of a chip is split into square tiles of BPIX_TILE_SIZE pixels a side.
+ *  A tile with no hot spot has a NULL pointer, a tile covered by a hot
+ *  spot points to a shared full tile, and any other tile is a bitmap with
+ *  one bit per pixel, so the memory grows with the edges of the hot spots
+ *  rather than their area. If the index of a chip could not be built
+ *  (tiles == NULL) the hot spot array of the chip is searched instead.
+ *
+ *  BAD PIXEL INDEX STRUCTURE
+ */
+
+#define BPIX_TILE_BITS    6                      /* 64 x 64 pixel tiles   */
+#define BPIX_TILE_SIZE    (1L << BPIX_TILE_BITS)
+#define BPIX_TILE_MASK    (BPIX_TILE_SIZE - 1)
+#define BPIX_TILE_WORDS   ((BPIX_TILE_SIZE * BPIX_TILE_SIZE) / 32)
+
+typedef struct bad_pix_map_t {
+   long           x_min;        /* chip x of the first tile column      */
+   long           y_min;        /* chip y of the first tile row         */
+   long           num_tiles_x;  /* number of tile columns               */
+   long           num_tiles_y;  /* number of tile rows                  */
+   unsigned int** tiles;        /* tile bitmaps (row major), or NULL    */
+} BAD_PIX_MAP_T, *BAD_PIX_MAP_P_T;
+
+typedef BAD_PIX_MAP_T BAD_PIX_INDEX_T[BPIX_NUM_CHIPS];
 
 
 /*  The following structure is used by hrc_process_events to store information
@@ -103,19 +145,19 @@ typedef struct bad_pix_setup_t {
  
 
 /**
-extern void update_bad_pixel_list(BAD_PIX_P_T, BAD_PIX_P_T*);
+extern void sort_bad_pixel_list(BAD_PIX_LIST_P_T);
 
-extern void cleanup_bad_pixel_data(BAD_PIX_A_T);
+extern void cleanup_bad_pixel_data(BAD_PIX_A_T, BAD_PIX_INDEX_T);
 
-extern boolean load_bad_pixel_files(char*, BAD_PIX_P_T*);
+extern boolean load_bad_pixel_files(char*, BAD_PIX_A_T, BAD_PIX_INDEX_T);
 
 extern boolean open_bad_pixel_file(BAD_PIX_SETUP_P_T);
 
-extern void check_for_bad_pixels(BAD_PIX_A_T, EVENT_REC_P_T); 
+extern void check_for_bad_pixels(BAD_PIX_A_T, BAD_PIX_INDEX_T, EVENT_REC_P_T); 
 
 extern short map_bad_pixel_column(char[]);
 
-extern void load_bad_pixel_data(BAD_PIX_SETUP_P_T, BAD_PIX_P_T*);
+extern boolean load_bad_pixel_data(BAD_PIX_SETUP_P_T, BAD_PIX_A_T);
 
 extern void close_bad_pixel_file(BAD_PIX_SETUP_P_T); 
 **/
@@ -29,10 +29,13 @@
 
   The modules in this file are:
 
-     update_bad_pixel_list()
+     sort_bad_pixel_list()
+     compare_bad_pixels()
      cleanup_bad_pixel_data()
      check_for_bad_pixels()
      load_bad_pixel_files()
+     build_bad_pixel_index()
+     set_bad_pixel_tile()
      open_bad_pixel_file()
      map_bad_pixel_column()
      load_bad_pixel_data()
@@ -40,6 +43,14 @@
   For details on the functionality of any of the above listed modules, 
   please see the 'description' comment preceding the specific module's 
   source code.
+
+* REVISION HISTORY:
+  10/2026 - check_for_bad_pixels() looks the event up in a per chip
+            tiled bitmap (build_bad_pixel_index) instead of walking the
+            hot spot list.
+  10/2026 - keep the hot spots of each chip in an array which is sorted
+            once every file is loaded (sort_bad_pixel_list), instead of
+            inserting each row into a sorted linked list.
  
 *H***********************************************************************/
 
@@ -49,107 +60,105 @@
 #define HRC_PROCESS_EVENTS_H
 #endif 
 
+#include <limits.h>
+
+#define BPIX_MIN(a,b)   (((a) < (b)) ? (a) : (b))
+#define BPIX_MAX(a,b)   (((a) > (b)) ? (a) : (b))
+
+/* tile shared by every index tile covered by a hot spot */
+static unsigned int bpix_full_tile[BPIX_TILE_WORDS];
+
+static boolean set_bad_pixel_tile(BAD_PIX_MAP_P_T, long, long, BAD_PIX_P_T);
+static int compare_bad_pixels(const void*, const void*);
+
 
 /*************************************************************************
 
-* FUNCTION NAME: update_bad_pixel_list()  
+* FUNCTION NAME: sort_bad_pixel_list()  
 
-* DESCRIPTION:  The routine update_bad_pixel_list() is called on by
-  load_bad_pixel_files() to insert hot spot (bad pixel) entries into the
-  linked list pointed to by header pointer passed in as the second 
-  function argument.
+* DESCRIPTION:  The routine sort_bad_pixel_list() is called on by
+  load_bad_pixel_files() once every file is loaded, to sort the hot spot
+  (bad pixel) entries of a chip's array and remove the duplicates.
 
-  The routine inserts elements into a linked list using the x coordinate 
-  of the entry as a primary key. If more than one entry contains the same 
-  x coordinate, the y coordinate is used as a second key. Duplicates 
-  (items with the same x and y coordinates) are not maintained in the 
-  list.   
+  The entries are sorted using the x coordinate of the entry as a primary
+  key. If more than one entry contains the same x coordinate, the y 
+  coordinate is used as a second key. Duplicates (items with the same x 
+  and y coordinates) are not maintained in the array.   
 
 * NOTES: 
 
-  The routine frees the memory pointed to by the current hot pixel 
-  pointer (first argument to function) if the linked list already 
-  contains an entry with the same x and y coordinates. 
+  The end coordinates are used as further keys so that duplicates are
+  next to each other and the order does not depend on the order of the
+  rows in the files.
 
 *************************************************************************/
 
-void update_bad_pixel_list (
-   BAD_PIX_P_T curr_p,  /* I  - current hot pixel    */
-   BAD_PIX_P_T* head_p) /* I/O - hot pixel list head */
+void sort_bad_pixel_list (
+   BAD_PIX_LIST_P_T list_p) /* I/O - hot pixel array of a chip */
 {
-   int found = FALSE; 
-   BAD_PIX_P_T prev_p = NULL;
-   BAD_PIX_P_T temp_p = *head_p;
+   long ii;
+   long nn = 0;
 
-   /* iterate through the linked list to find insertion position */
-   while (!found)
+   if (list_p->num_pix > 1)
    {
-      if (temp_p == NULL)
-      { 
-         /* at the end of the list */ 
-         found = TRUE;
-      }
-      else if ((temp_p->x[0] < curr_p->x[0]) || 
-               ((temp_p->x[0] == curr_p->x[0]) && 
-                (temp_p->y[0] < curr_p->y[0]))) 
-      { 
-         /* not upto correct position in list, move to next list element */
-         prev_p = temp_p;
-         temp_p = temp_p->next; 
-      } 
-      else
-      {
-         /* have found the correct position in the list */ 
-         found = TRUE;
-      } 
-   } 
+      qsort(list_p->pix, list_p->num_pix, sizeof(BAD_PIX_T),
+            compare_bad_pixels);
 
-   if (prev_p == NULL)
-   {
-      /* insert at head of list */
-      if (temp_p != NULL)
+      /* keep the first of each run of equal entries */
+      for (ii = 1; ii < list_p->num_pix; ii++)
       {
-         if ((temp_p->x[0] == curr_p->x[0]) && (temp_p->x[1] == curr_p->x[1]) &&
-             (temp_p->y[0] == curr_p->y[0]) && (temp_p->y[1] == curr_p->y[1])) 
+         if (compare_bad_pixels(&list_p->pix[nn], &list_p->pix[ii]) != 0)
          {
-            /* entry is already in list */
-            free (curr_p);
+            list_p->pix[++nn] = list_p->pix[ii];
          }
-         else
-         {
-            curr_p->next = *head_p; 
-            *head_p = curr_p; 
-         } 
-      } 
-      else
-      {
-         curr_p->next = NULL;
-         *head_p = curr_p;
-      } 
+      }
+      list_p->num_pix = nn + 1;
+   }
+}
+
+
+
+
+/*************************************************************************
+
+* FUNCTION NAME: compare_bad_pixels()  
+
+* DESCRIPTION:  The routine compare_bad_pixels() is the qsort() compare
+  function of sort_bad_pixel_list(). Entries are ordered on x[0], y[0],
+  x[1] then y[1].
+
+*************************************************************************/
+
+static int compare_bad_pixels (
+   const void* aa,   /* I - first hot pixel  */
+   const void* bb)   /* I - second hot pixel */
+{
+   const BAD_PIX_T* a_p = (const BAD_PIX_T*) aa;
+   const BAD_PIX_T* b_p = (const BAD_PIX_T*) bb;
+   int cmp;
+
+   if (a_p->x[0] != b_p->x[0])
+   {
+      cmp = (a_p->x[0] < b_p->x[0]) ? -1 : 1;
+   }
+   else if (a_p->y[0] != b_p->y[0])
+   {
+      cmp = (a_p->y[0] < b_p->y[0]) ? -1 : 1;
+   }
+   else if (a_p->x[1] != b_p->x[1])
+   {
+      cmp = (a_p->x[1] < b_p->x[1]) ? -1 : 1;
+   }
+   else if (a_p->y[1] != b_p->y[1])
+   {
+      cmp = (a_p->y[1] < b_p->y[1]) ? -1 : 1;
    }
    else
    {
-      /* insert after temp element */
-      if (temp_p != NULL)
-      {
-         if ((temp_p->x[0] == curr_p->x[0]) && (temp_p->x[1] == curr_p->x[1]) &&
-             (temp_p->y[0] == curr_p->y[0]) && (temp_p->y[1] == curr_p->y[1]))
-         {
-            /* entry is already in list */
-            free (curr_p);
-         }
-         else
-         {
-            curr_p->next = temp_p;
-            prev_p->next = curr_p; 
-         }
-      } 
-      else
-      {
-         curr_p->next = NULL;
-         prev_p->next = curr_p; 
-      } 
-   } 
+      cmp = 0;
+   }
+
+   return (cmp);
 }
 
 
@@ -162,26 +171,40 @@ void update_bad_pixel_list (
 * DESCRIPTION:  The routine cleanup_bad_pixel_data() is called by 
 
   hrc_process_events to deallocate the memory that was used to store the 
-  linked list of hot spots. The routine takes a pointer to the head of a 
-  linked list and does not return a value. The routine iterates through 
-  the linked list and frees all of the memory allocated to the elements 
-  of the linked list.   
+  arrays of hot spots. The routine takes the per chip arrays and index 
+  and does not return a value. The routine frees the memory of each 
+  chip's array and the tiles of each chip's index.
 
 *************************************************************************/
 
-void cleanup_bad_pixel_data(BAD_PIX_A_T bad_pix_list) /* I/O */  
+void cleanup_bad_pixel_data(
+   BAD_PIX_A_T     bad_pix_list,  /* I/O - hot pixel arrays          */
+   BAD_PIX_INDEX_T bad_pix_index) /* I/O - hot pixel chip index      */
 {
    int rr;
-   BAD_PIX_P_T current_p; 
+   long tt;
  
-   /* iterate through list to deallocate memory */
-   for (rr = 4; rr--; )
+   /* iterate through the chips to deallocate memory */
+   for (rr = BPIX_NUM_CHIPS; rr--; )
    {
-      while (bad_pix_list[rr] != NULL)
+      if (bad_pix_list[rr].pix != NULL)
       {
-         current_p = bad_pix_list[rr]; 
-         bad_pix_list[rr] = bad_pix_list[rr]->next; 
-         free(current_p);
+         free(bad_pix_list[rr].pix);
+      }
+      memset(&bad_pix_list[rr], 0, sizeof(BAD_PIX_LIST_T));
+
+      if (bad_pix_index[rr].tiles != NULL)
+      {
+         for (tt = bad_pix_index[rr].num_tiles_x *
+                   bad_pix_index[rr].num_tiles_y; tt--; )
+         {
+            if (bad_pix_index[rr].tiles[tt] != bpix_full_tile)
+            {
+               free(bad_pix_index[rr].tiles[tt]);
+            }
+         }
+         free(bad_pix_index[rr].tiles);
+         bad_pix_index[rr].tiles = NULL;
       }
    }
 }
@@ -195,29 +218,35 @@ void cleanup_bad_pixel_data(BAD_PIX_A_T bad_pix_list) /* I/O */
 
 * DESCRIPTION:  The routine load_bad_pixel_files() is called by 
   hrc_process_events to read in a stack of hot spot (bad pixel) files and 
-  create a linked list of the coordinates. 
+  create a per chip array of the coordinates. 
  
-  The routine accepts a character string and a head pointer for the linked 
-  list. A character string value of "NONE" or "none" indicates that no bad
+  The routine accepts a character string and the per chip arrays. A 
+  character string value of "NONE" or "none" indicates that no bad
   pixel files are to be loaded. Otherwise the routine calls on various hot 
-  pixel routines to open the files, read in the data, and put the data 
-  into the linked list. 
+  pixel routines to open the files and append their rows to the arrays. 
+  Once every file is loaded, each chip's array is sorted and the 
+  duplicates removed, and the per chip index used by 
+  check_for_bad_pixels() is built from the arrays.
 
 * NOTES: 
 
   The routine returns a value of TRUE if at least one bad pixel file was 
   successfully opened.  A value of FALSE indicates that no bad pixel
-  files were opened or that the bad pixel stack was set to "NONE"/"none".  
+  files were opened, that the bad pixel stack was set to "NONE"/"none" 
+  or that the memory for the arrays could not be allocated.  
  
 *************************************************************************/
  
 boolean load_bad_pixel_files(
-   char*         badpix_file,   /* I - bad pixel file name   */
-   BAD_PIX_P_T*  hotpix_list_p) /* I/O - hot pix list        */
+   char*           badpix_file,   /* I - bad pixel file name   */
+   BAD_PIX_A_T     hotpix_list,   /* I/O - hot pix arrays      */
+   BAD_PIX_INDEX_T hotpix_index)  /* O - hot pix chip index    */
 {
    BAD_PIX_SETUP_T  bad_hk;  /* bad pixel house keeping data */
    char*       bad_p;
    boolean     opened = FALSE; /* TRUE if file successfully opened */
+   boolean     loaded = TRUE;  /* FALSE if out of memory */
+   int         chip;
  
    bad_hk.stack = NULL;
    if ((ds_strcmp_cis(badpix_file, "none") == 0) ||
@@ -239,7 +268,7 @@ boolean load_bad_pixel_files(
  
       if (opened |= (open_bad_pixel_file(&bad_hk)))
       {
-         load_bad_pixel_data(&bad_hk, hotpix_list_p);
+         loaded &= load_bad_pixel_data(&bad_hk, hotpix_list);
  
          /* close bad pixel file */
          close_bad_pixel_file(&bad_hk); 
@@ -257,12 +286,210 @@ boolean load_bad_pixel_files(
       stk_close(bad_hk.stack);  
    }
 
+   if (opened && !loaded)
+   {
+      /* out of memory- continue without the hot spots */
+      cleanup_bad_pixel_data(hotpix_list, hotpix_index);
+      opened = FALSE;
+   }
+   else if (opened)
+   {
+      for (chip = 0; chip < BPIX_NUM_CHIPS; chip++)
+      {
+         sort_bad_pixel_list(&hotpix_list[chip]);
+      }
+      build_bad_pixel_index(hotpix_list, hotpix_index);
+   }
+
    return (opened); 
 }
 
 
 
 
+/*************************************************************************
+ 
+* FUNCTION NAME: build_bad_pixel_index() 
+
+* DESCRIPTION:  The routine build_bad_pixel_index() is called by 
+  load_bad_pixel_files() to build, for each chip, the tiled bitmap of 
+  the hot spots in the chip's array (see BAD_PIX_MAP_T). The tiles
+  cover the bounding box of the chip's hot spots, clipped to the range 
+  of the short chip coordinates the events are checked with.
+
+* NOTES: 
+
+  If the memory of a chip's index can not be allocated, the index of the
+  chip is left empty (tiles == NULL) and check_for_bad_pixels() searches
+  the chip's array instead.
+ 
+*************************************************************************/
+
+void build_bad_pixel_index(
+   BAD_PIX_A_T     hotpix_list,   /* I - hot pixel arrays            */
+   BAD_PIX_INDEX_T hotpix_index)  /* O - hot pixel chip index        */
+{
+   BAD_PIX_MAP_P_T map_p;
+   BAD_PIX_P_T     curr_p;
+   BAD_PIX_P_T     end_p;
+   long  x_max, y_max;
+   long  tx, ty, tx0, tx1, ty0, ty1;
+   long  num_tiles;
+   boolean ok;
+   int   chip;
+
+   memset(bpix_full_tile, 0xFF, sizeof(bpix_full_tile));
+
+   for (chip = 0; chip < BPIX_NUM_CHIPS; chip++)
+   {
+      map_p = &hotpix_index[chip];
+      memset(map_p, 0, sizeof(BAD_PIX_MAP_T));
+
+      /* bounding box of the chip's hot spots */
+      map_p->x_min = SHRT_MAX;
+      map_p->y_min = SHRT_MAX;
+      x_max = SHRT_MIN;
+      y_max = SHRT_MIN;
+      end_p = hotpix_list[chip].pix + hotpix_list[chip].num_pix;
+      for (curr_p = hotpix_list[chip].pix; curr_p < end_p; curr_p++)
+      {
+         if ((curr_p->x[0] <= curr_p->x[1]) && (curr_p->y[0] <= curr_p->y[1]))
+         {
+            map_p->x_min = BPIX_MIN(map_p->x_min,
+                                    BPIX_MAX(curr_p->x[0], SHRT_MIN));
+            map_p->y_min = BPIX_MIN(map_p->y_min,
+                                    BPIX_MAX(curr_p->y[0], SHRT_MIN));
+            x_max = BPIX_MAX(x_max, BPIX_MIN(curr_p->x[1], SHRT_MAX));
+            y_max = BPIX_MAX(y_max, BPIX_MIN(curr_p->y[1], SHRT_MAX));
+         }
+      }
+
+      if ((map_p->x_min > x_max) || (map_p->y_min > y_max))
+      {
+         /* no hot spots on this chip */
+         map_p->x_min = 0;
+         map_p->y_min = 0;
+         continue;
+      }
+
+      map_p->num_tiles_x = ((x_max - map_p->x_min) >> BPIX_TILE_BITS) + 1;
+      map_p->num_tiles_y = ((y_max - map_p->y_min) >> BPIX_TILE_BITS) + 1;
+      num_tiles = map_p->num_tiles_x * map_p->num_tiles_y;
+
+      ok = ((map_p->tiles =
+            (unsigned int**) calloc(num_tiles, sizeof(unsigned int*))) != NULL);
+
+      /* mark every tile each hot spot touches */
+      for (curr_p = hotpix_list[chip].pix; ok && (curr_p < end_p); curr_p++)
+      {
+         if ((curr_p->x[0] > curr_p->x[1]) || (curr_p->y[0] > curr_p->y[1]) ||
+             (curr_p->x[1] < map_p->x_min) || (curr_p->y[1] < map_p->y_min) ||
+             (curr_p->x[0] > x_max) || (curr_p->y[0] > y_max))
+         {
+            continue;
+         }
+
+         /* range of tiles the (clipped) hot spot falls on */
+         tx0 = BPIX_MAX(curr_p->x[0] - map_p->x_min, 0) >> BPIX_TILE_BITS;
+         tx1 = (BPIX_MIN(curr_p->x[1], x_max) - map_p->x_min) >> BPIX_TILE_BITS;
+         ty0 = BPIX_MAX(curr_p->y[0] - map_p->y_min, 0) >> BPIX_TILE_BITS;
+         ty1 = (BPIX_MIN(curr_p->y[1], y_max) - map_p->y_min) >> BPIX_TILE_BITS;
+
+         for (ty = ty0; ok && (ty <= ty1); ty++)
+         {
+            for (tx = tx0; ok && (tx <= tx1); tx++)
+            {
+               ok = set_bad_pixel_tile(map_p, tx, ty, curr_p);
+            }
+         }
+      }
+
+      if (!ok)
+      {
+         /* out of memory- fall back to the hot spot array */
+         if (map_p->tiles != NULL)
+         {
+            for (tx = num_tiles; tx--; )
+            {
+               if (map_p->tiles[tx] != bpix_full_tile)
+               {
+                  free(map_p->tiles[tx]);
+               }
+            }
+            free(map_p->tiles);
+         }
+         memset(map_p, 0, sizeof(BAD_PIX_MAP_T));
+      }
+   }
+}
+
+
+
+
+/*************************************************************************
+ 
+* FUNCTION NAME: set_bad_pixel_tile() 
+
+* DESCRIPTION:  The routine set_bad_pixel_tile() is called by 
+  build_bad_pixel_index() to set the bits of index tile (tx, ty) that
+  are covered by a hot spot. A tile the hot spot covers entirely becomes
+  the shared full tile; otherwise a bitmap is allocated for the tile if
+  it has none. FALSE is returned if the bitmap could not be allocated.
+ 
+*************************************************************************/
+
+static boolean set_bad_pixel_tile(
+   BAD_PIX_MAP_P_T map_p,    /* I/O - chip index                     */
+   long            tx,       /* I   - tile column                    */
+   long            ty,       /* I   - tile row                       */
+   BAD_PIX_P_T     curr_p)   /* I   - hot spot                       */
+{
+   unsigned int** tile_pp = &map_p->tiles[(ty * map_p->num_tiles_x) + tx];
+   long  x0, x1, y0, y1;     /* tile pixels covered by the hot spot   */
+   long  xx, yy, bit;
+
+   if (*tile_pp == bpix_full_tile)
+   {
+      return (TRUE);
+   }
+
+   x0 = BPIX_MAX(curr_p->x[0] - map_p->x_min - (tx << BPIX_TILE_BITS), 0);
+   x1 = BPIX_MIN(curr_p->x[1] - map_p->x_min - (tx << BPIX_TILE_BITS),
+            BPIX_TILE_MASK);
+   y0 = BPIX_MAX(curr_p->y[0] - map_p->y_min - (ty << BPIX_TILE_BITS), 0);
+   y1 = BPIX_MIN(curr_p->y[1] - map_p->y_min - (ty << BPIX_TILE_BITS),
+            BPIX_TILE_MASK);
+
+   if ((x0 == 0) && (y0 == 0) &&
+       (x1 == BPIX_TILE_MASK) && (y1 == BPIX_TILE_MASK))
+   {
+      free(*tile_pp);
+      *tile_pp = bpix_full_tile;
+      return (TRUE);
+   }
+
+   if ((*tile_pp == NULL) &&
+       ((*tile_pp = (unsigned int*) calloc(BPIX_TILE_WORDS,
+                                           sizeof(unsigned int))) == NULL))
+   {
+      return (FALSE);
+   }
+
+   for (yy = y0; yy <= y1; yy++)
+   {
+      for (xx = x0; xx <= x1; xx++)
+      {
+         bit = (yy << BPIX_TILE_BITS) | xx;
+         (*tile_pp)[bit >> 5] |= (1U << (bit & 31));
+      }
+   }
+
+   return (TRUE);
+}
+
+
+
+
 /*************************************************************************
  
 * FUNCTION NAME: open_bad_pixel_file()
@@ -396,65 +623,121 @@ short map_bad_pixel_column (
     This function takes in a mapping value (produced in the routine 
     map_bad_pixel_column) and reads the appropriate column from the 
     badpixel file to copy the data into the badpixel data structure.
+    The chip ids of every row are read in one block first, so the array
+    of each chip is grown once per file; the rows are then read into 
+    the arrays in one pass. The arrays are sorted by 
+    sort_bad_pixel_list() once every file is loaded.
 
 * NOTES: 
     The mappings are done to allow for the easy introduction of additional
     columns as the relevant input file columns may change.  
+
+    FALSE is returned if the memory for the rows could not be allocated.
  
 *H***********************************************************************/
  
-void load_bad_pixel_data (
+boolean load_bad_pixel_data (
     BAD_PIX_SETUP_P_T hk_p,   /* I - bad pixel file house keeping data */
-    BAD_PIX_P_T*      hotpix_list_p) /* O - hot pixel list pointer     */
+    BAD_PIX_A_T       hotpix_list) /* I/O - hot pixel arrays           */
 {
     BAD_PIX_P_T new_entry;
+    BAD_PIX_P_T new_pix;
+    short* chip_ids = NULL;
+    long   num_new[BPIX_NUM_CHIPS] = {0, 0, 0, 0};
+    long   nn;
+    boolean loaded = TRUE;
     short chip_id = 0; 
     short col;
  
-    while ((hk_p->curr_row < hk_p->num_rows) &&
-           (hk_p->row_check != dmNOMOREROWS))
+    if ((hk_p->num_rows <= 0) ||
+        ((chip_ids = (short*) calloc(hk_p->num_rows, sizeof(short))) == NULL))
     {
-       new_entry = (BAD_PIX_P_T) malloc(sizeof(BAD_PIX_T));
+       return (hk_p->num_rows <= 0);
+    }
+
+    /* read the chip ids (0 if the file has no chip id column) */
+    for (col = 0; col < hk_p->num_cols; col++)
+    {
+       if ((hk_p->mapping[col] == BPIX_CHIPID) &&
+           (dmGetScalars_s(hk_p->desc[col], chip_ids, 1, hk_p->num_rows) !=
+            hk_p->num_rows))
+       {
+          memset(chip_ids, 0, hk_p->num_rows * sizeof(short));
+       }
+    }
 
-       for (col = 0; col < hk_p->num_cols; col++)
+    /* grow each chip's array to take the file's rows */
+    for (nn = 0; nn < hk_p->num_rows; nn++)
+    {
+       if ((chip_ids[nn] > -1) && (chip_ids[nn] < BPIX_NUM_CHIPS))
+       {
+          num_new[chip_ids[nn]]++;
+       }
+    }
+    for (chip_id = 0; loaded && (chip_id < BPIX_NUM_CHIPS); chip_id++)
+    {
+       if (num_new[chip_id] > 0)
        {
-          switch (hk_p->mapping[col])
+          nn = hotpix_list[chip_id].num_pix + num_new[chip_id];
+          if ((new_pix = (BAD_PIX_P_T) realloc(hotpix_list[chip_id].pix,
+                                               nn * sizeof(BAD_PIX_T))) != NULL)
           {
-             case BPIX_CHIPX:
-                dmGetArray_l(hk_p->desc[col], new_entry->x, 2); 
-             break;
-       
-             case BPIX_CHIPY:
-                dmGetArray_l(hk_p->desc[col], new_entry->y, 2); 
-             break;
-
-             case BPIX_CHIPID:
-                chip_id = dmGetScalar_s(hk_p->desc[col]);
-             break; 
-
-             case BPIX_STATUS:
-             {
-                unsigned char bit_val[1]  = {0};
-                dmGetArray_bit(hk_p->desc[col], bit_val, 1);
-                new_entry->status = bit_val[0];
-             } 
-             break; 
-       
-             default:
-                /* do nothing */
-             break;
+             hotpix_list[chip_id].pix = new_pix;
+          }
+          else
+          {
+             loaded = FALSE;
           }
        }
+    }
+
+    while (loaded && (hk_p->curr_row < hk_p->num_rows) &&
+           (hk_p->row_check != dmNOMOREROWS))
+    {
+       chip_id = chip_ids[hk_p->curr_row];
 
        if ((chip_id > -1) && (chip_id < 4)) /* valid chip id? */ 
        {
-          /* insert retrieved information into linked list */
-          update_bad_pixel_list(new_entry, &hotpix_list_p[chip_id]);
+          new_entry = &hotpix_list[chip_id].pix[hotpix_list[chip_id].num_pix];
+          memset(new_entry, 0, sizeof(BAD_PIX_T));
+
+          for (col = 0; col < hk_p->num_cols; col++)
+          {
+             switch (hk_p->mapping[col])
+             {
+                case BPIX_CHIPX:
+                   dmGetArray_l(hk_p->desc[col], new_entry->x, 2); 
+                break;
+          
+                case BPIX_CHIPY:
+                   dmGetArray_l(hk_p->desc[col], new_entry->y, 2); 
+                break;
+
+                case BPIX_STATUS:
+                {
+                   unsigned char bit_val[1]  = {0};
+                   dmGetArray_bit(hk_p->desc[col], bit_val, 1);
+                   new_entry->status = bit_val[0];
+                } 
+                break; 
+          
+                default:
+                   /* do nothing */
+                break;
+             }
+          }
+
+          /* add retrieved information to the chip's array */
+          hotpix_list[chip_id].num_pix++;
        } 
 
        hk_p->row_check = dmTableNextRow(hk_p->extension);
        hk_p->curr_row++;
     }
+
+    free(chip_ids);
+
+    return (loaded);
 } 
 
   
@@ -468,12 +751,15 @@ void load_bad_pixel_data (
  
 * DESCRIPTION: The routine check_for_bad_pixels() is called to determine 
   if an event is located on a hot spot (bad pixel). The routine receives 
-  a pointer to the head of an ordered linked list of hot spots and a 
-  pointer to an event data structure. The routine iterates through the 
-  linked list and checks the hot spot coordinates against the event's chip 
-  coordinates. If the coordinates match a hot spot status bit is set in 
-  the event data structure. The routine does not pass a return value. The 
-  entire linked list is not traversed for each event, instead the 
+  the per chip index built by build_bad_pixel_index() and a pointer to an 
+  event data structure. The event's chip coordinates select a tile of 
+  the chip's index and a bit of the tile; if the bit is set a hot spot 
+  status bit is set in the event data structure. The routine does not 
+  pass a return value. 
+
+  If the chip has no index (it could not be allocated), the routine 
+  iterates through the chip's ordered array of hot spots instead. 
+  The entire array is not traversed for each event, instead the 
   processing stops when it finds a match or, its x coordinate is greater 
   than the events x coordinate (or equivalent to the events x coord and 
   the lists y coord is greater than the events y coord).   
@@ -485,26 +771,33 @@ void load_bad_pixel_data (
   to convert the raw coords from doubles to shorts when the events are 
   written to the output event file. 
 
-  The routine expects the linked list to be ordered using the x 
+  The routine expects the array to be ordered using the x 
   coordinate as the primary key and the y coordinate as a secondary key 
-  for multiple hot spot instances on the same x coordinate. The list must 
+  for multiple hot spot instances on the same x coordinate. The array must 
   be in ascending order and not contain duplicate entries. Using the 
-  load_bad_pixel_files routine to create the linked list ensures that 
+  load_bad_pixel_files routine to create the array ensures that 
   these conditions are met.
  
 *************************************************************************/
 
 void check_for_bad_pixels(
-   BAD_PIX_A_T   bad_pixel_p, /* I - pointer to a list of hot pixels    */
-   EVENT_REC_P_T evt_p)       /* I/O - event record structure pointer   */
+   BAD_PIX_A_T     bad_pixel_p, /* I - per chip arrays of hot pixels    */
+   BAD_PIX_INDEX_T bad_index_p, /* I - hot pixel chip index             */
+   EVENT_REC_P_T   evt_p)       /* I/O - event record structure pointer */
 {
-   BAD_PIX_P_T  curr_p = NULL; 
-   boolean      done = FALSE;
-   short        chip_x, chip_y; 
+   BAD_PIX_P_T     curr_p = NULL; 
+   BAD_PIX_P_T     end_p = NULL; 
+   BAD_PIX_MAP_P_T map_p = NULL;
+   unsigned int*   tile_p;
+   boolean         done = FALSE;
+   short           chip_x, chip_y; 
+   long            dx, dy, bit;
 
    if ((evt_p->chipid > -1) && (evt_p->chipid < 4)) /* range 0-3 */
    {
-      curr_p = bad_pixel_p[evt_p->chipid]; 
+      curr_p = bad_pixel_p[evt_p->chipid].pix; 
+      end_p = curr_p + bad_pixel_p[evt_p->chipid].num_pix;
+      map_p = &bad_index_p[evt_p->chipid];
    } 
    else
    {
@@ -515,9 +808,34 @@ void check_for_bad_pixels(
    pix_double_to_short(evt_p->chippos[HDET_PLANE_X], FALSE, &chip_x);
    pix_double_to_short(evt_p->chippos[HDET_PLANE_Y], FALSE, &chip_y);
 
+   if ((map_p != NULL) && (map_p->tiles != NULL))
+   {
+      /* look the pixel up in the chip's index */
+      dx = chip_x - map_p->x_min;
+      dy = chip_y - map_p->y_min;
+
+      if ((dx >= 0) && (dy >= 0) &&
+          ((dx >> BPIX_TILE_BITS) < map_p->num_tiles_x) &&
+          ((dy >> BPIX_TILE_BITS) < map_p->num_tiles_y) &&
+          ((tile_p = map_p->tiles[((dy >> BPIX_TILE_BITS) *
+                                   map_p->num_tiles_x) +
+                                  (dx >> BPIX_TILE_BITS)]) != NULL))
+      {
+         bit = ((dy & BPIX_TILE_MASK) << BPIX_TILE_BITS) |
+               (dx & BPIX_TILE_MASK);
+         if (tile_p[bit >> 5] & (1U << (bit & 31)))
+         {
+            /* raw event is a hot pixel */
+            evt_p->status |= HDET_HOT_SPOT_STS;
+         }
+      }
+
+      done = TRUE;
+   }
+
    while (!done)
    {
-      if (curr_p == NULL)
+      if (curr_p >= end_p)
       {
          done = TRUE;
       }
@@ -525,15 +843,15 @@ void check_for_bad_pixels(
       {
          if (curr_p->x[1] < chip_x)
          {
-            /* move to next element in hot pixel list */ 
-            curr_p = curr_p->next; 
+            /* move to next element in hot pixel array */ 
+            curr_p++; 
          } 
          else if (curr_p->y[0] <= chip_y) 
          {
             if (curr_p->y[1] < chip_y)
             {
-               /* move to next element in hot pixel list */ 
-               curr_p = curr_p->next;
+               /* move to next element in hot pixel array */ 
+               curr_p++;
             }
             else 
             {
@@ -544,13 +862,13 @@ void check_for_bad_pixels(
          } 
          else 
          {
-            /* move to next element in hot pixel list */ 
-            curr_p = curr_p->next;
+            /* move to next element in hot pixel array */ 
+            curr_p++;
          } 
       } 
       else 
       { 
-         /* since list is ordered - no need to check rest of list */
+         /* since array is ordered - no need to check rest of array */
          done = TRUE;
       }
    } /* end while */ 
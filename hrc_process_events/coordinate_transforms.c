@@ -44,6 +44,15 @@
 * (1/2009) - add hrcS 3dim gain image  ( obsolete 10/2009 )
 * 10/2009 - replace peter hrcS 3dim gain image w/ dph new hrcS gain table.
 * 10/2009 - add fap hrcI new gain image.
+* 10/2026 - pixel randomization from the counter based generator 
+*           (hpe_random_offsets) unless rand_gen=pixlib.
+* 10/2026 - sky position by the transform of the aspect record
+*           (hpe_apply_tan_xform) when fastsky=yes.
+* 10/2026 - chip to fpc/tdet by the transforms of the chip
+*           (hpe_chip_xform) when fastchip=yes.
+* 10/2026 - tap range check from the tap calibration records.
+* 10/2026 - pi_double of the new hrcS gain table is computed in the PI
+*           stage (S_new_gain_pi_range), for a range of events at a time.
 *H***********************************************************************/
 
 #ifndef HRC_PROCESS_EVENTS_H
@@ -126,15 +135,13 @@ void calc_coarse_coords(
    d_p->amp_sf = evt_p->amp_sf ;   /* for degap #3 */
    l1h_coarse_to_chip(d_p, coarse, fine, evt_p->chippos, &evt_p->chipid,err_p);  
 
-   if (inp_p->gainflag == NEW_S_GAIN)  
-   {
-     /* ---------------------------------------------------------------------- 
-      * 10/2009 - For new hrcS gain table, use evt_p->rawpos to get gain index
-      * and pi_double. PI value will be readjusted in calculate_pi_hrc().
-      * ----------------------------------------------------------------------*/
-      S_new_gain_index_pi(inp_p, evt_p); /*load gainTab data + compute pi_double*/
-   }
-   else   /* 10/2009 - for both OLD_SI_GAIN && NEW_I_GAIN */
+   /* ---------------------------------------------------------------------- 
+    * 10/2009 - For new hrcS gain table, use evt_p->rawpos to get gain index
+    * and pi_double. PI value will be readjusted in calculate_pi_hrc().
+    * 10/2026 - pi_double is computed by hpe_stage_pi() for a range of
+    * events (S_new_gain_pi_range).
+    * ----------------------------------------------------------------------*/
+   if (inp_p->gainflag != NEW_S_GAIN)  /* for both OLD_SI_GAIN && NEW_I_GAIN */
    {
       image_2dim_gain_index(inp_p, evt_p);  /* load gain image data (only!)*/
      /* pi||pi_double will be computed in calculate_pi_hrc() later.*/
@@ -215,9 +222,13 @@ boolean calculate_coords_hrc(
    ASPECT_REC_P_T  aspect,  /* I   aspect information                      */
    DEGAP_CONFIG_P_T d_p,    /* I/O - degap configuration structure         */
    short asp_type_flag,     /* I   what type of aspect correction is it?   */
+   HPE_TAN_XFORM_P_T tan_p, /* I/O sky transform (NULL = dmTan calls)      */
+   HPE_CHIP_XFORM_P_T chip_p, /* I/O chip transforms (NULL = pixlib)       */
+   HPE_TAP_CAL_TABLE_P_T tc_p, /* I  tap calibration records (or NULL)     */
    dsErrList*       err_p)  /* I/O - error list                            */
 {
    boolean err = FALSE;  /* false = no error occurred */  
+   boolean in_range;     /* TRUE = taps within the degap tap range         */
 
 #ifdef NOT_MOVED_FOR_ADC_CORR 
    /* if HRC-i flight data extra bit should be removed */ 
@@ -228,10 +239,25 @@ boolean calculate_coords_hrc(
    } 
 #endif
   
-   if (((evt_p->cp[HDET_PLANE_X] < d_p->min_tap[HDET_PLANE_X]) || 
-       (evt_p->cp[HDET_PLANE_X] > d_p->max_tap[HDET_PLANE_X])) || 
-       ((evt_p->cp[HDET_PLANE_Y] < d_p->min_tap[HDET_PLANE_Y]) || 
-       (evt_p->cp[HDET_PLANE_Y] > d_p->max_tap[HDET_PLANE_Y])))   
+   if (tc_p != NULL)
+   {
+      /* (10/2026) from the tap calibration record of each axis */
+      in_range = 
+         (HPE_TAP_CAL_REC(tc_p, HDET_PLANE_X, evt_p->cp[HDET_PLANE_X])->
+          degap_ok &&
+          HPE_TAP_CAL_REC(tc_p, HDET_PLANE_Y, evt_p->cp[HDET_PLANE_Y])->
+          degap_ok);
+   }
+   else
+   {
+      in_range = 
+         !(((evt_p->cp[HDET_PLANE_X] < d_p->min_tap[HDET_PLANE_X]) || 
+          (evt_p->cp[HDET_PLANE_X] > d_p->max_tap[HDET_PLANE_X])) || 
+          ((evt_p->cp[HDET_PLANE_Y] < d_p->min_tap[HDET_PLANE_Y]) || 
+          (evt_p->cp[HDET_PLANE_Y] > d_p->max_tap[HDET_PLANE_Y])));
+   }
+
+   if (!in_range)
    { 
       err = TRUE;
    }
@@ -243,7 +269,16 @@ boolean calculate_coords_hrc(
          evt_p->workpos[HDET_PLANE_X] = evt_p->chippos[HDET_PLANE_X]; 
          evt_p->workpos[HDET_PLANE_Y] = evt_p->chippos[HDET_PLANE_Y]; 
 
-         if (inp_p->randpixsize > FLT_EPSILON)
+         if ((inp_p->randpixsize > FLT_EPSILON) && inp_p->rand_counter)
+         {
+            VEC2_DBLE offset;
+
+            /* (10/2026) random values keyed by seed, file and row */
+            hpe_random_offsets(inp_p, evt_p, offset);
+            evt_p->workpos[HDET_PLANE_X] += offset[HDET_PLANE_X]; 
+            evt_p->workpos[HDET_PLANE_Y] += offset[HDET_PLANE_Y]; 
+         }
+         else if (inp_p->randpixsize > FLT_EPSILON)
          {
             double rand_x, rand_y;
    
@@ -265,7 +300,9 @@ boolean calculate_coords_hrc(
          switch(inp_p->stop)
          {
             case HDET_SKY_VAL:  /* fallthrough intended */  
-               pix_chip_to_fpc(evt_p->chipid, evt_p->workpos, evt_p->fppos);
+               /* (10/2026) per chip transforms when fastchip=yes */
+               hpe_chip_xform(chip_p, HPE_CHIP_TO_FPC, evt_p->chipid,
+                              evt_p->workpos, evt_p->fppos);
  
                if (inp_p->processing == HRC_PROC_FLIGHT)
                {
@@ -278,6 +315,12 @@ boolean calculate_coords_hrc(
 		  {  
 		     pix_apply_aspect(fpc, aspect->asp_sol, evt_p->skypos); 
 		  }
+		  else if ((tan_p != NULL) &&
+		           hpe_tan_xform_ready(tan_p, aspect, inp_p))
+		  {
+		     /* (10/2026) both projections in one transform */
+		     hpe_apply_tan_xform(tan_p, fpc, evt_p->skypos);
+		  }
 		  else
 		  {
 		     double cel[2];
@@ -299,20 +342,20 @@ boolean calculate_coords_hrc(
                {
                   if (inp_p->stop != HDET_SKY_VAL)
                   {
-                     pix_chip_to_fpc(evt_p->chipid, evt_p->workpos, 
-                                     evt_p->fppos);
+                     hpe_chip_xform(chip_p, HPE_CHIP_TO_FPC, evt_p->chipid,
+                                    evt_p->workpos, evt_p->fppos);
                   } 
                   evt_p->detpos[HDET_PLANE_X] = evt_p->fppos[HDET_PLANE_X];
                   evt_p->detpos[HDET_PLANE_Y] = evt_p->fppos[HDET_PLANE_Y];
                }
                else
                {
-                  pix_chip_to_fpc(evt_p->chipid, evt_p->workpos, 
-                                  evt_p->detpos);
+                  hpe_chip_xform(chip_p, HPE_CHIP_TO_FPC, evt_p->chipid,
+                                 evt_p->workpos, evt_p->detpos);
                } 
             case HDET_TDET_VAL: /* fallthrough intended */ 
-               pix_chip_to_tdet(evt_p->chipid, evt_p->chippos,
-                                evt_p->tdetpos);
+               hpe_chip_xform(chip_p, HPE_CHIP_TO_TDET, evt_p->chipid,
+                              evt_p->chippos, evt_p->tdetpos);
             break; 
             
             default:
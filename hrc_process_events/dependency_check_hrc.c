@@ -41,6 +41,8 @@
         Ref. No.        Date
         --------        ----
         1.1             04 Apr 1996
+        1.2             Oct 2026  set_input_projection() and
+                                  project_input_columns() added.
 *H***********************************************************************/
 
 
@@ -253,3 +255,173 @@ boolean output_coord_validate(
 
 
 
+
+
+/*H***********************************************************************
+ 
+* DESCRIPTION: The routine set_input_projection is called upon by 
+  hrc_process_events to set up the input fields which have to be read 
+  (inp_p->read_field). Fields which no processing stage reads are only 
+  read when they are listed in the output or bad output eventdef: the 
+  frame counters and other telemetry fields, PI (recomputed), the raw, 
+  det and sky coordinates and fpz, and the tdet coordinates unless the 
+  transformations start from tdet. The fields used by the status, filter
+  and coordinate stages are always read, since those stages run whatever
+  the coordinate range. All fields are read if an eventdef can not be 
+  parsed.
+
+**************************************************************************/
+
+void set_input_projection(
+   INPUT_PARMS_P_T inp_p)  /* I/O - ptr to input parameters data structure */
+{
+   /* fields read only to be written out */
+   static short output_only[] = {
+      HDET_MJR_FRAME, HDET_MNR_FRAME, HDET_EVENT, HDET_X_POS, HDET_Y_POS,
+      HDET_DUMMY, HDET_PI, HDET_PHASCALE, HDET_RAWPHA, HDET_RAW_X,
+      HDET_RAW_Y, HDET_DET_X, HDET_DET_Y, HDET_TICK, HDET_SCIFR,
+      HDET_EVTCTR, HDET_SKY_X, HDET_SKY_Y, HDET_FPZ, HDET_SUBMJF,
+      HDET_DET_ID, HDET_MRF, HDET_STOPMNF, HDET_SKY, HDET_DET, HDET_RAW };
+
+   /* vector fields and their components */
+   static short vector_field[][3] = {
+      {HDET_SKY,  HDET_SKY_X,  HDET_SKY_Y},
+      {HDET_DET,  HDET_DET_X,  HDET_DET_Y},
+      {HDET_TDET, HDET_TDET_X, HDET_TDET_Y},
+      {HDET_CHIP, HDET_CHIP_X, HDET_CHIP_Y},
+      {HDET_RAW,  HDET_RAW_X,  HDET_RAW_Y} };
+
+   char*   eventdef[2];
+   char**  names;
+   dmDataType* types;
+   short   num_cols;
+   short   mapping;
+   short   ii, jj, ee;
+   boolean keep_all = FALSE;
+
+   for (ii = 0; ii < HDET_NUM_FIELDS; ii++)
+   {
+      inp_p->read_field[ii] = TRUE;
+   }
+
+#ifdef NO_EVENTDEF
+   keep_all = TRUE;
+#endif
+
+   for (ii = 0; ii < (short) (sizeof(output_only) / sizeof(short)); ii++)
+   {
+      inp_p->read_field[output_only[ii]] = FALSE;
+   }
+   if (inp_p->start != HDET_TDET_VAL)
+   {
+      inp_p->read_field[HDET_TDET_X] = FALSE;
+      inp_p->read_field[HDET_TDET_Y] = FALSE;
+      inp_p->read_field[HDET_TDET] = FALSE;
+   }
+
+   /* read whatever the output files list */
+   eventdef[0] = inp_p->outcols;
+   eventdef[1] = inp_p->badoutcols;
+
+   for (ee = 0; !keep_all && (ee < 2); ee++)
+   {
+      short* out_map = NULL;
+
+      names = NULL;
+      types = NULL;
+      num_cols = 0;
+
+      if (ds_parse_eventdef(eventdef[ee], &names, &types, &num_cols) ||
+          (names == NULL) ||
+          ((out_map = (short*) calloc(num_cols, sizeof(short))) == NULL))
+      {
+         keep_all = TRUE;
+      }
+      else
+      {
+         parse_hrc_evt_columns(names, num_cols, out_map);
+
+         for (ii = 0; ii < num_cols; ii++)
+         {
+            mapping = out_map[ii];
+            if ((mapping >= 0) && (mapping < HDET_NUM_FIELDS))
+            {
+               inp_p->read_field[mapping] = TRUE;
+            }
+            for (jj = 0; jj < 5; jj++)
+            {
+               if ((mapping == vector_field[jj][0]) ||
+                   (mapping == vector_field[jj][1]) ||
+                   (mapping == vector_field[jj][2]))
+               {
+                  inp_p->read_field[vector_field[jj][0]] = TRUE;
+                  inp_p->read_field[vector_field[jj][1]] = TRUE;
+                  inp_p->read_field[vector_field[jj][2]] = TRUE;
+               }
+            }
+         }
+      }
+
+      if (out_map != NULL)
+      {
+         free(out_map);
+      }
+      for (ii = 0; (names != NULL) && (ii < num_cols); ii++)
+      {
+         if (names[ii] != NULL)
+         {
+            free(names[ii]);
+         }
+      }
+      if (names != NULL)
+      {
+         free(names);
+      }
+      if (types != NULL)
+      {
+         free(types);
+      }
+   }
+
+   if (keep_all)
+   {
+      for (ii = 0; ii < HDET_NUM_FIELDS; ii++)
+      {
+         inp_p->read_field[ii] = TRUE;
+      }
+   }
+}
+
+
+/*H***********************************************************************
+ 
+* DESCRIPTION: The routine project_input_columns is called upon by 
+  open_input_event_file once the input columns are mapped. The mapping 
+  of each column whose field is not read (evtin_p->read_field) is set to
+  HDET_UNKNOWN_FIELD, so that neither load_event_data nor 
+  load_event_block reads it. The column descriptors are kept. The number
+  of columns dropped is returned.
+
+**************************************************************************/
+
+int project_input_columns(
+   EVENT_SETUP_P_T evtin_p)  /* I/O - input event file information        */
+{
+   int   num_dropped = 0;
+   short cc;
+   short mapping;
+
+   for (cc = 0; (evtin_p->read_field != NULL) && (cc < evtin_p->num_cols);
+        cc++)
+   {
+      mapping = evtin_p->mapping[cc];
+      if ((mapping >= 0) && (mapping < HDET_NUM_FIELDS) &&
+          (mapping != HDET_UNKNOWN_FIELD) && !evtin_p->read_field[mapping])
+      {
+         evtin_p->mapping[cc] = HDET_UNKNOWN_FIELD;
+         num_dropped++;
+      }
+   }
+
+   return (num_dropped);
+}
@@ -0,0 +1,485 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/***************************************************************************
+ * 10/2026 - initial version
+ *
+ * This file defines the event pipeline used by hrc_process_events to
+ * process the events of an input file. The pipeline holds the calibration
+ * data and the running state shared by all events. Events are processed
+ * either one at a time (batch=no, the original loop) or a batch at a time,
+ * where each processing stage is applied to every event of the batch
+ * before the next stage starts (batch=yes). Both orders give identical
+ * output since each stage only carries state from event to event within
+ * itself (time range, sequence check, aspect cursor, pixlib random numbers
+ * and output row order).
+ *
+ * 10/2026 - add the worker threads (nthreads parameter) which share out
+ *           the stages without event to event state over a batch.
+ * 10/2026 - add the stage timers (verbose > 0 or timingfile).
+ * 10/2026 - add the output writer thread (writequeue > 0).
+ * 10/2026 - add the input prefetch thread (prefetch = yes).
+ * 10/2026 - the prefetch thread maps plain FITS input files (fastread).
+ * 10/2026 - add the aspect segment (alignment/aspect resolved once for
+ *           the events sharing a time).
+ * 10/2026 - add the sky transform of the aspect record (fastsky).
+ * 10/2026 - add the aspect store (aspstore = yes).
+ * 10/2026 - add the chip transforms (fastchip).
+ * 10/2026 - add the tap calibration records.
+ * 10/2026 - add the condition variables of the writer thread and the
+ *           datamodel lock.
+ * 10/2026 - a segment may last for the span of the aspect record.
+ * 10/2026 - the aspect record of the store is kept up to its own time
+ *           (asp_stop), as aspect_update() keeps it.
+ * 10/2026 - the record given by aspect_update() is kept likewise; spans
+ *           is set whenever there is no alignment file.
+ *
+ * Must be included after hrc_process_events.h and adc_corr_defs.h.
+ ***************************************************************************/
+#ifndef EVENT_BATCH_DEFS_H
+#define EVENT_BATCH_DEFS_H
+
+#include <pthread.h>
+
+/* groups of stages run by process_event_slice() */
+#define HPE_SLICE_AMPS   1    /* amp corrections and ADC filtering tests  */
+#define HPE_SLICE_PI     2    /* pulse invariance and bad pixel checks    */
+
+/* stage timers (see hpe_timers.c) */
+#define HPE_TIMER_LOAD      0    /* read input rows                       */
+#define HPE_TIMER_AMPSF     1    /* amp_sf correction                     */
+#define HPE_TIMER_TAPRING   2    /* tap ring correction                   */
+#define HPE_TIMER_ADC       3    /* ADC correction                        */
+#define HPE_TIMER_FILTERS   4    /* hyperbolic, saturation, flatness      */
+#define HPE_TIMER_ASPECT    5    /* sequence check, alignment and aspect  */
+#define HPE_TIMER_COORDS    6    /* calculate_coords_hrc                  */
+#define HPE_TIMER_PI        7    /* pulse invariance                      */
+#define HPE_TIMER_BADPIX    8    /* bad pixel check                       */
+#define HPE_TIMER_WRITE     9    /* write output rows                     */
+#define HPE_NUM_TIMERS     10
+
+/*  the following structure holds the time spent in each stage, for the
+ *  current input file and for the whole run. The stages run by worker
+ *  threads (nthreads > 1) are timed in the calling thread, over its own
+ *  range of each batch, which is close to the wall time of the stage.
+ *
+ *  STAGE TIMER STRUCTURE
+ */
+
+typedef struct hpe_timers_t {
+   double  run_start;               /* wall clock at start of the run     */
+   double  file_start;              /* wall clock at start of the file    */
+   double  run[HPE_NUM_TIMERS];     /* seconds in each stage, whole run   */
+   double  file[HPE_NUM_TIMERS];    /* seconds in each stage, this file   */
+   long    run_events;              /* events processed, whole run        */
+   long    file_events_in;          /* total_events_in at start of file   */
+   long    num_files;               /* input files timed                  */
+   FILE*   json_p;                  /* JSON timing file (NULL = none)     */
+} HPE_TIMERS_T, *HPE_TIMERS_P_T;
+
+/*  the following structure holds the event time for which the current
+ *  alignment and aspect records were last resolved (hpe_resolve_aspect).
+ *  The events of a segment, which share that time, use the records as
+ *  they are instead of updating them again. The aspect record (from
+ *  aspect_update() or the aspect store) is kept for every event time up
+ *  to asp_stop, the time of the record; if the alignment does not change
+ *  with time (no alignment file), the segment lasts that long (spans).
+ *
+ *  ASPECT SEGMENT STRUCTURE
+ */
+
+typedef struct hpe_aspect_seg_t {
+   boolean valid;                   /* TRUE = records resolved for 'time' */
+   double  time;                    /* event time of the segment          */
+   double  asp_stop;                /* last time of the aspect record     */
+   boolean spans;                   /* TRUE = segment lasts to asp_stop   */
+                                    /*        (no alignment file)         */
+   long    num_events;              /* events resolved, whole run         */
+   long    num_segments;            /* alignment/aspect updates made      */
+   long    num_records;             /* aspect records read or found       */
+} HPE_ASPECT_SEG_T, *HPE_ASPECT_SEG_P_T;
+
+/*  the following structure holds the records of every file of the aspect
+ *  stack in time order (aspstore = yes; hpe_aspect_store.c). The cursor
+ *  is the record found for the previous event time.
+ *
+ *  ASPECT STORE STRUCTURE
+ */
+
+#define HPE_ASP_STORE_COLS      3   /* ra, dec, roll or dy, dz, dtheta    */
+
+/* aspect file type of a solution (any value but ASP_FTYPE_OFFSETS) */
+#define HPE_ASP_FTYPE_SOLUTION  (ASP_FTYPE_OFFSETS + 1)
+
+typedef struct hpe_aspect_store_t {
+   ASPECT_REC_P_T recs;             /* records of the stack, time order   */
+   long    num_recs;                /* number of records                  */
+   long    cursor;                  /* record of the previous query       */
+   int     num_files;               /* files of the stack read            */
+   short   offsets;                 /* 1 = offsets files, 0 = solutions   */
+} HPE_ASPECT_STORE_T, *HPE_ASPECT_STORE_P_T;
+
+/*  the following structure holds the calibration data, files and running
+ *  state needed to process the events of the input file(s). The fields
+ *  are set up in hrc_process_events() and are shared by both the per
+ *  event and the batch processing routines.
+ *
+ *  EVENT PIPELINE STRUCTURE
+ */
+
+typedef struct hpe_pipeline_t {
+   INPUT_PARMS_P_T     inp_p;          /* input parameters                */
+   STATISTICS_P_T      stat_p;         /* event statistics                */
+   FILE*               log_ptr;        /* debug log destination           */
+   int                 debug;          /* debug level                     */
+   dsErrList*          err_p;          /* error list                      */
+
+   EVENT_SETUP_P_T     evtin_p;        /* current input event file        */
+   EVENT_SETUP_P_T     evtout_p;       /* output event file               */
+   EVENT_SETUP_P_T     evtbout_p;      /* output bad event file           */
+   boolean             setup_badfile;  /* TRUE = bad file not yet created */
+   char**              b_names;        /* bad event file column names     */
+
+   ALIGNMENT_REC_P_T   aln_p;          /* current alignment record        */
+   ALIGNMENT_INFRA_P_T aln_hk_p;       /* alignment file housekeeping     */
+   ASPECT_ENTRY_P_T    asp_p;          /* current aspect entries          */
+   ASPECT_INFRA_P_T    asp_hk_p;       /* aspect file housekeeping        */
+
+   DEGAP_CONFIG_P_T    dgp_p;          /* degap tables                    */
+   ADC_CORR_P_T        adc_x;          /* x axis adc correction table     */
+   ADC_CORR_P_T        adc_y;          /* y axis adc correction table     */
+   HPE_TAP_CAL_TABLE_P_T tapcal_p;     /* tap calibration records         */
+   float*              gain_p;         /* old 2dim gain map image         */
+   BAD_PIX_LIST_P_T    hotpix_p;       /* bad pixel arrays (per chip)     */
+   BAD_PIX_MAP_P_T     hotidx_p;       /* bad pixel index (per chip)      */
+   AMPSFCOR_COEFF_P_T  ampsfcor_coeff; /* amp_sf correction coefficients  */
+   TRING_COEFFS_P_T    tring_coeffs_p; /* tap ring coefficients           */
+   HYP_TEST_P_T        hyp_test_coeffs_p;  /* hyperbolic test coeffs      */
+   SAT_TEST_P_T        sat_test_coeffs_p;  /* saturation test coeffs      */
+   double*             flat_test_coeffs_p; /* flatness test coefficient   */
+
+   HPE_ASPECT_SEG_T    aspect_seg;     /* alignment/aspect segment        */
+   HPE_TAN_XFORM_T     tan_xform;      /* sky transform (fastsky)         */
+   HPE_CHIP_XFORM_T    chip_xform;     /* chip transforms (fastchip)      */
+   HPE_ASPECT_STORE_P_T asp_store_p;   /* aspect store (NULL = none)      */
+
+   double              last_time;      /* time of last in-sequence event  */
+   long                bad_interval;   /* # consecutive out of seq events */
+   long                row;            /* input row of the current event  */
+
+   struct hpe_threads_t* threads_p;    /* worker threads (NULL = none)    */
+   HPE_TIMERS_P_T      timers_p;       /* stage timers (NULL = not timed) */
+   struct hpe_event_writer_t* writer_p; /* output writer (NULL = none)    */
+   struct hpe_prefetch_t* prefetch_p;  /* input prefetch (NULL = none)    */
+} HPE_PIPELINE_T, *HPE_PIPELINE_P_T;
+
+
+/*  the following structure holds a batch of events processed stage by
+ *  stage. The event records are kept contiguous so each stage walks the
+ *  batch in order with its coefficients in cache; the stages that work
+ *  on arrays of fields gather them from the records a chunk at a time
+ *  (see event_batch_functions.c).
+ *
+ *  EVENT BATCH STRUCTURE
+ */
+
+typedef struct event_batch_t {
+   long           size;        /* number of events the batch can hold     */
+   long           num_events;  /* number of events currently in the batch */
+   long           first_row;   /* input row number of the first event     */
+   long           num_rows;    /* input rows loaded (events + skipped)    */
+   EVENT_REC_P_T  evt;         /* event records                           */
+   boolean*       bad;         /* TRUE = event rejected by coordinates    */
+} EVENT_BATCH_T, *EVENT_BATCH_P_T;
+
+
+/*  the following structures hold the worker threads used to process the
+ *  events of a batch with nthreads > 1. The calling thread takes the first
+ *  range of the batch and each worker one of the others; the calling
+ *  thread waits until every range is done.
+ *
+ *  WORKER THREAD STRUCTURES
+ */
+
+typedef struct hpe_worker_t {
+   struct hpe_threads_t* threads_p;    /* worker thread pool              */
+   int                   index;        /* range of the batch (1..n-1)     */
+   long                  generation;   /* last piece of work done         */
+} HPE_WORKER_T, *HPE_WORKER_P_T;
+
+typedef struct hpe_threads_t {
+   int              nthreads;      /* # threads, including the caller     */
+   pthread_t*       tid;           /* worker thread ids                   */
+   HPE_WORKER_P_T   worker;        /* worker thread arguments             */
+   pthread_mutex_t  lock;          /* protects the fields below           */
+   pthread_cond_t   start_cv;      /* signalled when work is posted       */
+   pthread_cond_t   done_cv;       /* signalled when the last range ends  */
+   long             generation;    /* incremented for each piece of work  */
+   int              pending;       /* # worker ranges not yet done        */
+   boolean          shutdown;      /* TRUE = workers should exit          */
+   HPE_PIPELINE_P_T pln_p;         /* pipeline of the current work        */
+   EVENT_BATCH_P_T  bat_p;         /* batch of the current work           */
+   int              slice;         /* stage group of the current work     */
+} HPE_THREADS_T, *HPE_THREADS_P_T;
+
+
+/*  the following structures hold the output writer thread. Each output
+ *  file attached to the writer has writequeue+1 sets of row buffers
+ *  (jobs): one is filled by the processing thread, the others are queued
+ *  for the writer or free. Full jobs go to the writer through a single
+ *  producer, single consumer ring and come back through a free ring per
+ *  file; neither ring takes a lock. A thread finding its ring empty
+ *  waits on a condition variable of the writer.
+ *
+ *  OUTPUT WRITER STRUCTURES
+ */
+
+#define HPE_MAX_WRITE_FILES  2    /* output event file and bad event file  */
+
+typedef struct hpe_ring_t {
+   void**          item;          /* ring entries                          */
+   unsigned long   mask;          /* # entries - 1 (a power of 2 - 1)      */
+   unsigned long   head;          /* next entry to pop (consumer)          */
+   unsigned long   tail;          /* next entry to push (producer)         */
+} HPE_RING_T, *HPE_RING_P_T;
+
+typedef struct hpe_write_job_t {
+   EVENT_SETUP_P_T           evtout_p;  /* output event file               */
+   struct hpe_writer_file_t* file_p;    /* writer file of the job          */
+   void**                    buf;       /* row buffer of each column       */
+   long                      first;     /* table row of the first row      */
+   long                      num_rows;  /* number of rows                  */
+} HPE_WRITE_JOB_T, *HPE_WRITE_JOB_P_T;
+
+typedef struct hpe_writer_file_t {
+   struct hpe_event_writer_t* writer_p; /* writer thread                   */
+   EVENT_SETUP_P_T    evtout_p;    /* output event file                    */
+   int                slot;        /* slot in the writer file list         */
+   int                num_jobs;    /* # row buffer sets (writequeue+1)     */
+   HPE_WRITE_JOB_P_T  job;         /* row buffer sets                      */
+   HPE_WRITE_JOB_P_T  cur_p;       /* set being filled (= plan buf)        */
+   HPE_RING_T         idle;        /* sets written by the writer thread    */
+} HPE_WRITER_FILE_T, *HPE_WRITER_FILE_P_T;
+
+typedef struct hpe_event_writer_t {
+   pthread_t           tid;        /* writer thread id                     */
+   boolean             running;    /* TRUE = writer thread started         */
+   int                 stop;       /* set to stop the writer thread        */
+   int                 depth;      /* # queued sets per file (writequeue)  */
+   pthread_mutex_t     lock;       /* lock of the waits below              */
+   pthread_cond_t      queued;     /* a set was queued (or stop was set)   */
+   pthread_cond_t      written;    /* a set was written                    */
+   HPE_RING_T          queue;      /* sets waiting to be written           */
+   HPE_WRITER_FILE_P_T file[HPE_MAX_WRITE_FILES]; /* attached files       */
+   long                num_queued; /* # sets queued (processing thread)    */
+   long                num_written;/* # sets written (writer thread)       */
+   double              depth_sum;  /* sum of the queue depth when queued   */
+   long                depth_max;  /* maximum queue depth                  */
+   double              stall_s;    /* seconds waited for the writer        */
+   double              busy_s;     /* seconds spent writing (writer)       */
+} HPE_EVENT_WRITER_T, *HPE_EVENT_WRITER_P_T;
+
+
+/*  the following structure holds the input prefetch thread, which opens
+ *  the next input file of the stack (and reads its first block of rows
+ *  when batch=yes) while the current file is processed. A thread is
+ *  started for each file and joined when the file is needed.
+ *
+ *  INPUT PREFETCH STRUCTURE
+ */
+
+typedef struct hpe_prefetch_t {
+   pthread_t        tid;          /* prefetch thread id                   */
+   boolean          running;      /* TRUE = thread not yet joined         */
+   char*            file;         /* input file opened ahead              */
+   EVENT_SETUP_T    evt;          /* input file info of the opened file   */
+   boolean          opened;       /* TRUE = file opened, columns set up   */
+   EVENT_BLOCK_P_T  blk_p;        /* first block of rows (NULL = none)    */
+   long             block_rows;   /* rows per block (0 = no block read)   */
+   long             rowstart;     /* first row of each file to process    */
+   long             rowstop;      /* last row to process (0 = last row)   */
+   double           tmin;         /* earliest time (0 = no limit)         */
+   double           tmax;         /* latest time (0 = no limit)           */
+   boolean          fastread;     /* TRUE = map plain FITS input files    */
+   boolean*         read_field;   /* input fields to read (by mapping)    */
+   long             num_started;  /* # files opened ahead                 */
+   long             num_used;     /* # files opened ahead and used        */
+   double           wait_s;       /* seconds waited for the thread        */
+} HPE_PREFETCH_T, *HPE_PREFETCH_P_T;
+
+
+/*
+ *  the following externs are function prototypes of the event pipeline
+ *  routines which have public access from other routines.
+ *
+ *  FUNCTION PROTOTYPES
+ */
+
+/* routine to allocate an event batch */
+extern EVENT_BATCH_P_T allocate_event_batch(long,
+                                            dsErrList*);
+
+/* routine to free an event batch */
+extern void deallocate_event_batch(EVENT_BATCH_P_T*);
+
+/* routine to load the rows of an event block into an event batch */
+extern void load_event_batch(HPE_PIPELINE_P_T,
+                             EVENT_BLOCK_P_T,
+                             EVENT_BATCH_P_T);
+
+/* routine to run every processing stage over an event batch */
+extern void process_event_batch(HPE_PIPELINE_P_T,
+                                EVENT_BATCH_P_T);
+
+/* routine to run a group of stages over a range of an event batch */
+extern void process_event_slice(HPE_PIPELINE_P_T,
+                                EVENT_BATCH_P_T,
+                                int,
+                                long,
+                                long,
+                                HPE_TIMERS_P_T);
+
+/* routine to run every processing stage on a single event */
+extern void process_event(HPE_PIPELINE_P_T,
+                          EVENT_REC_P_T);
+
+/* processing stages- each is applied to one event (hpe_stage_tapring,
+ * hpe_stage_filters and hpe_stage_pi to a range of events) */
+extern void hpe_stage_ampsf(HPE_PIPELINE_P_T,
+                            EVENT_REC_P_T);
+extern void hpe_stage_tapring(HPE_PIPELINE_P_T,
+                              EVENT_REC_P_T,
+                              long);
+extern void hpe_stage_adc(HPE_PIPELINE_P_T,
+                          EVENT_REC_P_T);
+extern void hpe_stage_filters(HPE_PIPELINE_P_T,
+                              EVENT_REC_P_T,
+                              long);
+extern boolean hpe_stage_coords(HPE_PIPELINE_P_T,
+                                EVENT_REC_P_T);
+
+/* routine to resolve the alignment and aspect for an event time */
+extern void hpe_resolve_aspect(HPE_PIPELINE_P_T,
+                               double);
+extern void hpe_stage_pi(HPE_PIPELINE_P_T,
+                         EVENT_REC_P_T,
+                         boolean*,
+                         long);
+extern void hpe_stage_badpix(HPE_PIPELINE_P_T,
+                             EVENT_REC_P_T);
+extern void hpe_stage_write(HPE_PIPELINE_P_T,
+                            EVENT_REC_P_T,
+                            boolean);
+
+/* routine to start the worker threads */
+extern HPE_THREADS_P_T allocate_event_threads(int,
+                                              dsErrList*);
+
+/* routine to stop the worker threads and free their memory */
+extern void deallocate_event_threads(HPE_THREADS_P_T*);
+
+/* routine to run a group of stages over a batch with the worker threads */
+extern void run_event_threads(HPE_THREADS_P_T,
+                              HPE_PIPELINE_P_T,
+                              EVENT_BATCH_P_T,
+                              int);
+
+/* routine to set up the stage timers (and open the JSON timing file) */
+extern HPE_TIMERS_P_T allocate_stage_timers(char*,
+                                            dsErrList*);
+
+/* routine to report the run times, close the JSON file and free timers */
+extern void deallocate_stage_timers(HPE_TIMERS_P_T*,
+                                    STATISTICS_P_T,
+                                    FILE*,
+                                    int);
+
+/* routine to start timing an input file */
+extern void start_file_timers(HPE_TIMERS_P_T,
+                              STATISTICS_P_T);
+
+/* routine to report the times of an input file */
+extern void end_file_timers(HPE_TIMERS_P_T,
+                            char*,
+                            STATISTICS_P_T,
+                            FILE*,
+                            int);
+
+/* routine to read the wall clock (0 if not timed) */
+extern double start_stage_timer(HPE_TIMERS_P_T);
+
+/* routine to add the time since *t_p to a stage and restart the clock */
+extern void lap_stage_timer(HPE_TIMERS_P_T,
+                            int,
+                            double*);
+
+/* routine to start the output writer thread */
+extern HPE_EVENT_WRITER_P_T allocate_event_writer(int,
+                                                  dsErrList*);
+
+/* routine to hand the rows of an output file to the writer thread */
+extern boolean attach_event_writer(HPE_EVENT_WRITER_P_T,
+                                   EVENT_SETUP_P_T,
+                                   dsErrList*);
+
+/* routine to wait until every queued row has been written */
+extern void drain_event_writer(HPE_EVENT_WRITER_P_T);
+
+/* routine to write the rows, stop the writer thread and report it */
+extern void deallocate_event_writer(HPE_EVENT_WRITER_P_T*,
+                                    FILE*,
+                                    int);
+
+/* routines to serialize the datamodel calls of the threads */
+extern void lock_datamodel(void);
+extern void unlock_datamodel(void);
+
+/* routine to set up the input prefetch */
+extern HPE_PREFETCH_P_T allocate_input_prefetch(INPUT_PARMS_P_T,
+                                                dsErrList*);
+
+/* routine to start opening an input file in the background */
+extern void start_input_prefetch(HPE_PREFETCH_P_T,
+                                 char*);
+
+/* routine to take the input file (and first block) opened ahead */
+extern boolean take_input_prefetch(HPE_PREFETCH_P_T,
+                                   EVENT_SETUP_P_T,
+                                   EVENT_BLOCK_P_T*);
+
+/* routine to stop the prefetch, report it and free its memory */
+extern void deallocate_input_prefetch(HPE_PREFETCH_P_T*,
+                                      FILE*,
+                                      int);
+
+/* routine to read the aspect stack into memory */
+extern HPE_ASPECT_STORE_P_T load_aspect_store(ASPECT_INFRA_P_T,
+                                              dsErrList*);
+
+/* routine to find the aspect record of an event time */
+extern void find_aspect_record(HPE_ASPECT_STORE_P_T,
+                               double,
+                               ASPECT_REC_P_T,
+                               double*);
+
+/* routine to free the aspect store */
+extern void deallocate_aspect_store(HPE_ASPECT_STORE_P_T*);
+
+#endif   /* last line of header file- closes #ifndef EVENT_BATCH_DEFS_H */
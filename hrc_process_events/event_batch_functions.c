@@ -0,0 +1,855 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: event_batch_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file event_batch_functions.c contains the following modules used
+  by hrc_process_events() to process the events of an input file:
+
+        allocate_event_batch()
+        deallocate_event_batch()
+        load_event_batch()
+        process_event_batch()
+        process_event_slice()
+        process_event()
+        hpe_stage_ampsf()
+        hpe_stage_tapring()
+        hpe_stage_adc()
+        hpe_stage_filters()
+        hpe_stage_coords()
+        hpe_resolve_aspect()
+        hpe_stage_pi()
+        hpe_stage_badpix()
+        hpe_stage_write()
+
+  The processing of an event is split into stages. process_event() runs
+  all of the stages on one event (the original per-event loop, used when
+  batch=no). process_event_batch() runs each stage over all of the events
+  of a batch before starting the next stage (batch=yes).
+
+* NOTES:
+
+  The stages that keep state from one event to the next only use state of
+  their own, so running them stage by stage over the events of a batch in
+  input order gives the same output as the per-event loop:
+
+     hpe_stage_coords - earliest/latest event times, sequence check,
+                        alignment and aspect updates
+                        (which also set up pixlib for the event) and the
+                        pixlib random numbers used for randomization
+                        (rand_gen=pixlib; the counter based generator
+                        only depends on the event row)
+     hpe_stage_write  - output rows of the event and bad event files
+
+  The other stages (amp_sf, tap ring, ADC, filters, pi and badpix) only
+  change the event
+  record they are given. process_event_slice() runs them over a range of
+  the batch; with nthreads > 1 the batch is split into one range per
+  thread (see event_thread_functions.c) while the stages above still run
+  in the calling thread in input order, so the output does not depend on
+  the number of threads.
+
+  The batch holds whole event records (array of structures), not one
+  array per field (amps_dd, cp, rawpos, chippos, status, ...):
+  calculate_coords_hrc(), calculate_pi_hrc(), check_for_bad_pixels()
+  and the output write plan all take an EVENT_REC_T, and keeping both
+  forms in step would cost more than it saves. Instead, the stages which
+  run one computation over many events gather the fields they need into
+  arrays of their own a chunk at a time (check_tap_ring_batch(),
+  check_adc_filters(), S_new_gain_pi_range()) and write the results back
+  to the records.
+
+* REVISION HISTORY:
+  10/2026 - initial version; body of the event loop moved here from
+            hrc_process_events.c.
+  10/2026 - add process_event_slice() so the stages without event to
+            event state can be shared out between threads; move the
+            event time range from hpe_stage_amps to hpe_stage_coords.
+  10/2026 - set the input row of each event (randomization counter).
+  10/2026 - split hpe_stage_amps() into the amp_sf, tap ring and ADC
+            stages and time each stage (HPE_TIMER_*, hpe_timers.c).
+  10/2026 - hand the rows of the bad event file to the writer thread
+            (writequeue > 0) once the file is created.
+  10/2026 - hpe_stage_filters() performs the filtering tests on a range
+            of events in one pass (check_adc_filters()).
+  10/2026 - hpe_stage_tapring() corrects a range of events
+            (check_tap_ring_batch(); fastmath).
+  10/2026 - resolve the alignment and aspect once for the events sharing
+            a time (hpe_resolve_aspect()); the event time is no longer
+            shifted by time_offset and back around alignment_update().
+  10/2026 - pass the sky transform to calculate_coords_hrc() (fastsky).
+  10/2026 - take the aspect record from the aspect store (aspstore).
+  10/2026 - pass the chip transforms to calculate_coords_hrc() and fit
+            them again when the alignment changes (fastchip).
+  10/2026 - the ADC correction and the tap range check of the coordinate
+            stage read the tap calibration records (hpe_tap_cal.c).
+  10/2026 - hpe_stage_pi() computes the pulse invariance of a range of
+            events; the hrcS gain table is read there for the range
+            (S_new_gain_pi_range()) instead of in the coordinate stage.
+  10/2026 - release the datamodel lock while the slices of a batch are
+            processed, so the writer thread can write meanwhile.
+  10/2026 - with the aspect store and no alignment file, a segment lasts
+            for the span of its aspect record (aspect_seg.spans).
+  10/2026 - keep the aspect record of the store for every time up to its
+            own, as aspect_update() does.
+  10/2026 - call aspect_update() only once the time is past the record
+            it gave (aspstore = no as well); a segment lasts for the
+            aspect record whenever there is no alignment file.
+  10/2026 - load_event_batch() skips the events outside the time window;
+            the input row is taken from the event record.
+  10/2026 - note why the batch holds event records rather than one
+            array per field.
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_event_batch() allocates a batch able to hold
+  'size' events. A NULL pointer is returned and an error is added to the
+  error list if the memory could not be allocated.
+
+*************************************************************************/
+
+EVENT_BATCH_P_T allocate_event_batch(
+   long       size,           /* I - number of events per batch       */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   EVENT_BATCH_P_T bat_p = NULL;
+
+   if ((bat_p = (EVENT_BATCH_P_T) calloc(1, sizeof(EVENT_BATCH_T))) != NULL)
+   {
+      bat_p->size = size;
+      bat_p->evt = (EVENT_REC_P_T) calloc(size, sizeof(EVENT_REC_T));
+      bat_p->bad = (boolean*) calloc(size, sizeof(boolean));
+   }
+
+   if ((bat_p == NULL) || (bat_p->evt == NULL) || (bat_p->bad == NULL))
+   {
+      deallocate_event_batch(&bat_p);
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up event batch.");
+   }
+
+   return (bat_p);
+} /* end: allocate_event_batch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_event_batch() frees the memory of an event batch
+  and sets the batch pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_event_batch(
+   EVENT_BATCH_P_T* bat_pp)   /* I/O - event batch pointer            */
+{
+   if (*bat_pp != NULL)
+   {
+      if ((*bat_pp)->evt != NULL)
+      {
+         free((*bat_pp)->evt);
+      }
+      if ((*bat_pp)->bad != NULL)
+      {
+         free((*bat_pp)->bad);
+      }
+      free(*bat_pp);
+      *bat_pp = NULL;
+   }
+} /* end: deallocate_event_batch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine load_event_batch() loads the rows of an event block into
+  the event records of a batch, skipping the events whose time is not in
+  the time window (outside_time_window()). The batch must be at least as
+  large as the block.
+
+*************************************************************************/
+
+void load_event_batch(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_BLOCK_P_T  blk_p,    /* I   - block of input rows            */
+   EVENT_BATCH_P_T  bat_p)    /* O   - event batch                    */
+{
+   long ii;
+   long nn = 0;
+
+   memset(bat_p->evt, 0, blk_p->num_rows * sizeof(EVENT_REC_T));
+   memset(bat_p->bad, 0, blk_p->num_rows * sizeof(boolean));
+
+   for (ii = 0; ii < blk_p->num_rows; ii++)
+   {
+      bat_p->evt[nn].time = pln_p->inp_p->default_time;
+      bat_p->evt[nn].row = blk_p->first_row + ii;
+      load_event_data(pln_p->evtin_p, blk_p, ii, &bat_p->evt[nn]);
+
+      /* a row out of time sequence may be outside the time window */
+      if (outside_time_window(pln_p->inp_p, bat_p->evt[nn].time))
+      {
+         memset(&bat_p->evt[nn], 0, sizeof(EVENT_REC_T));
+      }
+      else
+      {
+         nn++;
+      }
+   }
+   bat_p->first_row = blk_p->first_row;
+   bat_p->num_rows = blk_p->num_rows;
+   bat_p->num_events = nn;
+} /* end: load_event_batch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine process_event_batch() applies each processing stage to
+  all of the events of a batch, in input order, and writes the events
+  to the output (or bad event) file. The datamodel lock is released
+  while the slices of the batch are processed.
+
+*************************************************************************/
+
+void process_event_batch(
+   HPE_PIPELINE_P_T pln_p,    /* I/O - event pipeline                 */
+   EVENT_BATCH_P_T  bat_p)    /* I/O - event batch                    */
+{
+   EVENT_REC_P_T evt_p;
+   long ii;
+   long nn = bat_p->num_events;
+   double tt;
+
+   /* the slices make no datamodel call- the writer thread may write */
+   unlock_datamodel();
+   if (pln_p->threads_p != NULL)
+   {
+      run_event_threads(pln_p->threads_p, pln_p, bat_p, HPE_SLICE_AMPS);
+   }
+   else
+   {
+      process_event_slice(pln_p, bat_p, HPE_SLICE_AMPS, 0, nn,
+                          pln_p->timers_p);
+   }
+   lock_datamodel();
+
+   for (ii = 0, evt_p = bat_p->evt; ii < nn; ii++, evt_p++)
+   {
+      pln_p->row = evt_p->row;
+      bat_p->bad[ii] = hpe_stage_coords(pln_p, evt_p);
+   }
+
+   unlock_datamodel();
+   if (pln_p->threads_p != NULL)
+   {
+      run_event_threads(pln_p->threads_p, pln_p, bat_p, HPE_SLICE_PI);
+   }
+   else
+   {
+      process_event_slice(pln_p, bat_p, HPE_SLICE_PI, 0, nn,
+                          pln_p->timers_p);
+   }
+   lock_datamodel();
+
+   tt = start_stage_timer(pln_p->timers_p);
+   for (ii = 0, evt_p = bat_p->evt; ii < nn; ii++, evt_p++)
+   {
+      hpe_stage_write(pln_p, evt_p, bat_p->bad[ii]);
+   }
+   lap_stage_timer(pln_p->timers_p, HPE_TIMER_WRITE, &tt);
+} /* end: process_event_batch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine process_event_slice() applies the stages of the specified
+  group (HPE_SLICE_*) to the events first through last-1 of a batch:
+
+     HPE_SLICE_AMPS - hpe_stage_ampsf(), hpe_stage_tapring(),
+                      hpe_stage_adc() then hpe_stage_filters()
+     HPE_SLICE_PI   - hpe_stage_pi() then hpe_stage_badpix() on the
+                      events not rejected by hpe_stage_coords()
+
+  These stages do not keep any state from one event to the next, so
+  separate ranges of a batch may be processed at the same time. Each
+  stage is timed if tim_p is not NULL (only the calling thread times
+  its range).
+
+*************************************************************************/
+
+void process_event_slice(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_BATCH_P_T  bat_p,    /* I/O - event batch                    */
+   int              slice,    /* I   - stage group (HPE_SLICE_*)      */
+   long             first,    /* I   - index of first event           */
+   long             last,     /* I   - index after the last event     */
+   HPE_TIMERS_P_T   tim_p)    /* I/O - stage timers (NULL = none)     */
+{
+   EVENT_REC_P_T evt_p;
+   long ii;
+   double tt = start_stage_timer(tim_p);
+
+   switch (slice)
+   {
+      case HPE_SLICE_AMPS:
+         for (ii = first, evt_p = &bat_p->evt[first]; ii < last;
+              ii++, evt_p++)
+         {
+            hpe_stage_ampsf(pln_p, evt_p);
+         }
+         lap_stage_timer(tim_p, HPE_TIMER_AMPSF, &tt);
+
+         hpe_stage_tapring(pln_p, &bat_p->evt[first], last - first);
+         lap_stage_timer(tim_p, HPE_TIMER_TAPRING, &tt);
+
+         for (ii = first, evt_p = &bat_p->evt[first]; ii < last;
+              ii++, evt_p++)
+         {
+            hpe_stage_adc(pln_p, evt_p);
+         }
+         lap_stage_timer(tim_p, HPE_TIMER_ADC, &tt);
+
+         hpe_stage_filters(pln_p, &bat_p->evt[first], last - first);
+         lap_stage_timer(tim_p, HPE_TIMER_FILTERS, &tt);
+      break;
+
+      case HPE_SLICE_PI:
+         hpe_stage_pi(pln_p, &bat_p->evt[first], &bat_p->bad[first],
+                      last - first);
+         lap_stage_timer(tim_p, HPE_TIMER_PI, &tt);
+
+         for (ii = first, evt_p = &bat_p->evt[first]; ii < last;
+              ii++, evt_p++)
+         {
+            if (!bat_p->bad[ii])
+            {
+               hpe_stage_badpix(pln_p, evt_p);
+            }
+         }
+         lap_stage_timer(tim_p, HPE_TIMER_BADPIX, &tt);
+      break;
+
+      default:
+      break;
+   }
+} /* end: process_event_slice */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine process_event() applies every processing stage to a single
+  event and writes it to the output (or bad event) file.
+
+*************************************************************************/
+
+void process_event(
+   HPE_PIPELINE_P_T pln_p,    /* I/O - event pipeline                 */
+   EVENT_REC_P_T    evt_p)    /* I/O - event record                   */
+{
+   HPE_TIMERS_P_T tim_p = pln_p->timers_p;
+   boolean bad;
+   double  tt = start_stage_timer(tim_p);
+
+   hpe_stage_ampsf(pln_p, evt_p);
+   lap_stage_timer(tim_p, HPE_TIMER_AMPSF, &tt);
+   hpe_stage_tapring(pln_p, evt_p, 1);
+   lap_stage_timer(tim_p, HPE_TIMER_TAPRING, &tt);
+   hpe_stage_adc(pln_p, evt_p);
+   lap_stage_timer(tim_p, HPE_TIMER_ADC, &tt);
+   hpe_stage_filters(pln_p, evt_p, 1);
+   lap_stage_timer(tim_p, HPE_TIMER_FILTERS, &tt);
+
+   /* hpe_stage_coords() times itself */
+   bad = hpe_stage_coords(pln_p, evt_p);
+   tt = start_stage_timer(tim_p);
+
+   if (!bad)
+   {
+      hpe_stage_pi(pln_p, evt_p, NULL, 1);
+      lap_stage_timer(tim_p, HPE_TIMER_PI, &tt);
+      hpe_stage_badpix(pln_p, evt_p);
+      lap_stage_timer(tim_p, HPE_TIMER_BADPIX, &tt);
+   }
+   hpe_stage_write(pln_p, evt_p, bad);
+   lap_stage_timer(tim_p, HPE_TIMER_WRITE, &tt);
+} /* end: process_event */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_ampsf() resets the status bits and applies the
+  amp_sf correction to the amplitudes of an event. Like the tap ring and
+  ADC stages below, it only changes the event record, so it may run on
+  several events at the same time.
+
+*************************************************************************/
+
+void hpe_stage_ampsf(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p)    /* I/O - event record                   */
+{
+   INPUT_PARMS_P_T inp_p = pln_p->inp_p;
+
+   initial_status(inp_p, evt_p);
+
+   /*************************************
+    * (8/2002) - amp_sf corrections
+    *************************************/
+   if (( inp_p->do_amp_sf_cor == TRUE) &&
+       ( inp_p->get_range_switch_level == TRUE) &&
+       ( inp_p->match_range_switch_level == TRUE)  )
+   {
+      apply_amp_sf_cor(evt_p, pln_p->ampsfcor_coeff) ;
+   }
+} /* end: hpe_stage_ampsf */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_tapring() applies the tap ring correction to the
+  third amplitude of num_evt consecutive events, if tap ring coefficients
+  were provided. The pow() and sin() of the corrected axes are evaluated
+  together (check_tap_ring_batch()), with approximations if fastmath=yes.
+
+*************************************************************************/
+
+void hpe_stage_tapring(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p,    /* I/O - first event record             */
+   long             num_evt)  /* I   - number of events               */
+{
+   /*********************************************************
+    * JCC(5/1/00) -
+    *   check_tap_ring  computes the corrected A3 and stored in
+    *   evt_p->amps_dd[u:v_axes][3]. The new A3 will be used to
+    *   compute the fine coordinates and for other tests.
+    *
+    *   The fine coordinates will be computed in the existing
+    *   function calculate_coords_hrc.
+    *********************************************************/
+   if (pln_p->tring_coeffs_p != NULL)
+       check_tap_ring_batch(pln_p->inp_p, evt_p, num_evt,
+                            pln_p->tring_coeffs_p );
+} /* end: hpe_stage_tapring */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_adc() removes the extra bit of the HRC-I flight
+  coarse position and applies the ADC correction to the amplitudes of an
+  event.
+
+*************************************************************************/
+
+void hpe_stage_adc(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p)    /* I/O - event record                   */
+{
+   INPUT_PARMS_P_T inp_p = pln_p->inp_p;
+
+   /* if HRC-i flight data extra bit should be removed */
+   if ((evt_p->cp[HDET_PLANE_Y] >= 64) &&
+       (inp_p->hrc_system == HRC_IMG_SYS))
+   {
+      evt_p->cp[HDET_PLANE_Y] -= 64;
+   }
+
+   if (inp_p->do_ADC && (pln_p->tapcal_p != NULL))
+   {
+      /* (10/2026) one tap calibration record per axis */
+      apply_tap_cal_adc(pln_p->tapcal_p, evt_p);
+   }
+   else if (inp_p->do_ADC)
+   {
+      apply_adc_correction(pln_p->adc_x, pln_p->adc_y, inp_p, evt_p);
+   }
+} /* end: hpe_stage_adc */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_filters() performs the ADC filtering tests
+  (hyperbolic, saturation and flatness) on num_evt consecutive events,
+  if ARDs were provided. The three tests are performed in one pass over
+  the events (check_adc_filters()).
+
+*************************************************************************/
+
+void hpe_stage_filters(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p,    /* I/O - first event record             */
+   long             num_evt)  /* I   - number of events               */
+{
+   check_adc_filters(evt_p, num_evt, pln_p->hyp_test_coeffs_p,
+                     pln_p->sat_test_coeffs_p, pln_p->flat_test_coeffs_p);
+} /* end: hpe_stage_filters */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_coords() keeps track of the earliest and latest
+  event times, checks the event time sequence, updates the alignment and
+  aspect for the event time (once for the events of a segment, see
+  hpe_resolve_aspect()) and computes the event coordinates. The
+  routine returns TRUE if the event is rejected (it goes to the bad event
+  file). The alignment/aspect part and calculate_coords_hrc() are timed
+  separately.
+
+*************************************************************************/
+
+boolean hpe_stage_coords(
+   HPE_PIPELINE_P_T pln_p,    /* I/O - event pipeline                 */
+   EVENT_REC_P_T    evt_p)    /* I/O - event record                   */
+{
+   INPUT_PARMS_P_T inp_p = pln_p->inp_p;
+   boolean bad;
+   double  tt = start_stage_timer(pln_p->timers_p);
+
+   /* keep track of earliest and latest event times */
+   if (evt_p->time < inp_p->evt_tstart)
+   {
+      inp_p->evt_tstart = evt_p->time;
+   }
+   else if (evt_p->time > inp_p->evt_tstop)
+   {
+      inp_p->evt_tstop = evt_p->time;
+   }
+
+   if (evt_p->time < pln_p->last_time)
+   {
+      dsErrAdd(pln_p->err_p, dsHPEEVENTSEQERR, Accumulation, Generic,
+         pln_p->evtin_p->file);
+      evt_p->status |= HDET_SEQUENCE_STS;
+      pln_p->stat_p->sequence_err++;
+      pln_p->bad_interval++;
+   }
+   else
+   {
+      if ((pln_p->debug > DEBUG_LEVEL_3) && (pln_p->bad_interval != 0))
+      {
+         fprintf(pln_p->log_ptr,
+            "%3ld bad events occurred between time %8f and %8f\n",
+            pln_p->bad_interval, pln_p->last_time, evt_p->time);
+         pln_p->bad_interval = 0;
+      }
+      pln_p->last_time = evt_p->time;
+   }
+
+   /* alignment and aspect records for the event time, unless the time
+    * is that of the segment or (spans, no alignment file) not past its
+    * aspect record */
+   if (!pln_p->aspect_seg.valid ||
+       ((evt_p->time != pln_p->aspect_seg.time) &&
+        (!pln_p->aspect_seg.spans ||
+         (evt_p->time > pln_p->aspect_seg.asp_stop))))
+   {
+      hpe_resolve_aspect(pln_p, evt_p->time);
+   }
+   pln_p->aspect_seg.num_events++;
+
+   /* update statistical file counts */
+   pln_p->stat_p->total_events_in++;
+
+   /* set next-in-line status bit if needed */
+   if (inp_p->next_in_line)
+   {
+      evt_p->status |= HDET_NEXT_IN_LINE_STS;
+   }
+   lap_stage_timer(pln_p->timers_p, HPE_TIMER_ASPECT, &tt);
+
+   /*********************************************************
+    *   compute the fine coordinates
+    *********************************************************/
+   bad = calculate_coords_hrc(evt_p, inp_p, pln_p->stat_p,
+                              &pln_p->asp_p->entry[pln_p->asp_p->next],
+                              pln_p->dgp_p, pln_p->asp_hk_p->asp_file_type,
+                              (inp_p->fastsky) ? &pln_p->tan_xform : NULL,
+                              (inp_p->fastchip) ? &pln_p->chip_xform : NULL,
+                              pln_p->tapcal_p, pln_p->err_p);
+   lap_stage_timer(pln_p->timers_p, HPE_TIMER_COORDS, &tt);
+
+   if (!bad && (pln_p->debug > DEBUG_LEVEL_4))
+   {
+      fprintf(pln_p->log_ptr,
+         "%9.4f   %3d %3d %4d %4d %4d %4d %4d %4d %5d\n",
+         evt_p->time, evt_p->cp[HDET_PLANE_X],
+         evt_p->cp[HDET_PLANE_Y],
+         evt_p->amps_sh[HDET_PLANE_X][HDET_1ST_AMP],
+         evt_p->amps_sh[HDET_PLANE_X][HDET_2ND_AMP],
+         evt_p->amps_sh[HDET_PLANE_X][HDET_3RD_AMP],
+         evt_p->amps_sh[HDET_PLANE_Y][HDET_1ST_AMP],
+         evt_p->amps_sh[HDET_PLANE_Y][HDET_2ND_AMP],
+         evt_p->amps_sh[HDET_PLANE_Y][HDET_3RD_AMP],
+         evt_p->sum_amps);
+
+      printf(
+         "%9.4f %6ld %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f\n",
+         evt_p->time, pln_p->row,
+         evt_p->amps_dd[HDET_PLANE_X][HDET_1ST_AMP],
+         evt_p->amps_dd[HDET_PLANE_X][HDET_2ND_AMP],
+         evt_p->amps_dd[HDET_PLANE_X][HDET_3RD_AMP],
+         evt_p->amps_dd[HDET_PLANE_Y][HDET_1ST_AMP],
+         evt_p->amps_dd[HDET_PLANE_Y][HDET_2ND_AMP],
+         evt_p->amps_dd[HDET_PLANE_Y][HDET_3RD_AMP],
+         evt_p->amp_tot[HDET_PLANE_X]);
+   }
+
+   return (bad);
+} /* end: hpe_stage_coords */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_resolve_aspect() updates the alignment (at the event
+  time plus time_offset) and the aspect for an event time, and starts
+  a new aspect segment at that time. Since alignment_update() and
+  aspect_update() only read ahead as the time advances, updating them
+  again for the same time changes nothing; the events of the segment
+  skip the update. A segment whose update failed is not kept, so the
+  next event updates (and reports the error) again. With fastchip, the
+  chip to fpc transforms are fitted again if the alignment changed.
+
+  The aspect record in entry[next] is used as read, up to its own time
+  (asp_stop): aspect_update() only reads on once the time is past it,
+  so it is not called before, and the aspect store (aspstore = yes) is
+  only queried then. The alignment library gives no time up to which
+  its record holds, so with an alignment file the alignment is updated
+  for every new event time. Without one (aspect_seg.spans) it does not
+  change with time and the segment lasts for the aspect record: the
+  events of the record skip both updates. The sky transform of the
+  record (fastsky) is likewise fitted once per record.
+
+*************************************************************************/
+
+void hpe_resolve_aspect(
+   HPE_PIPELINE_P_T pln_p,    /* I/O - event pipeline                 */
+   double           time)     /* I   - event time                     */
+{
+   boolean ok = TRUE;
+
+   /* add time offset to event time for alignment sequence */
+   if (alignment_update(pln_p->aln_p, pln_p->aln_hk_p,
+                        time + pln_p->inp_p->time_offset))
+   {
+      dsErrAdd(pln_p->err_p, dsHPEALIGNMENTERR, Individual, Generic);
+      ok = FALSE;
+   }
+   else if (pln_p->inp_p->fastchip)
+   {
+      /* (fastchip) the chip to fpc transforms follow the alignment */
+      update_chip_xforms(&pln_p->chip_xform, pln_p->aln_p);
+   }
+
+   /* the aspect record is kept until the time is past its own */
+   if (time > pln_p->aspect_seg.asp_stop)
+   {
+      if (pln_p->asp_store_p != NULL)
+      {
+         find_aspect_record(pln_p->asp_store_p, time,
+                            &pln_p->asp_p->entry[pln_p->asp_p->next],
+                            &pln_p->aspect_seg.asp_stop);
+         pln_p->aspect_seg.num_records++;
+      }
+      else if (aspect_update(pln_p->asp_p, pln_p->asp_hk_p, time))
+      {
+         dsErrAdd(pln_p->err_p, dsHPEASPECTERR, Individual, Generic);
+         pln_p->aspect_seg.asp_stop = -DBL_MAX;
+         ok = FALSE;
+      }
+      else
+      {
+         pln_p->aspect_seg.asp_stop =
+            pln_p->asp_p->entry[pln_p->asp_p->next].time;
+         pln_p->aspect_seg.num_records++;
+      }
+   }
+
+   pln_p->aspect_seg.valid = ok;
+   pln_p->aspect_seg.time = time;
+   pln_p->aspect_seg.num_segments++;
+} /* end: hpe_resolve_aspect */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_pi() computes the pulse invariance of the good
+  events of a range (bad[ii] FALSE; every event if bad is NULL) from the
+  gain map, or sets pi=pha if no gain map is used. With the hrcS gain
+  table, pi_double of the whole range is computed first
+  (S_new_gain_pi_range()) from the raw positions of the coordinate stage.
+
+*************************************************************************/
+
+void hpe_stage_pi(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p,    /* I/O - first event record             */
+   boolean*         bad,      /* I   - TRUE = rejected (NULL = none)  */
+   long             count)    /* I   - number of events               */
+{
+   INPUT_PARMS_P_T inp_p = pln_p->inp_p;
+   long ii;
+
+   /* raw positions (and DDn) are only computed from coarse positions */
+   if (inp_p->do_pi && (inp_p->gainflag == NEW_S_GAIN) &&
+       (inp_p->start == HDET_COARSE_VAL))
+   {
+      S_new_gain_pi_range(inp_p, evt_p, bad, count);
+   }
+
+   for (ii = 0; ii < count; ii++, evt_p++)
+   {
+      if ((bad != NULL) && bad[ii])
+      {
+         continue;
+      }
+
+      /* use the gain map to calculate pi , or set pi=pha*/
+      if (inp_p->do_pi)
+      {
+         calculate_pi_hrc(pln_p->gain_p, inp_p, evt_p);
+      }
+      else                                /* 7/18/00 */
+      {
+         evt_p->pi = evt_p->pha ;
+
+        /*10/2009- see 'Notes on outCol PI' */
+         long HDET_MAX_PI_VALUE =  HDET_MAX_PI_OLD ;   /* 255 */
+         if (inp_p->gainflag != OLD_SI_GAIN )
+            HDET_MAX_PI_VALUE = HDET_MAX_PI_NEW ;      /* 1023*/
+
+         /* (6/25/01) - add */
+         if (evt_p->pi > HDET_MAX_PI_VALUE)     /*255 or 1023*/
+         {
+            evt_p->status |= HDET_PI_VALUE_STS; /*flag if pi > max */
+            evt_p->pi = HDET_MAX_PI_VALUE ;
+         }
+         /* end: (6/25/01) */
+      }
+   }
+} /* end: hpe_stage_pi */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_badpix() sets the status bits of a good event
+  that falls on a hot spot (bad pixel).
+
+*************************************************************************/
+
+void hpe_stage_badpix(
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_REC_P_T    evt_p)    /* I/O - event record                   */
+{
+   check_for_bad_pixels(pln_p->hotpix_p, pln_p->hotidx_p, evt_p);
+} /* end: hpe_stage_badpix */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_stage_write() writes a good event to the output event
+  file, or a rejected event to the bad event file (which is created when
+  the first event is rejected). The writer thread, if any, is idle while
+  the bad event file is created and then also writes its rows.
+
+*************************************************************************/
+
+void hpe_stage_write(
+   HPE_PIPELINE_P_T pln_p,    /* I/O - event pipeline                 */
+   EVENT_REC_P_T    evt_p,    /* I   - event record                   */
+   boolean          bad)      /* I   - TRUE = event was rejected      */
+{
+   if (bad)
+   {
+      /* reject event */
+      if (pln_p->setup_badfile)
+      {
+         pln_p->evtbout_p->file = pln_p->inp_p->badfile;
+         pln_p->evtbout_p->eventdef = pln_p->inp_p->badoutcols;
+         drain_event_writer(pln_p->writer_p);
+         hrc_process_setup_output_file(pln_p->evtin_p, pln_p->evtbout_p,
+                                pln_p->inp_p, pln_p->aln_p, &pln_p->b_names,
+                                pln_p->err_p);
+         attach_event_writer(pln_p->writer_p, pln_p->evtbout_p, pln_p->err_p);
+         pln_p->setup_badfile = FALSE;
+      }
+
+      /* update- add current event to bad event file */
+      write_hrc_events(pln_p->evtbout_p, evt_p, pln_p->err_p);
+      dsErrAdd(pln_p->err_p, dsHPEBADEVTFILEERR, Accumulation, Generic,
+               pln_p->evtbout_p->file);
+   }
+   else
+   {
+      /* write data to output event file */
+      write_hrc_events(pln_p->evtout_p, evt_p, pln_p->err_p);
+
+      /* update statistical file counts */
+      pln_p->stat_p->total_events_out++;
+   }
+} /* end: hpe_stage_write */
@@ -0,0 +1,302 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: event_thread_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file event_thread_functions.c contains the following modules used
+  by hrc_process_events() to process a batch of events with several
+  threads (nthreads > 1):
+
+        allocate_event_threads()
+        deallocate_event_threads()
+        run_event_threads()
+
+  The worker threads are started once and wait for work. For each group
+  of stages (HPE_SLICE_*) the batch is split into nthreads contiguous
+  ranges; the calling thread processes the first range and the workers
+  the others, and run_event_threads() returns once every range is done.
+
+* NOTES:
+
+  Only the stages run by process_event_slice() are given to the workers.
+  They change nothing but the event record they are given. The stages
+  which carry state from event to event, use pixlib or add to the error
+  list (coordinates and output) stay in the calling thread and see the
+  events in input order, so the output files are identical for any
+  number of threads.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - only the calling thread times its range (stage timers).
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+static void* event_thread_main(void*);
+static void  event_thread_range(HPE_THREADS_P_T, int, long*, long*);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_event_threads() starts nthreads-1 worker threads
+  (the calling thread is the last one). If not every thread could be
+  started, the threads that were started are used. A NULL pointer is
+  returned, and an error added to the error list, if the memory could
+  not be allocated; the events are then processed by the calling thread.
+
+*************************************************************************/
+
+HPE_THREADS_P_T allocate_event_threads(
+   int        nthreads,       /* I - number of threads                */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   HPE_THREADS_P_T thr_p = NULL;
+   int nworkers = nthreads - 1;
+   int ii;
+
+   if ((thr_p = (HPE_THREADS_P_T) calloc(1, sizeof(HPE_THREADS_T))) != NULL)
+   {
+      thr_p->tid = (pthread_t*) calloc(nworkers, sizeof(pthread_t));
+      thr_p->worker = (HPE_WORKER_P_T) calloc(nworkers, sizeof(HPE_WORKER_T));
+   }
+
+   if ((thr_p == NULL) || (thr_p->tid == NULL) || (thr_p->worker == NULL))
+   {
+      if (thr_p != NULL)
+      {
+         free(thr_p->tid);
+         free(thr_p->worker);
+         free(thr_p);
+         thr_p = NULL;
+      }
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up %d threads.", nthreads);
+   }
+   else
+   {
+      pthread_mutex_init(&thr_p->lock, NULL);
+      pthread_cond_init(&thr_p->start_cv, NULL);
+      pthread_cond_init(&thr_p->done_cv, NULL);
+
+      /* count the calling thread; add each worker once it is running */
+      thr_p->nthreads = 1;
+      for (ii = 0; ii < nworkers; ii++)
+      {
+         thr_p->worker[ii].threads_p = thr_p;
+         thr_p->worker[ii].index = ii + 1;
+         thr_p->worker[ii].generation = 0;
+
+         if (pthread_create(&thr_p->tid[ii], NULL, event_thread_main,
+                            &thr_p->worker[ii]) != 0)
+         {
+            break;
+         }
+         thr_p->nthreads++;
+      }
+   }
+
+   return (thr_p);
+} /* end: allocate_event_threads */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_event_threads() stops the worker threads, frees
+  the memory of the thread pool and sets the pool pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_event_threads(
+   HPE_THREADS_P_T* thr_pp)   /* I/O - worker thread pool pointer     */
+{
+   HPE_THREADS_P_T thr_p = *thr_pp;
+   int ii;
+
+   if (thr_p != NULL)
+   {
+      pthread_mutex_lock(&thr_p->lock);
+      thr_p->shutdown = TRUE;
+      pthread_cond_broadcast(&thr_p->start_cv);
+      pthread_mutex_unlock(&thr_p->lock);
+
+      for (ii = 0; ii < thr_p->nthreads - 1; ii++)
+      {
+         pthread_join(thr_p->tid[ii], NULL);
+      }
+
+      pthread_cond_destroy(&thr_p->done_cv);
+      pthread_cond_destroy(&thr_p->start_cv);
+      pthread_mutex_destroy(&thr_p->lock);
+
+      free(thr_p->worker);
+      free(thr_p->tid);
+      free(thr_p);
+      *thr_pp = NULL;
+   }
+} /* end: deallocate_event_threads */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine run_event_threads() runs a group of stages (HPE_SLICE_*)
+  over every event of a batch, sharing the events out between the worker
+  threads and the calling thread. It returns when all of the events have
+  been processed.
+
+*************************************************************************/
+
+void run_event_threads(
+   HPE_THREADS_P_T  thr_p,    /* I/O - worker thread pool             */
+   HPE_PIPELINE_P_T pln_p,    /* I   - event pipeline                 */
+   EVENT_BATCH_P_T  bat_p,    /* I/O - event batch                    */
+   int              slice)    /* I   - stage group (HPE_SLICE_*)      */
+{
+   long first;
+   long last;
+
+   if (thr_p->nthreads < 2)
+   {
+      process_event_slice(pln_p, bat_p, slice, 0, bat_p->num_events,
+                          pln_p->timers_p);
+   }
+   else
+   {
+      /* post the work to the workers */
+      pthread_mutex_lock(&thr_p->lock);
+      thr_p->pln_p = pln_p;
+      thr_p->bat_p = bat_p;
+      thr_p->slice = slice;
+      thr_p->pending = thr_p->nthreads - 1;
+      thr_p->generation++;
+      pthread_cond_broadcast(&thr_p->start_cv);
+      pthread_mutex_unlock(&thr_p->lock);
+
+      /* the calling thread does (and times) the first range */
+      event_thread_range(thr_p, 0, &first, &last);
+      process_event_slice(pln_p, bat_p, slice, first, last, pln_p->timers_p);
+
+      /* wait for the workers */
+      pthread_mutex_lock(&thr_p->lock);
+      while (thr_p->pending > 0)
+      {
+         pthread_cond_wait(&thr_p->done_cv, &thr_p->lock);
+      }
+      pthread_mutex_unlock(&thr_p->lock);
+   }
+} /* end: run_event_threads */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine event_thread_range() returns the range of batch events
+  [first, last) processed by the specified thread (0 = calling thread).
+
+*************************************************************************/
+
+static void event_thread_range(
+   HPE_THREADS_P_T thr_p,     /* I - worker thread pool               */
+   int             index,     /* I - thread index                     */
+   long*           first_p,   /* O - index of first event             */
+   long*           last_p)    /* O - index after the last event       */
+{
+   long nn = thr_p->bat_p->num_events;
+
+   *first_p = (nn * index) / thr_p->nthreads;
+   *last_p = (nn * (index + 1)) / thr_p->nthreads;
+} /* end: event_thread_range */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine event_thread_main() is run by each worker thread. It waits
+  for work to be posted by run_event_threads(), processes its range of
+  the batch and signals the calling thread when the last range is done.
+
+*************************************************************************/
+
+static void* event_thread_main(
+   void* arg)                 /* I - worker thread arguments          */
+{
+   HPE_WORKER_P_T   wrk_p = (HPE_WORKER_P_T) arg;
+   HPE_THREADS_P_T  thr_p = wrk_p->threads_p;
+   HPE_PIPELINE_P_T pln_p;
+   EVENT_BATCH_P_T  bat_p;
+   int  slice;
+   long first;
+   long last;
+
+   for (;;)
+   {
+      pthread_mutex_lock(&thr_p->lock);
+      while ((thr_p->generation == wrk_p->generation) && !thr_p->shutdown)
+      {
+         pthread_cond_wait(&thr_p->start_cv, &thr_p->lock);
+      }
+      if (thr_p->shutdown)
+      {
+         pthread_mutex_unlock(&thr_p->lock);
+         break;
+      }
+      wrk_p->generation = thr_p->generation;
+      pln_p = thr_p->pln_p;
+      bat_p = thr_p->bat_p;
+      slice = thr_p->slice;
+      event_thread_range(thr_p, wrk_p->index, &first, &last);
+      pthread_mutex_unlock(&thr_p->lock);
+
+      process_event_slice(pln_p, bat_p, slice, first, last, NULL);
+
+      pthread_mutex_lock(&thr_p->lock);
+      if (--thr_p->pending == 0)
+      {
+         pthread_cond_signal(&thr_p->done_cv);
+      }
+      pthread_mutex_unlock(&thr_p->lock);
+   }
+
+   return (NULL);
+} /* end: event_thread_main */
@@ -0,0 +1,648 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: event_writer_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file event_writer_functions.c contains the following modules used
+  by hrc_process_events() to write the output event files with a writer
+  thread (writequeue > 0):
+
+        allocate_event_writer()
+        attach_event_writer()
+        queue_event_rows()
+        drain_event_writer()
+        detach_event_writer()
+        deallocate_event_writer()
+        lock_datamodel()
+        unlock_datamodel()
+
+  Each output file attached to the writer gets writequeue+1 sets of row
+  buffers. When the set being filled by write_hrc_events() is full,
+  flush_hrc_events() calls queue_event_rows(), which hands the set to the
+  writer thread and takes a free set in its place. The processing thread
+  only waits when every set of the file is queued.
+
+* NOTES:
+
+  The sets go to the writer thread through a single producer, single
+  consumer ring and come back through a ring per file. A thread that
+  has to wait (the writer with nothing to write, or the processing
+  thread with no free set) sleeps on a condition variable of the writer
+  which the other thread signals.
+
+  The datamodel is not thread safe, so every datamodel call of the
+  writer (and input prefetch) thread is made holding the datamodel lock
+  (lock_datamodel()). The processing thread holds the lock from the
+  start to the end of the stack of input files and only releases it
+  while it makes no datamodel call: during the stages shared out over a
+  batch (process_event_batch()) and while it waits for the writer. The
+  rows are thus written while the events of the next batch are
+  processed. The processing thread does not touch an output file until
+  drain_event_writer() has returned: before the bad event file is
+  created, at the end of each input file (the subspace of the next file
+  is merged into the output file) and before the header keys are
+  written at the end of the run.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - write the rows holding the datamodel lock; wait on condition
+            variables instead of napping.
+*H***********************************************************************/
+
+#include <time.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+/* lock of the datamodel calls made by more than one thread */
+static pthread_mutex_t hpe_datamodel_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static boolean ring_init(HPE_RING_P_T, unsigned long);
+static boolean ring_push(HPE_RING_P_T, void*);
+static void*   ring_pop(HPE_RING_P_T);
+static double  writer_clock(void);
+static void    signal_event_writer(HPE_EVENT_WRITER_P_T, pthread_cond_t*);
+static void*   event_writer_main(void*);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_event_writer() starts the writer thread with room
+  for 'depth' queued row buffer sets per output file. A NULL pointer is
+  returned if the thread could not be started (the rows are then written
+  by the calling thread); an error is added to the error list if the
+  memory could not be allocated.
+
+*************************************************************************/
+
+HPE_EVENT_WRITER_P_T allocate_event_writer(
+   int        depth,          /* I - # queued sets per file           */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   HPE_EVENT_WRITER_P_T wrt_p;
+
+   if (((wrt_p = (HPE_EVENT_WRITER_P_T) calloc(1,
+                   sizeof(HPE_EVENT_WRITER_T))) == NULL) ||
+       !ring_init(&wrt_p->queue, HPE_MAX_WRITE_FILES * (depth + 1)))
+   {
+      if (wrt_p != NULL)
+      {
+         free(wrt_p);
+         wrt_p = NULL;
+      }
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the writer thread.");
+   }
+   else
+   {
+      wrt_p->depth = depth;
+      pthread_mutex_init(&wrt_p->lock, NULL);
+      pthread_cond_init(&wrt_p->queued, NULL);
+      pthread_cond_init(&wrt_p->written, NULL);
+
+      if (pthread_create(&wrt_p->tid, NULL, event_writer_main, wrt_p) != 0)
+      {
+         pthread_cond_destroy(&wrt_p->written);
+         pthread_cond_destroy(&wrt_p->queued);
+         pthread_mutex_destroy(&wrt_p->lock);
+         free(wrt_p->queue.item);
+         free(wrt_p);
+         wrt_p = NULL;
+      }
+      else
+      {
+         wrt_p->running = TRUE;
+      }
+   }
+
+   return (wrt_p);
+} /* end: allocate_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine attach_event_writer() hands the rows of an output event
+  file to the writer thread. The row buffers of its write plan become
+  the first set; depth more sets are allocated. FALSE is returned if
+  there is no writer thread or write plan, or if the memory could not
+  be allocated (an error is then added to the error list); the rows of
+  the file are then written by the calling thread.
+
+*************************************************************************/
+
+boolean attach_event_writer(
+   HPE_EVENT_WRITER_P_T wrt_p,    /* I/O - writer thread              */
+   EVENT_SETUP_P_T      evtout_p, /* I/O - output event file info     */
+   dsErrList*           err_p)    /* O   - error list pointer         */
+{
+   HPE_WRITE_PLAN_P_T  plan_p;
+   HPE_WRITER_FILE_P_T file_p;
+   boolean alloc_failure = FALSE;
+   int     slot;
+   int     ii;
+
+   if ((wrt_p == NULL) || ((plan_p = evtout_p->plan) == NULL) ||
+       (plan_p->async_p != NULL))
+   {
+      return (FALSE);
+   }
+
+   /* a free slot in the writer file list */
+   slot = 0;
+   while ((slot < HPE_MAX_WRITE_FILES) && (wrt_p->file[slot] != NULL))
+   {
+      slot++;
+   }
+   if (slot == HPE_MAX_WRITE_FILES)
+   {
+      return (FALSE);
+   }
+
+   if (((file_p = (HPE_WRITER_FILE_P_T) calloc(1,
+                     sizeof(HPE_WRITER_FILE_T))) == NULL) ||
+       ((file_p->job = (HPE_WRITE_JOB_P_T) calloc(wrt_p->depth + 1,
+                          sizeof(HPE_WRITE_JOB_T))) == NULL) ||
+       !ring_init(&file_p->idle, wrt_p->depth + 1))
+   {
+      alloc_failure = TRUE;
+   }
+   else
+   {
+      file_p->writer_p = wrt_p;
+      file_p->evtout_p = evtout_p;
+      file_p->slot = slot;
+      file_p->num_jobs = wrt_p->depth + 1;
+
+      for (ii = 0; ii < file_p->num_jobs; ii++)
+      {
+         file_p->job[ii].evtout_p = evtout_p;
+         file_p->job[ii].file_p = file_p;
+         file_p->job[ii].buf = (ii == 0) ? plan_p->buf :
+                                           allocate_write_buffers(plan_p);
+         if (file_p->job[ii].buf == NULL)
+         {
+            alloc_failure = TRUE;
+         }
+      }
+   }
+
+   if (alloc_failure)
+   {
+      if (file_p != NULL)
+      {
+         if (file_p->job != NULL)
+         {
+            for (ii = 1; ii < file_p->num_jobs; ii++)
+            {
+               deallocate_write_buffers(plan_p, &file_p->job[ii].buf);
+            }
+            free(file_p->job);
+         }
+         free(file_p->idle.item);
+         free(file_p);
+      }
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed queueing the rows of %s.",
+         evtout_p->file);
+      return (FALSE);
+   }
+
+   /* the first set is being filled; the others are free */
+   file_p->cur_p = &file_p->job[0];
+   for (ii = 1; ii < file_p->num_jobs; ii++)
+   {
+      ring_push(&file_p->idle, &file_p->job[ii]);
+   }
+
+   wrt_p->file[slot] = file_p;
+   plan_p->async_p = file_p;
+
+   return (TRUE);
+} /* end: attach_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine queue_event_rows() hands the buffered rows of an output
+  event file to the writer thread and sets a free row buffer set in the
+  write plan, waiting for the writer thread if there is none (the
+  datamodel lock is released meanwhile). It is called by
+  flush_hrc_events(), which then advances the plan rows.
+
+*************************************************************************/
+
+void queue_event_rows(
+   EVENT_SETUP_P_T evtout_p)  /* I/O - output event file info         */
+{
+   HPE_WRITE_PLAN_P_T   plan_p = evtout_p->plan;
+   HPE_WRITER_FILE_P_T  file_p = plan_p->async_p;
+   HPE_EVENT_WRITER_P_T wrt_p = file_p->writer_p;
+   HPE_WRITE_JOB_P_T    job_p = file_p->cur_p;
+   double t0;
+   long   depth;
+
+   job_p->first = plan_p->next_row;
+   job_p->num_rows = plan_p->num_rows;
+
+   /* the queue holds every set of both files, so it is never full */
+   wrt_p->num_queued++;
+   ring_push(&wrt_p->queue, job_p);
+   signal_event_writer(wrt_p, &wrt_p->queued);
+
+   depth = wrt_p->num_queued -
+           __atomic_load_n(&wrt_p->num_written, __ATOMIC_ACQUIRE);
+   wrt_p->depth_sum += (double) depth;
+   if (depth > wrt_p->depth_max)
+   {
+      wrt_p->depth_max = depth;
+   }
+
+   /* take a free set- wait for the writer if every set is queued */
+   if ((job_p = (HPE_WRITE_JOB_P_T) ring_pop(&file_p->idle)) == NULL)
+   {
+      t0 = writer_clock();
+      unlock_datamodel();
+      pthread_mutex_lock(&wrt_p->lock);
+      while ((job_p = (HPE_WRITE_JOB_P_T) ring_pop(&file_p->idle)) == NULL)
+      {
+         pthread_cond_wait(&wrt_p->written, &wrt_p->lock);
+      }
+      pthread_mutex_unlock(&wrt_p->lock);
+      lock_datamodel();
+      wrt_p->stall_s += writer_clock() - t0;
+   }
+
+   file_p->cur_p = job_p;
+   plan_p->buf = job_p->buf;
+} /* end: queue_event_rows */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine drain_event_writer() waits until the writer thread has
+  written every queued row buffer set, releasing the datamodel lock
+  meanwhile. It does nothing if there is no writer thread.
+
+*************************************************************************/
+
+void drain_event_writer(
+   HPE_EVENT_WRITER_P_T wrt_p)    /* I/O - writer thread              */
+{
+   double t0;
+
+   if ((wrt_p == NULL) ||
+       (__atomic_load_n(&wrt_p->num_written, __ATOMIC_ACQUIRE) ==
+        wrt_p->num_queued))
+   {
+      return;
+   }
+
+   t0 = writer_clock();
+   unlock_datamodel();
+   pthread_mutex_lock(&wrt_p->lock);
+   while (__atomic_load_n(&wrt_p->num_written, __ATOMIC_ACQUIRE) <
+          wrt_p->num_queued)
+   {
+      pthread_cond_wait(&wrt_p->written, &wrt_p->lock);
+   }
+   pthread_mutex_unlock(&wrt_p->lock);
+   lock_datamodel();
+   wrt_p->stall_s += writer_clock() - t0;
+} /* end: drain_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine detach_event_writer() waits for the queued rows of an
+  output event file to be written and frees its other row buffer sets;
+  the set being filled stays in the write plan, which is written by the
+  calling thread from then on. It does nothing if the rows of the file
+  are not handed to a writer thread.
+
+*************************************************************************/
+
+void detach_event_writer(
+   HPE_WRITE_PLAN_P_T plan_p) /* I/O - write plan                     */
+{
+   HPE_WRITER_FILE_P_T file_p;
+   int ii;
+
+   if ((plan_p == NULL) || ((file_p = plan_p->async_p) == NULL))
+   {
+      return;
+   }
+
+   drain_event_writer(file_p->writer_p);
+
+   for (ii = 0; ii < file_p->num_jobs; ii++)
+   {
+      if (&file_p->job[ii] != file_p->cur_p)
+      {
+         deallocate_write_buffers(plan_p, &file_p->job[ii].buf);
+      }
+   }
+
+   file_p->writer_p->file[file_p->slot] = NULL;
+   free(file_p->idle.item);
+   free(file_p->job);
+   free(file_p);
+   plan_p->async_p = NULL;
+} /* end: detach_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_event_writer() waits for the queued rows to be
+  written, stops the writer thread, detaches the output files and frees
+  the writer, setting its pointer to NULL. The number of blocks, the
+  queue depth and the time spent waiting for the writer are written to
+  the logfile (verbose > 0).
+
+*************************************************************************/
+
+void deallocate_event_writer(
+   HPE_EVENT_WRITER_P_T* wrt_pp,  /* I/O - writer thread pointer      */
+   FILE*                 log_p,   /* I   - debug log                  */
+   int                   debug)   /* I   - debug level                */
+{
+   HPE_EVENT_WRITER_P_T wrt_p = *wrt_pp;
+   int ii;
+
+   if (wrt_p == NULL)
+   {
+      return;
+   }
+
+   drain_event_writer(wrt_p);
+
+   __atomic_store_n(&wrt_p->stop, 1, __ATOMIC_RELEASE);
+   signal_event_writer(wrt_p, &wrt_p->queued);
+   if (wrt_p->running)
+   {
+      pthread_join(wrt_p->tid, NULL);
+   }
+
+   for (ii = 0; ii < HPE_MAX_WRITE_FILES; ii++)
+   {
+      if (wrt_p->file[ii] != NULL)
+      {
+         detach_event_writer(wrt_p->file[ii]->evtout_p->plan);
+      }
+   }
+
+   if ((debug > DEBUG_LEVEL_0) && (log_p != NULL))
+   {
+      fprintf(log_p, "\n ============ WRITER THREAD ===========\n");
+      fprintf(log_p, "BLOCKS  written = %ld   queue depth mean = %.2f"
+              "   max = %ld (writequeue %d)\n", wrt_p->num_written,
+              (wrt_p->num_queued > 0) ?
+                 (wrt_p->depth_sum / (double) wrt_p->num_queued) : 0.0,
+              wrt_p->depth_max, wrt_p->depth);
+      fprintf(log_p, "STALL   waited for writer = %.3f s"
+              "   writer busy = %.3f s\n", wrt_p->stall_s, wrt_p->busy_s);
+   }
+
+   pthread_cond_destroy(&wrt_p->written);
+   pthread_cond_destroy(&wrt_p->queued);
+   pthread_mutex_destroy(&wrt_p->lock);
+   free(wrt_p->queue.item);
+   free(wrt_p);
+   *wrt_pp = NULL;
+} /* end: deallocate_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine lock_datamodel() takes the datamodel lock, waiting for the
+  thread which holds it, and the routine unlock_datamodel() releases it.
+  The lock serializes the datamodel calls of the processing, writer and
+  input prefetch threads.
+
+*************************************************************************/
+
+void lock_datamodel(void)
+{
+   pthread_mutex_lock(&hpe_datamodel_lock);
+} /* end: lock_datamodel */
+
+void unlock_datamodel(void)
+{
+   pthread_mutex_unlock(&hpe_datamodel_lock);
+} /* end: unlock_datamodel */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine ring_init() allocates a ring of at least 'size' entries
+  (rounded up to a power of 2). FALSE is returned if the memory could
+  not be allocated.
+
+*************************************************************************/
+
+static boolean ring_init(
+   HPE_RING_P_T  ring_p,      /* O - ring                             */
+   unsigned long size)        /* I - minimum number of entries        */
+{
+   unsigned long num = 1;
+
+   while (num < size)
+   {
+      num <<= 1;
+   }
+
+   ring_p->head = 0;
+   ring_p->tail = 0;
+   ring_p->mask = num - 1;
+   ring_p->item = (void**) calloc(num, sizeof(void*));
+
+   return (ring_p->item != NULL);
+} /* end: ring_init */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine ring_push() adds an entry at the tail of a ring. It is
+  only called by the producer of the ring. FALSE is returned if the ring
+  is full.
+
+*************************************************************************/
+
+static boolean ring_push(
+   HPE_RING_P_T ring_p,       /* I/O - ring                           */
+   void*        item)         /* I   - entry                          */
+{
+   unsigned long tail = ring_p->tail;
+
+   if (tail - __atomic_load_n(&ring_p->head, __ATOMIC_ACQUIRE) >
+       ring_p->mask)
+   {
+      return (FALSE);
+   }
+
+   ring_p->item[tail & ring_p->mask] = item;
+   __atomic_store_n(&ring_p->tail, tail + 1, __ATOMIC_RELEASE);
+
+   return (TRUE);
+} /* end: ring_push */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine ring_pop() removes the entry at the head of a ring. It is
+  only called by the consumer of the ring. NULL is returned if the ring
+  is empty.
+
+*************************************************************************/
+
+static void* ring_pop(
+   HPE_RING_P_T ring_p)       /* I/O - ring                           */
+{
+   unsigned long head = ring_p->head;
+   void* item;
+
+   if (head == __atomic_load_n(&ring_p->tail, __ATOMIC_ACQUIRE))
+   {
+      return (NULL);
+   }
+
+   item = ring_p->item[head & ring_p->mask];
+   __atomic_store_n(&ring_p->head, head + 1, __ATOMIC_RELEASE);
+
+   return (item);
+} /* end: ring_pop */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine writer_clock() returns the wall clock in seconds and the
+  routine signal_event_writer() wakes the thread waiting on the
+  specified condition variable of the writer (the writer thread on
+  'queued', the processing thread on 'written').
+
+*************************************************************************/
+
+static double writer_clock(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((double) ts.tv_sec + (1.0e-9 * (double) ts.tv_nsec));
+} /* end: writer_clock */
+
+static void signal_event_writer(
+   HPE_EVENT_WRITER_P_T wrt_p,    /* I/O - writer thread              */
+   pthread_cond_t*      cond_p)   /* I/O - condition to signal        */
+{
+   /* the waiting thread checks its ring holding the lock, so it either */
+   /* sees the change or is already waiting                            */
+   pthread_mutex_lock(&wrt_p->lock);
+   pthread_cond_signal(cond_p);
+   pthread_mutex_unlock(&wrt_p->lock);
+} /* end: signal_event_writer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine event_writer_main() is run by the writer thread. It writes
+  each queued row buffer set, holding the datamodel lock, and returns it
+  to the free sets of its file, until the queue is empty and the thread
+  is asked to stop.
+
+*************************************************************************/
+
+static void* event_writer_main(
+   void* arg)                 /* I - writer thread                    */
+{
+   HPE_EVENT_WRITER_P_T wrt_p = (HPE_EVENT_WRITER_P_T) arg;
+   HPE_WRITE_JOB_P_T    job_p;
+   double t0;
+
+   for (;;)
+   {
+      pthread_mutex_lock(&wrt_p->lock);
+      while (((job_p = (HPE_WRITE_JOB_P_T) ring_pop(&wrt_p->queue))
+              == NULL) && !__atomic_load_n(&wrt_p->stop, __ATOMIC_ACQUIRE))
+      {
+         pthread_cond_wait(&wrt_p->queued, &wrt_p->lock);
+      }
+      pthread_mutex_unlock(&wrt_p->lock);
+
+      if (job_p == NULL)
+      {
+         break;
+      }
+
+      lock_datamodel();
+      t0 = writer_clock();
+      write_event_rows(job_p->evtout_p, job_p->buf, job_p->first,
+                       job_p->num_rows);
+      wrt_p->busy_s += writer_clock() - t0;
+      unlock_datamodel();
+
+      /* free the set before it is counted, so a drained file can be */
+      /* detached                                                     */
+      ring_push(&job_p->file_p->idle, job_p);
+      __atomic_add_fetch(&wrt_p->num_written, 1, __ATOMIC_RELEASE);
+      signal_event_writer(wrt_p, &wrt_p->written);
+   }
+
+   return (NULL);
+} /* end: event_writer_main */
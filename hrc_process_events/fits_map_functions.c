@@ -0,0 +1,736 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: fits_map_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file fits_map_functions.c contains the following modules used by
+  hrc_process_events() to read the columns of a plain FITS input event
+  file straight from a memory map of the file (fastread = yes):
+
+        open_fits_map()
+        read_fits_map_column()
+        close_fits_map()
+
+  open_fits_map() maps the file, walks its headers to the binary table
+  the datamodel opened and finds, for each input column component, the
+  byte offset of its values in a row. load_event_block() then asks
+  read_fits_map_column() for each buffered column; the big-endian values
+  are decoded straight into the block buffer, without going through the
+  datamodel.
+
+* NOTES:
+
+  Only the simple cases are decoded: an uncompressed file named without
+  a datamodel filter, a column of one B, I, J, E or D value with no
+  TSCAL/TZERO scaling, and a buffer type that holds every value of the
+  column exactly (so the event record is the same as with dmGetScalars).
+  Everything else (files, or single columns) is read by the datamodel
+  as before.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#define FITS_BLOCK_LEN   2880   /* length of a FITS header/data block   */
+#define FITS_CARD_LEN      80   /* length of a FITS header card          */
+
+static long    fits_header_end(unsigned char*, long, long);
+static boolean fits_card_find(unsigned char*, long, char*, char**);
+static boolean fits_key_long(unsigned char*, long, char*, long*);
+static boolean fits_key_double(unsigned char*, long, char*, double*);
+static boolean fits_key_str(unsigned char*, long, char*, char*, int);
+static long    fits_form_width(char*, long*, char*);
+static boolean fits_setup_columns(HPE_FITS_MAP_P_T, EVENT_SETUP_P_T,
+                                  unsigned char*, long);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine open_fits_map() maps the input event file and sets up the
+  row offsets of the input columns it can decode. NULL is returned if
+  the file is not a plain FITS file, the event table could not be found
+  or none of the columns can be decoded; the file is then read by the
+  datamodel alone. No error is added, so the routine may be called by
+  the prefetch thread.
+
+*************************************************************************/
+
+HPE_FITS_MAP_P_T open_fits_map(
+   EVENT_SETUP_P_T evtin_p)   /* I - input event file information     */
+{
+   HPE_FITS_MAP_P_T map_p = NULL;
+   struct stat st;
+   unsigned char* base = MAP_FAILED;
+   long   pos = 0;
+   long   data = 0;
+   long   hdu;
+   long   blockno;
+   long   bitpix = 0;
+   long   naxis = 0;
+   long   pcount = 0;
+   long   gcount = 1;
+   long   nn;
+   long   len;
+   char   key[FITS_CARD_LEN];
+   int    fd;
+
+   /* datamodel filters and compressed files are left to the datamodel */
+   if ((evtin_p->file == NULL) || (strpbrk(evtin_p->file, "[]") != NULL) ||
+       (evtin_p->extension == NULL) ||
+       ((blockno = dmBlockGetNo(evtin_p->extension)) < 2))
+   {
+      return (NULL);
+   }
+
+   if ((fd = open(evtin_p->file, O_RDONLY)) < 0)
+   {
+      return (NULL);
+   }
+   if ((fstat(fd, &st) == 0) && (st.st_size >= FITS_BLOCK_LEN))
+   {
+      base = (unsigned char*) mmap(NULL, (size_t) st.st_size, PROT_READ,
+                                   MAP_PRIVATE, fd, 0);
+   }
+   close(fd);
+
+   if ((base == MAP_FAILED) || (strncmp((char*) base, "SIMPLE  =", 9) != 0))
+   {
+      if (base != MAP_FAILED)
+      {
+         munmap(base, (size_t) st.st_size);
+      }
+      return (NULL);
+   }
+
+   /* walk the headers to the table opened by the datamodel */
+   for (hdu = 1; hdu <= blockno; hdu++)
+   {
+      if ((data = fits_header_end(base, (long) st.st_size, pos)) < 0)
+      {
+         break;
+      }
+      len = data - pos;
+      if (hdu == blockno)
+      {
+         break;
+      }
+
+      bitpix = naxis = pcount = 0;
+      gcount = 1;
+      fits_key_long(base + pos, len, "BITPIX", &bitpix);
+      fits_key_long(base + pos, len, "NAXIS", &naxis);
+      fits_key_long(base + pos, len, "PCOUNT", &pcount);
+      fits_key_long(base + pos, len, "GCOUNT", &gcount);
+
+      nn = (naxis > 0) ? 1 : 0;
+      while (naxis > 0)
+      {
+         long naxisn = 0;
+
+         sprintf(key, "NAXIS%ld", naxis--);
+         fits_key_long(base + pos, len, key, &naxisn);
+         nn *= naxisn;
+      }
+      nn = ((bitpix < 0) ? -bitpix : bitpix) / 8 * gcount * (pcount + nn);
+      pos = data + (((nn + FITS_BLOCK_LEN - 1) / FITS_BLOCK_LEN) *
+                    FITS_BLOCK_LEN);
+   }
+
+   if ((data > 0) && (hdu == blockno) &&
+       ((map_p = (HPE_FITS_MAP_P_T) calloc(1, sizeof(HPE_FITS_MAP_T)))
+        != NULL))
+   {
+      map_p->base = base;
+      map_p->size = (long) st.st_size;
+      map_p->data = base + data;
+
+      if (!fits_setup_columns(map_p, evtin_p, base + pos, data - pos))
+      {
+         close_fits_map(&map_p);
+      }
+   }
+   else
+   {
+      munmap(base, (size_t) st.st_size);
+   }
+
+   return (map_p);
+} /* end: open_fits_map */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine read_fits_map_column() decodes rows first_row..first_row+
+  nrows-1 of input column component 'col' into the block buffer 'buf'
+  of type 'kind' (HDET_BLK_*). FALSE is returned, and nothing decoded,
+  if there is no map or the column is left to the datamodel.
+
+*************************************************************************/
+
+boolean read_fits_map_column(
+   HPE_FITS_MAP_P_T map_p,    /* I - input file memory map            */
+   int              col,      /* I - input column component           */
+   short            kind,     /* I - buffer type (HDET_BLK_*)         */
+   void*            buf,      /* O - column buffer                    */
+   long             first_row,/* I - first table row                  */
+   long             nrows)    /* I - number of rows                   */
+{
+   unsigned char* src;
+   long   stride;
+   long   rr;
+   union { unsigned int u; float f; } r4;
+   union { unsigned long long u; double d; } r8;
+
+   if ((map_p == NULL) || (col >= map_p->num_cols) ||
+       (map_p->offset[col] < 0) || (first_row < 1) ||
+       (first_row + nrows - 1 > map_p->num_rows))
+   {
+      return (FALSE);
+   }
+
+   stride = map_p->row_len;
+   src = map_p->data + ((first_row - 1) * stride) + map_p->offset[col];
+
+   /* the buffer types a column may be decoded to are set up by
+    * fits_setup_columns(); each loop assembles the big-endian bytes */
+   switch ((kind << 8) | map_p->code[col])
+   {
+      case (HDET_BLK_SHORT << 8) | 'B':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((short*) buf)[rr] = (short) src[0];
+      break;
+
+      case (HDET_BLK_SHORT << 8) | 'I':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((short*) buf)[rr] = (short) ((src[0] << 8) | src[1]);
+      break;
+
+      case (HDET_BLK_LONG << 8) | 'B':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((long*) buf)[rr] = (long) src[0];
+      break;
+
+      case (HDET_BLK_LONG << 8) | 'I':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((long*) buf)[rr] = (long) (short) ((src[0] << 8) | src[1]);
+      break;
+
+      case (HDET_BLK_LONG << 8) | 'J':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((long*) buf)[rr] = (long) (int) (((unsigned int) src[0] << 24) |
+               ((unsigned int) src[1] << 16) | ((unsigned int) src[2] << 8) |
+               (unsigned int) src[3]);
+      break;
+
+      case (HDET_BLK_DOUBLE << 8) | 'B':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((double*) buf)[rr] = (double) src[0];
+      break;
+
+      case (HDET_BLK_DOUBLE << 8) | 'I':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((double*) buf)[rr] = (double) (short) ((src[0] << 8) | src[1]);
+      break;
+
+      case (HDET_BLK_DOUBLE << 8) | 'J':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+            ((double*) buf)[rr] = (double) (int) (((unsigned int) src[0] << 24)
+               | ((unsigned int) src[1] << 16) | ((unsigned int) src[2] << 8) |
+               (unsigned int) src[3]);
+      break;
+
+      case (HDET_BLK_DOUBLE << 8) | 'E':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+         {
+            r4.u = ((unsigned int) src[0] << 24) |
+                   ((unsigned int) src[1] << 16) |
+                   ((unsigned int) src[2] << 8) | (unsigned int) src[3];
+            ((double*) buf)[rr] = (double) r4.f;
+         }
+      break;
+
+      case (HDET_BLK_DOUBLE << 8) | 'D':
+         for (rr = 0; rr < nrows; rr++, src += stride)
+         {
+            r8.u = ((unsigned long long) src[0] << 56) |
+                   ((unsigned long long) src[1] << 48) |
+                   ((unsigned long long) src[2] << 40) |
+                   ((unsigned long long) src[3] << 32) |
+                   ((unsigned long long) src[4] << 24) |
+                   ((unsigned long long) src[5] << 16) |
+                   ((unsigned long long) src[6] << 8) |
+                   (unsigned long long) src[7];
+            ((double*) buf)[rr] = r8.d;
+         }
+      break;
+
+      default:
+         return (FALSE);
+   }
+
+   return (TRUE);
+} /* end: read_fits_map_column */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine close_fits_map() unmaps the input file, frees the map and
+  sets its pointer to NULL.
+
+*************************************************************************/
+
+void close_fits_map(
+   HPE_FITS_MAP_P_T* map_pp)  /* I/O - input file memory map pointer  */
+{
+   HPE_FITS_MAP_P_T map_p = *map_pp;
+
+   if (map_p == NULL)
+   {
+      return;
+   }
+
+   if (map_p->base != NULL)
+   {
+      munmap(map_p->base, (size_t) map_p->size);
+   }
+   if (map_p->offset != NULL)
+   {
+      free(map_p->offset);
+   }
+   if (map_p->code != NULL)
+   {
+      free(map_p->code);
+   }
+   free(map_p);
+   *map_pp = NULL;
+} /* end: close_fits_map */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fits_setup_columns() checks that the header 'hdr' is that
+  of the event table opened by the datamodel and sets the row offset and
+  type code of each input column component it holds as a plain scalar
+  column (offset -1 for the others). FALSE is returned if the table does
+  not match or no column can be decoded.
+
+*************************************************************************/
+
+static boolean fits_setup_columns(
+   HPE_FITS_MAP_P_T map_p,    /* I/O - input file memory map          */
+   EVENT_SETUP_P_T  evtin_p,  /* I   - input event file information   */
+   unsigned char*   hdr,      /* I   - header of the event table      */
+   long             len)      /* I   - header length                  */
+{
+   char   str[FITS_CARD_LEN];
+   char   key[FITS_CARD_LEN];
+   char   name[DS_SZ_PATHNAME];
+   char** ttype = NULL;
+   long*  start = NULL;
+   char*  code = NULL;
+   long   tfields = 0;
+   long   naxis = 0;
+   long   width;
+   long   repeat;
+   long   nn;
+   double dval;
+   int    cc;
+   int    num_found = 0;
+   boolean ok = TRUE;
+
+   if (!fits_key_str(hdr, len, "XTENSION", str, FITS_CARD_LEN) ||
+       (strcmp(str, "BINTABLE") != 0) ||
+       !fits_key_long(hdr, len, "NAXIS", &naxis) || (naxis != 2) ||
+       !fits_key_long(hdr, len, "NAXIS1", &map_p->row_len) ||
+       !fits_key_long(hdr, len, "NAXIS2", &map_p->num_rows) ||
+       !fits_key_long(hdr, len, "TFIELDS", &tfields) || (tfields < 1) ||
+       (map_p->num_rows != dmTableGetNoRows(evtin_p->extension)) ||
+       ((map_p->data - map_p->base) + (map_p->row_len * map_p->num_rows) >
+        map_p->size))
+   {
+      return (FALSE);
+   }
+
+   map_p->num_cols = evtin_p->num_cols;
+   map_p->offset = (long*) calloc(evtin_p->num_cols, sizeof(long));
+   map_p->code = (char*) calloc(evtin_p->num_cols, sizeof(char));
+   ttype = (char**) calloc(tfields, sizeof(char*));
+   start = (long*) calloc(tfields, sizeof(long));
+   code = (char*) calloc(tfields, sizeof(char));
+   if ((map_p->offset == NULL) || (map_p->code == NULL) || (ttype == NULL) ||
+       (start == NULL) || (code == NULL))
+   {
+      ok = FALSE;
+   }
+
+   /* row offset of each field; only scalars w/o scaling are decoded */
+   for (nn = 0, width = 0; ok && (nn < tfields); nn++)
+   {
+      start[nn] = width;
+      sprintf(key, "TFORM%ld", nn + 1);
+      if (!fits_key_str(hdr, len, key, str, FITS_CARD_LEN) ||
+          ((width = fits_form_width(str, &repeat, &code[nn])) < 0))
+      {
+         ok = FALSE;
+         break;
+      }
+      width += start[nn];
+
+      sprintf(key, "TSCAL%ld", nn + 1);
+      if (fits_key_double(hdr, len, key, &dval) && (dval != 1.0))
+      {
+         code[nn] = '\0';
+      }
+      sprintf(key, "TZERO%ld", nn + 1);
+      if (fits_key_double(hdr, len, key, &dval) && (dval != 0.0))
+      {
+         code[nn] = '\0';
+      }
+      if (repeat != 1)
+      {
+         code[nn] = '\0';
+      }
+
+      sprintf(key, "TTYPE%ld", nn + 1);
+      if ((ttype[nn] = (char*) calloc(FITS_CARD_LEN, sizeof(char))) == NULL)
+      {
+         ok = FALSE;
+      }
+      else if (!fits_key_str(hdr, len, key, ttype[nn], FITS_CARD_LEN))
+      {
+         code[nn] = '\0';
+      }
+   }
+   if (ok && (width != map_p->row_len))
+   {
+      ok = FALSE;
+   }
+
+   /* match each input column component to a field by name and type */
+   for (cc = 0; ok && (cc < evtin_p->num_cols); cc++)
+   {
+      map_p->offset[cc] = -1;
+      name[0] = '\0';
+      dmGetName(evtin_p->desc[cc], name, DS_SZ_PATHNAME);
+
+      for (nn = 0; nn < tfields; nn++)
+      {
+         if ((code[nn] != '\0') && (ds_strcmp_cis(ttype[nn], name) == 0))
+         {
+            break;
+         }
+      }
+      if ((nn < tfields) &&
+          (((code[nn] == 'B') && (evtin_p->types[cc] == dmBYTE)) ||
+           ((code[nn] == 'I') && (evtin_p->types[cc] == dmSHORT)) ||
+           ((code[nn] == 'J') && (evtin_p->types[cc] == dmLONG)) ||
+           ((code[nn] == 'E') && (evtin_p->types[cc] == dmFLOAT)) ||
+           ((code[nn] == 'D') && (evtin_p->types[cc] == dmDOUBLE))))
+      {
+         map_p->offset[cc] = start[nn];
+         map_p->code[cc] = code[nn];
+         num_found++;
+      }
+   }
+
+   for (nn = 0; (ttype != NULL) && (nn < tfields); nn++)
+   {
+      if (ttype[nn] != NULL)
+      {
+         free(ttype[nn]);
+      }
+   }
+   if (ttype != NULL)
+   {
+      free(ttype);
+   }
+   if (start != NULL)
+   {
+      free(start);
+   }
+   if (code != NULL)
+   {
+      free(code);
+   }
+
+   return (ok && (num_found > 0));
+} /* end: fits_setup_columns */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fits_header_end() returns the offset of the data following
+  the header which starts at offset 'pos', or -1 if the END card is not
+  found in the file.
+
+*************************************************************************/
+
+static long fits_header_end(
+   unsigned char* base,       /* I - start of the mapped file         */
+   long           size,       /* I - length of the file               */
+   long           pos)        /* I - offset of the header             */
+{
+   long card;
+
+   for (card = pos; card + FITS_CARD_LEN <= size; card += FITS_CARD_LEN)
+   {
+      if (strncmp((char*) base + card, "END     ", 8) == 0)
+      {
+         card += FITS_CARD_LEN;
+         card = ((card + FITS_BLOCK_LEN - 1) / FITS_BLOCK_LEN) *
+                FITS_BLOCK_LEN;
+         return ((card <= size) ? card : -1);
+      }
+   }
+
+   return (-1);
+} /* end: fits_header_end */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fits_card_find() finds the value card of keyword 'key' in
+  the header and returns a pointer to the start of its value.
+
+*************************************************************************/
+
+static boolean fits_card_find(
+   unsigned char* hdr,        /* I - header                           */
+   long           len,        /* I - header length                    */
+   char*          key,        /* I - keyword                          */
+   char**         val_pp)     /* O - start of the value               */
+{
+   char   name[9];
+   long   card;
+   size_t klen = strlen(key);
+
+   if (klen > 8)
+   {
+      return (FALSE);
+   }
+   memset(name, ' ', 8);
+   memcpy(name, key, klen);
+
+   for (card = 0; card + FITS_CARD_LEN <= len; card += FITS_CARD_LEN)
+   {
+      if ((memcmp(hdr + card, name, 8) == 0) && (hdr[card + 8] == '=') &&
+          (hdr[card + 9] == ' '))
+      {
+         *val_pp = (char*) hdr + card + 10;
+         return (TRUE);
+      }
+   }
+
+   return (FALSE);
+} /* end: fits_card_find */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routines fits_key_long(), fits_key_double() and fits_key_str()
+  read an integer, real or string keyword value. FALSE is returned if
+  the keyword is missing or its value can not be read.
+
+*************************************************************************/
+
+static boolean fits_key_long(
+   unsigned char* hdr,        /* I - header                           */
+   long           len,        /* I - header length                    */
+   char*          key,        /* I - keyword                          */
+   long*          val_p)      /* O - value                            */
+{
+   char  card[FITS_CARD_LEN];
+   char* val;
+   char* end;
+
+   if (!fits_card_find(hdr, len, key, &val))
+   {
+      return (FALSE);
+   }
+   memcpy(card, val, FITS_CARD_LEN - 10);
+   card[FITS_CARD_LEN - 10] = '\0';
+   *val_p = strtol(card, &end, 10);
+
+   return (end != card);
+} /* end: fits_key_long */
+
+
+static boolean fits_key_double(
+   unsigned char* hdr,        /* I - header                           */
+   long           len,        /* I - header length                    */
+   char*          key,        /* I - keyword                          */
+   double*        val_p)      /* O - value                            */
+{
+   char  card[FITS_CARD_LEN];
+   char* val;
+   char* end;
+   char* dd;
+
+   if (!fits_card_find(hdr, len, key, &val))
+   {
+      return (FALSE);
+   }
+   memcpy(card, val, FITS_CARD_LEN - 10);
+   card[FITS_CARD_LEN - 10] = '\0';
+   for (dd = card; *dd != '\0'; dd++)
+   {
+      if ((*dd == 'D') || (*dd == 'd'))
+      {
+         *dd = 'E';           /* FITS double precision exponent */
+      }
+   }
+   *val_p = strtod(card, &end);
+
+   return (end != card);
+} /* end: fits_key_double */
+
+
+static boolean fits_key_str(
+   unsigned char* hdr,        /* I - header                           */
+   long           len,        /* I - header length                    */
+   char*          key,        /* I - keyword                          */
+   char*          str,        /* O - value, trailing blanks removed   */
+   int            size)       /* I - size of str                      */
+{
+   char* val;
+   int   ii;
+   int   nn = 0;
+
+   if (!fits_card_find(hdr, len, key, &val))
+   {
+      return (FALSE);
+   }
+   for (ii = 0; (ii < FITS_CARD_LEN - 10) && (val[ii] == ' '); ii++)
+   {
+      ;
+   }
+   if ((ii == FITS_CARD_LEN - 10) || (val[ii] != '\''))
+   {
+      return (FALSE);
+   }
+
+   for (ii++; (ii < FITS_CARD_LEN - 10) && (nn < size - 1); ii++)
+   {
+      if (val[ii] == '\'')
+      {
+         if ((ii + 1 < FITS_CARD_LEN - 10) && (val[ii + 1] == '\''))
+         {
+            ii++;             /* quote within the string */
+         }
+         else
+         {
+            break;
+         }
+      }
+      str[nn++] = val[ii];
+   }
+   while ((nn > 0) && (str[nn - 1] == ' '))
+   {
+      nn--;
+   }
+   str[nn] = '\0';
+
+   return (TRUE);
+} /* end: fits_key_str */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fits_form_width() returns the width in bytes of a field
+  with the binary table format 'form' (-1 if not recognized), its repeat
+  count and its type code.
+
+*************************************************************************/
+
+static long fits_form_width(
+   char*  form,               /* I - TFORMn value                     */
+   long*  repeat_p,           /* O - repeat count                     */
+   char*  code_p)             /* O - type code                        */
+{
+   long repeat = 1;
+   long width;
+   char* cp = form;
+
+   if (isdigit((int) *cp))
+   {
+      repeat = strtol(form, &cp, 10);
+   }
+   *repeat_p = repeat;
+   *code_p = *cp;
+
+   switch (*cp)
+   {
+      case 'L': case 'B': case 'A':
+         width = repeat;
+      break;
+      case 'X':
+         width = (repeat + 7) / 8;
+      break;
+      case 'I':
+         width = 2 * repeat;
+      break;
+      case 'J': case 'E':
+         width = 4 * repeat;
+      break;
+      case 'K': case 'D': case 'C': case 'P':
+         width = 8 * repeat;
+      break;
+      case 'M': case 'Q':
+         width = 16 * repeat;
+      break;
+      default:
+         width = -1;
+      break;
+   }
+
+   return (width);
+} /* end: fits_form_width */
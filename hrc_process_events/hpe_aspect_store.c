@@ -0,0 +1,411 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_aspect_store.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_aspect_store.c contains the following modules used by
+  hrc_process_events() to hold the aspect solution in memory
+  (aspstore = yes):
+
+        load_aspect_store()
+        find_aspect_record()
+        deallocate_aspect_store()
+
+  load_aspect_store() reads every file of the aspect stack, before the
+  events are processed, into one array of records in time order.
+  find_aspect_record() then gives the record of an event time by a
+  galloping search from the record of the previous query, so the
+  aspect takes no file I/O in the event loop and may be queried at any
+  time, in or out of order.
+
+* NOTES:
+
+  A file with ra, dec and roll columns is an aspect solution (asp_sol =
+  ra, dec, roll); otherwise its dy, dz and dtheta columns make it an
+  offsets file (asp_sol = dy, dz, dtheta, ASP_FTYPE_OFFSETS). All files
+  of the stack must be of one kind.
+
+  The record of an event time is the one aspect_update() leaves in
+  entry[next] when it reads the stack from its start: the first record
+  at or after the time (the first of records with equal times), or the
+  last record after the end of the stack. The record is used as read;
+  aspect_update() does not interpolate between records and neither
+  does the store. A record is thus used for the times after the record
+  before it up to its own time.
+
+  aspect_update() only reads ahead, so for an event time before the
+  current record (out of sequence, or at the start of the next file)
+  it keeps that record; hpe_resolve_aspect() keeps it likewise and only
+  queries the store once a time is past the current record. The two
+  give the same record for every event as long as the aspect stack is
+  in time order; a stack out of order is sorted by the store.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - give the record aspect_update() gives (the first at or
+            after the time) instead of the nearest record.
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+/* columns of the aspect solution and of an offsets file */
+static char* sol_cols[HPE_ASP_STORE_COLS] = { "ra", "dec", "roll" };
+static char* off_cols[HPE_ASP_STORE_COLS] = { "dy", "dz", "dtheta" };
+
+static boolean read_aspect_file(HPE_ASPECT_STORE_P_T, char*, dsErrList*);
+static int     compare_aspect_records(const void*, const void*);
+static long    last_record_before(HPE_ASPECT_STORE_P_T, double);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine load_aspect_store() reads the records of every file of the
+  aspect stack into a new aspect store and sets the aspect file type in
+  the aspect housekeeping. NULL is returned, with a warning added to the
+  error list, if the stack is empty or a file could not be read; the
+  aspect is then read by aspect_update() as before.
+
+*************************************************************************/
+
+HPE_ASPECT_STORE_P_T load_aspect_store(
+   ASPECT_INFRA_P_T asp_hk_p, /* I/O - aspect file housekeeping       */
+   dsErrList*       err_p)    /* O   - error list pointer             */
+{
+   HPE_ASPECT_STORE_P_T st_p;
+   char*   file;
+   boolean ok = TRUE;
+   boolean sorted = TRUE;
+   int     ff;
+   long    rr;
+
+   if (asp_hk_p->stk_cnt < 1)
+   {
+      return (NULL);
+   }
+
+   if ((st_p = (HPE_ASPECT_STORE_P_T) calloc(1, sizeof(HPE_ASPECT_STORE_T)))
+       == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed loading the aspect solution.");
+      return (NULL);
+   }
+   st_p->offsets = -1;
+
+   for (ff = 1; ok && (ff <= asp_hk_p->stk_cnt); ff++)
+   {
+      if ((file = stk_read_num(asp_hk_p->stack, ff)) == NULL)
+      {
+         ok = FALSE;
+      }
+      else
+      {
+         ok = read_aspect_file(st_p, file, err_p);
+         free(file);
+         st_p->num_files++;
+      }
+   }
+
+   if (!ok || (st_p->num_recs < 1))
+   {
+      dsErrAdd(err_p, dsGENERICERR, Individual, Custom,
+         "WARNING: The aspect files could not be loaded; they are read in sequence instead.");
+      deallocate_aspect_store(&st_p);
+      return (NULL);
+   }
+
+   /* the stack is normally in time order already */
+   for (rr = 1; sorted && (rr < st_p->num_recs); rr++)
+   {
+      sorted = (st_p->recs[rr].time >= st_p->recs[rr - 1].time);
+   }
+   if (!sorted)
+   {
+      qsort(st_p->recs, st_p->num_recs, sizeof(ASPECT_REC_T),
+            compare_aspect_records);
+   }
+
+   /* solutions are told apart from offsets files by the type only */
+   asp_hk_p->asp_file_type = (st_p->offsets) ? ASP_FTYPE_OFFSETS :
+                             HPE_ASP_FTYPE_SOLUTION;
+
+   return (st_p);
+} /* end: load_aspect_store */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine find_aspect_record() copies the record of the specified
+  time (the first record at or after it, or the last record) into
+  *rec_p and sets *stop_p to the last time for which that record is
+  given (its own time; DBL_MAX for the last record).
+
+*************************************************************************/
+
+void find_aspect_record(
+   HPE_ASPECT_STORE_P_T st_p, /* I/O - aspect store (cursor)          */
+   double          time,      /* I   - event time                     */
+   ASPECT_REC_P_T  rec_p,     /* O   - aspect record                  */
+   double*         stop_p)    /* O   - last time of the record        */
+{
+   long kk = last_record_before(st_p, time) + 1;
+
+   if (kk >= st_p->num_recs)
+   {
+      kk = st_p->num_recs - 1;
+   }
+   st_p->cursor = kk;
+
+   *rec_p = st_p->recs[kk];
+   *stop_p = (kk + 1 < st_p->num_recs) ? st_p->recs[kk].time : DBL_MAX;
+} /* end: find_aspect_record */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_aspect_store() frees the aspect store, setting
+  its pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_aspect_store(
+   HPE_ASPECT_STORE_P_T* st_pp)  /* I/O - aspect store pointer        */
+{
+   if (*st_pp == NULL)
+   {
+      return;
+   }
+
+   if ((*st_pp)->recs != NULL)
+   {
+      free((*st_pp)->recs);
+   }
+   free(*st_pp);
+   *st_pp = NULL;
+} /* end: deallocate_aspect_store */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine read_aspect_file() appends the records of an aspect file
+  to the store. FALSE is returned, with a warning added to the error
+  list, if the file could not be read or is not of the kind of the
+  files before it.
+
+*************************************************************************/
+
+static boolean read_aspect_file(
+   HPE_ASPECT_STORE_P_T st_p, /* I/O - aspect store                   */
+   char*           file,      /* I   - aspect file name               */
+   dsErrList*      err_p)     /* O   - error list pointer             */
+{
+   dmBlock*      blk_p;
+   dmDescriptor* time_d;
+   dmDescriptor* sol_d[HPE_ASP_STORE_COLS];
+   ASPECT_REC_P_T recs;
+   double* buf = NULL;
+   char**  cols = sol_cols;
+   boolean offsets = FALSE;
+   long    num_rows;
+   long    rr;
+   int     cc;
+
+   if ((blk_p = dmTableOpen(file)) == NULL)
+   {
+      dsErrAdd(err_p, dsOPENFILEWERR, Individual, Generic, file);
+      return (FALSE);
+   }
+
+   /* solution (ra, dec, roll) or offsets (dy, dz, dtheta) */
+   if ((dmTableOpenColumn(blk_p, sol_cols[0]) == NULL) &&
+       (dmTableOpenColumn(blk_p, off_cols[0]) != NULL))
+   {
+      cols = off_cols;
+      offsets = TRUE;
+   }
+
+   time_d = dmTableOpenColumn(blk_p, "time");
+   for (cc = 0; cc < HPE_ASP_STORE_COLS; cc++)
+   {
+      sol_d[cc] = dmTableOpenColumn(blk_p, cols[cc]);
+   }
+   num_rows = dmTableGetNoRows(blk_p);
+
+   if ((time_d == NULL) || (sol_d[0] == NULL) || (sol_d[1] == NULL) ||
+       (sol_d[2] == NULL) ||
+       ((st_p->offsets >= 0) && (st_p->offsets != (short) offsets)))
+   {
+      dsErrAdd(err_p, dsGENERICERR, Individual, Custom,
+         "WARNING: %s is not an aspect solution or offsets file of the kind of the rest of the stack.",
+         file);
+      dmTableClose(blk_p);
+      return (FALSE);
+   }
+   st_p->offsets = (short) offsets;
+
+   if (num_rows < 1)
+   {
+      dmTableClose(blk_p);
+      return (TRUE);
+   }
+
+   if (((recs = (ASPECT_REC_P_T) realloc(st_p->recs,
+                   (st_p->num_recs + num_rows) * sizeof(ASPECT_REC_T)))
+        == NULL) ||
+       ((buf = (double*) malloc(num_rows * sizeof(double))) == NULL))
+   {
+      if (recs != NULL)
+      {
+         st_p->recs = recs;
+      }
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed loading the aspect solution.");
+      dmTableClose(blk_p);
+      return (FALSE);
+   }
+   st_p->recs = recs;
+   recs = &st_p->recs[st_p->num_recs];
+   memset(recs, 0, num_rows * sizeof(ASPECT_REC_T));
+
+   dmGetScalars_d(time_d, buf, 1, num_rows);
+   for (rr = 0; rr < num_rows; rr++)
+   {
+      recs[rr].time = buf[rr];
+   }
+   for (cc = 0; cc < HPE_ASP_STORE_COLS; cc++)
+   {
+      dmGetScalars_d(sol_d[cc], buf, 1, num_rows);
+      for (rr = 0; rr < num_rows; rr++)
+      {
+         recs[rr].asp_sol[cc] = buf[rr];
+      }
+   }
+   st_p->num_recs += num_rows;
+
+   free(buf);
+   dmTableClose(blk_p);
+
+   return (TRUE);
+} /* end: read_aspect_file */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine compare_aspect_records() orders aspect records by time
+  (qsort()).
+
+*************************************************************************/
+
+static int compare_aspect_records(
+   const void* a_p,           /* I - first record                     */
+   const void* b_p)           /* I - second record                    */
+{
+   double ta = ((const ASPECT_REC_T*) a_p)->time;
+   double tb = ((const ASPECT_REC_T*) b_p)->time;
+
+   return ((ta < tb) ? -1 : ((ta > tb) ? 1 : 0));
+} /* end: compare_aspect_records */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine last_record_before() returns the last record with a time
+  before the specified time (-1 if there is none). The search gallops
+  from the cursor (the record of the previous query) in the direction
+  of the time, doubling the step, then bisects the last step, so a
+  query takes O(log d) comparisons for a record d records away.
+
+*************************************************************************/
+
+static long last_record_before(
+   HPE_ASPECT_STORE_P_T st_p, /* I - aspect store                     */
+   double          time)      /* I - event time                       */
+{
+   ASPECT_REC_P_T recs = st_p->recs;
+   long lo;                   /* a record before time (or -1)         */
+   long hi;                   /* a record at/after time (or num_recs) */
+   long step;
+   long mid;
+
+   if (recs[st_p->cursor].time < time)
+   {
+      lo = st_p->cursor;
+      for (step = 1; (lo + step < st_p->num_recs) &&
+                     (recs[lo + step].time < time); step <<= 1)
+      {
+         lo += step;
+      }
+      hi = (lo + step < st_p->num_recs) ? lo + step : st_p->num_recs;
+   }
+   else
+   {
+      hi = st_p->cursor;
+      for (step = 1; (hi - step >= 0) && (recs[hi - step].time >= time);
+           step <<= 1)
+      {
+         hi -= step;
+      }
+      lo = (hi - step >= 0) ? hi - step : -1;
+   }
+
+   while (hi - lo > 1)
+   {
+      mid = lo + ((hi - lo) / 2);
+      if (recs[mid].time < time)
+      {
+         lo = mid;
+      }
+      else
+      {
+         hi = mid;
+      }
+   }
+
+   return (lo);
+} /* end: last_record_before */
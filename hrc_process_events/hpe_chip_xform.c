@@ -0,0 +1,319 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_chip_xform.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_chip_xform.c contains the following modules used by
+  calculate_coords_hrc() to take the chip position of an event to the
+  focal plane and tiled detector systems (fastchip = yes):
+
+        setup_chip_xforms()
+        update_chip_xforms()
+        hpe_chip_xform()
+
+  Without fastchip, each event goes through pix_chip_to_fpc() and
+  pix_chip_to_tdet(). For a chip these are maps of the chip plane to
+  another plane: tdet is the chip position shifted (and flipped) onto
+  the tiled detector, and fpc the chip plane, placed by the alignment,
+  projected onto the focal plane. Either is a plane projective transform
+  (an affine transform for tdet), so it is given by a 3x3 matrix per
+  chip:
+
+        out = (H * [chip, 1]) / (third row of H * [chip, 1])
+
+  setup_chip_xforms() fits the transforms of each chip to pixlib once
+  pixlib is configured and update_chip_xforms() marks the chip to fpc
+  transforms to be fitted again whenever the alignment changes.
+  hpe_chip_xform() then takes an event through the transform of its
+  chip with a few multiply-adds and one division.
+
+* NOTES:
+
+  Each transform is fitted to four positions taken through pixlib and
+  checked against pixlib at three more. If a check differs by more than
+  HPE_CHIP_XFORM_TOL pixels (e.g. a pixlib geometry which is not a plane
+  projection), the events of that chip are left to pixlib. Chip ids
+  other than 0 to HPE_NUM_CHIPS-1 always go through pixlib.
+
+  With chipcheck = n > 0, every n'th position given by a transform of
+  each kind (fpc, tdet) is also taken through pixlib; the event is given
+  the pixlib position and, if the two differ by more than
+  HPE_CHIP_XFORM_TOL pixels, the chip is left to pixlib until its
+  transform is fitted again. The number of
+  positions checked and of those that did not match are written to the
+  logfile.
+
+  The chip transforms are only used by the calling thread (the
+  coordinate stage is not threaded), so they are not locked.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+/* chip positions of the corners of the fitted square (pixels) */
+#define HPE_CHIP_XFORM_LO    0.5
+#define HPE_CHIP_XFORM_HI    16384.5
+
+/* largest difference (pixels) from pixlib of a transformed position */
+#define HPE_CHIP_XFORM_TOL   1.0e-4
+
+static void    pixlib_chip_xform(short, short, double*, double*);
+static boolean fit_chip_xform(HPE_CHIP_XFORM_P_T, short, short);
+static boolean same_chip_position(double*, double*);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine setup_chip_xforms() clears the chip transforms, keeps the
+  check interval (chipcheck) and fits the transforms of every chip for
+  the current pixlib configuration and alignment.
+
+*************************************************************************/
+
+void setup_chip_xforms(
+   HPE_CHIP_XFORM_P_T xf_p,   /* O - chip transforms                  */
+   INPUT_PARMS_P_T    inp_p,  /* I - input parameters                 */
+   ALIGNMENT_REC_P_T  aln_p)  /* I - current alignment record         */
+{
+   short kind, chip;
+
+   memset(xf_p, 0, sizeof(HPE_CHIP_XFORM_T));
+   xf_p->check_every = (inp_p->chipcheck > 0) ? inp_p->chipcheck : 0;
+   for (kind = 0; kind < HPE_NUM_CHIP_XFORMS; kind++)
+   {
+      xf_p->until_check[kind] = xf_p->check_every;
+   }
+   xf_p->aln = *aln_p;
+
+   for (kind = 0; kind < HPE_NUM_CHIP_XFORMS; kind++)
+   {
+      for (chip = 0; chip < HPE_NUM_CHIPS; chip++)
+      {
+         fit_chip_xform(xf_p, kind, chip);
+      }
+   }
+} /* end: setup_chip_xforms */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine update_chip_xforms() is called after each alignment
+  update. If the alignment (mirror position and angles, aimpoint)
+  changed, the chip to fpc transforms are fitted again when next used.
+
+*************************************************************************/
+
+void update_chip_xforms(
+   HPE_CHIP_XFORM_P_T xf_p,   /* I/O - chip transforms                */
+   ALIGNMENT_REC_P_T  aln_p)  /* I   - current alignment record       */
+{
+   short chip;
+
+   if ((memcmp(xf_p->aln.pos, aln_p->pos, sizeof(aln_p->pos)) != 0) ||
+       (memcmp(xf_p->aln.theta, aln_p->theta, sizeof(aln_p->theta)) != 0) ||
+       (memcmp(xf_p->aln.hpy, aln_p->hpy, sizeof(aln_p->hpy)) != 0) ||
+       (memcmp(xf_p->aln.lass, aln_p->lass, sizeof(aln_p->lass)) != 0))
+   {
+      xf_p->aln = *aln_p;
+      for (chip = 0; chip < HPE_NUM_CHIPS; chip++)
+      {
+         xf_p->set[HPE_CHIP_TO_FPC][chip] = FALSE;
+      }
+   }
+} /* end: update_chip_xforms */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_chip_xform() takes a chip position to the focal plane
+  (kind = HPE_CHIP_TO_FPC) or tiled detector (HPE_CHIP_TO_TDET) system
+  with the transform of the chip, or through pixlib if the transforms
+  pointer is NULL or the chip has no valid transform.
+
+*************************************************************************/
+
+void hpe_chip_xform(
+   HPE_CHIP_XFORM_P_T xf_p,   /* I/O - chip transforms (NULL = pixlib)*/
+   short              kind,   /* I   - HPE_CHIP_TO_FPC/HPE_CHIP_TO_TDET*/
+   short              chip,   /* I   - chip id                        */
+   double*            in,     /* I   - chip position                  */
+   double*            out)    /* O   - fpc or tdet position           */
+{
+   double ref[2];
+
+   if ((xf_p == NULL) || (chip < 0) || (chip >= HPE_NUM_CHIPS))
+   {
+      pixlib_chip_xform(kind, chip, in, out);
+      return;
+   }
+
+   if (!xf_p->set[kind][chip])
+   {
+      fit_chip_xform(xf_p, kind, chip);
+   }
+   if (!xf_p->valid[kind][chip])
+   {
+      pixlib_chip_xform(kind, chip, in, out);
+      return;
+   }
+
+   hpe_apply_projective(xf_p->h[kind][chip], in, out);
+   xf_p->num_applied++;
+
+   /* (chipcheck) compare a sample of the positions with pixlib, counted
+    * by kind as each event usually takes both */
+   if ((xf_p->check_every > 0) && (--xf_p->until_check[kind] <= 0))
+   {
+      xf_p->until_check[kind] = xf_p->check_every;
+      pixlib_chip_xform(kind, chip, in, ref);
+      xf_p->num_checked++;
+      if (!same_chip_position(out, ref))
+      {
+         xf_p->num_mismatch++;
+         xf_p->valid[kind][chip] = FALSE;
+      }
+      out[0] = ref[0];
+      out[1] = ref[1];
+   }
+} /* end: hpe_chip_xform */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine pixlib_chip_xform() takes a chip position through pixlib
+  the way calculate_coords_hrc() does without fastchip.
+
+*************************************************************************/
+
+static void pixlib_chip_xform(
+   short   kind,              /* I - HPE_CHIP_TO_FPC/HPE_CHIP_TO_TDET */
+   short   chip,              /* I - chip id                          */
+   double* in,                /* I - chip position                    */
+   double* out)               /* O - fpc or tdet position             */
+{
+   if (kind == HPE_CHIP_TO_FPC)
+   {
+      pix_chip_to_fpc(chip, in, out);
+   }
+   else
+   {
+      pix_chip_to_tdet(chip, in, out);
+   }
+} /* end: pixlib_chip_xform */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fit_chip_xform() fits the transform of a chip to the
+  corners of the chip square HPE_CHIP_XFORM_LO to HPE_CHIP_XFORM_HI and
+  checks it against pixlib at its center and at two more positions.
+  The transform is marked valid if the checks pass, which is returned.
+
+*************************************************************************/
+
+static boolean fit_chip_xform(
+   HPE_CHIP_XFORM_P_T xf_p,   /* I/O - chip transforms                */
+   short              kind,   /* I   - HPE_CHIP_TO_FPC/HPE_CHIP_TO_TDET*/
+   short              chip)   /* I   - chip id                        */
+{
+   static const double corner[4][2] = { { 0.0, 0.0 }, { 1.0, 0.0 },
+                                        { 1.0, 1.0 }, { 0.0, 1.0 } };
+   static const double check[3][2]  = { { 0.5,   0.5   },
+                                        { 0.183, 0.771 },
+                                        { 0.912, 0.064 } };
+
+   double  pos[4][2];
+   double  ref[4][2];
+   double  fit[2];
+   double  span = HPE_CHIP_XFORM_HI - HPE_CHIP_XFORM_LO;
+   boolean ok;
+   int     kk;
+
+   for (kk = 0; kk < 4; kk++)
+   {
+      pos[kk][0] = HPE_CHIP_XFORM_LO + (span * corner[kk][0]);
+      pos[kk][1] = HPE_CHIP_XFORM_LO + (span * corner[kk][1]);
+      pixlib_chip_xform(kind, chip, pos[kk], ref[kk]);
+   }
+
+   ok = hpe_fit_projective(pos, ref, xf_p->h[kind][chip]);
+
+   /* check the transform against pixlib */
+   for (kk = 0; ok && (kk < 3); kk++)
+   {
+      pos[0][0] = HPE_CHIP_XFORM_LO + (span * check[kk][0]);
+      pos[0][1] = HPE_CHIP_XFORM_LO + (span * check[kk][1]);
+      pixlib_chip_xform(kind, chip, pos[0], ref[0]);
+      hpe_apply_projective(xf_p->h[kind][chip], pos[0], fit);
+      ok = same_chip_position(fit, ref[0]);
+   }
+
+   xf_p->set[kind][chip] = TRUE;
+   xf_p->valid[kind][chip] = ok;
+   if (ok)
+   {
+      xf_p->num_fits++;
+   }
+   else
+   {
+      xf_p->num_failed++;
+   }
+
+   return (ok);
+} /* end: fit_chip_xform */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine same_chip_position() returns TRUE if two positions differ
+  by no more than HPE_CHIP_XFORM_TOL pixels on either axis.
+
+*************************************************************************/
+
+static boolean same_chip_position(
+   double* aa,                /* I - position                         */
+   double* bb)                /* I - position                         */
+{
+   return ((fabs(aa[0] - bb[0]) <= HPE_CHIP_XFORM_TOL) &&
+           (fabs(aa[1] - bb[1]) <= HPE_CHIP_XFORM_TOL));
+} /* end: same_chip_position */
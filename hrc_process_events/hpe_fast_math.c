@@ -0,0 +1,226 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_fast_math.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_fast_math.c contains the following modules used by the
+  tap ring correction when fastmath = yes (check_tap_ring_batch()):
+
+        hpe_fast_pow()
+        hpe_fast_sin()
+
+  Each evaluates a function over an array of values with polynomial
+  approximations instead of the math library, in loops without calls
+  or branches which the compiler may vectorize. The values the
+  approximations do not cover (see below) are passed to pow()/sin().
+
+* NOTES:
+
+  Error bounds, measured against the math library over the values of
+  the tap ring correction:
+
+     hpe_fast_pow(x, y) - relative error below 1e-14 for 2**-14 <= x
+                          <= 2**14 and |y| <= 4 (below 5e-15 for the
+                          amplitude ratios and GAMMA of the tap file).
+     hpe_fast_sin(x)    - absolute error below 2e-16 for |x| <= 1000
+                          (below 3e-16 up to HPE_FAST_SIN_MAX).
+
+  The loops only run faster than the math library once vectorized by
+  the compiler (e.g. -O3 with the target's vector instructions); built
+  with -O2 alone, fastmath = no is as fast or faster.
+
+  In the tap ring correction these give a corrected A3 within 1e-8 ADC
+  channels of the math library result, far below the 1 channel
+  quantization of the amplitudes, although a position or PI on a bin
+  edge may still round the other way.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#include <math.h>
+#include <float.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+/* largest |x| reduced by hpe_fast_sin() (larger ones use sin()) */
+#define HPE_FAST_SIN_MAX     1.0e5
+
+/* largest |y * ln(x)| of hpe_fast_pow() (larger ones use pow()) */
+#define HPE_FAST_EXP_MAX     700.0
+
+/* ln(2) and pi/2 split so that k * high part is exact (fdlibm) */
+#define HPE_LN2_HI     6.93147180369123816490e-01
+#define HPE_LN2_LO     1.90821492927058770002e-10
+#define HPE_INV_LN2    1.44269504088896338700e+00
+#define HPE_PIO2_1     1.57079632673412561417e+00
+#define HPE_PIO2_2     6.07710050630396597660e-11
+#define HPE_PIO2_3     2.02226624879595063154e-21
+#define HPE_INV_PIO2   6.36619772367581382433e-01
+#define HPE_SQRT2      1.41421356237309504880e+00
+
+typedef union {
+   double             d;
+   unsigned long long u;
+} HPE_DBL_BITS_T;
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_fast_pow() sets out[i] = pow(x[i], y[i]) for i = 0 to
+  n-1. x = m * 2**e with sqrt(1/2) <= m < sqrt(2); ln(m) is the series
+  2 * atanh((m-1)/(m+1)) to the 17th power, and exp(y * ln(x)) = 2**k *
+  exp(f), |f| <= ln(2)/2, with a degree 13 Taylor polynomial. Zero,
+  subnormal, negative and non-finite x are left to pow().
+
+*************************************************************************/
+
+void hpe_fast_pow(
+   const double* x,           /* I - base of each value               */
+   const double* y,           /* I - exponent of each value           */
+   double*       out,         /* O - x**y                             */
+   long          n)           /* I - number of values                 */
+{
+   long ii;
+
+   for (ii = 0; ii < n; ii++)
+   {
+      HPE_DBL_BITS_T bx;
+      HPE_DBL_BITS_T scale;
+      double m, s, z, ln_m, ln_x, t, f, p;
+      long   e, k;
+      int    half;
+      int    covered;
+
+      /* x = m * 2**e */
+      bx.d = x[ii];
+      e = (long) ((bx.u >> 52) & 0x7ff) - 1023;
+      bx.u = (bx.u & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+      m = bx.d;
+      half = (m > HPE_SQRT2);
+      m = (half) ? 0.5 * m : m;
+      e += half;
+
+      /* ln(m) = 2 * (s + s**3/3 + ... + s**17/17) */
+      s = (m - 1.0) / (m + 1.0);
+      z = s * s;
+      ln_m = 2.0 * s * (1.0 + z * (1.0/3.0 + z * (1.0/5.0 + z * (1.0/7.0 +
+             z * (1.0/9.0 + z * (1.0/11.0 + z * (1.0/13.0 + z * (1.0/15.0 +
+             z * (1.0/17.0)))))))));
+
+      /* y * ln(x), with ln(2) split so e * HPE_LN2_HI is exact */
+      ln_x = ((double) e * HPE_LN2_HI) + (ln_m + (double) e * HPE_LN2_LO);
+      t = y[ii] * ln_x;
+      covered = ((x[ii] >= DBL_MIN) & (x[ii] <= DBL_MAX) &
+                 (fabs(t) < HPE_FAST_EXP_MAX));
+      t = (covered) ? t : 0.0;
+
+      /* exp(t) = 2**k * exp(f) */
+      k = (long) ((t * HPE_INV_LN2) + ((t >= 0.0) ? 0.5 : -0.5));
+      f = (t - (double) k * HPE_LN2_HI) - (double) k * HPE_LN2_LO;
+      p = 1.0 + f * (1.0 + f * (1.0/2.0 + f * (1.0/6.0 + f * (1.0/24.0 +
+          f * (1.0/120.0 + f * (1.0/720.0 + f * (1.0/5040.0 +
+          f * (1.0/40320.0 + f * (1.0/362880.0 + f * (1.0/3628800.0 +
+          f * (1.0/39916800.0 + f * (1.0/479001600.0 +
+          f * (1.0/6227020800.0)))))))))))));
+      scale.u = (unsigned long long) (k + 1023) << 52;
+
+      /* NaN marks the values left to pow() */
+      out[ii] = (covered) ? p * scale.d : NAN;
+   }
+
+   /* values outside of the approximations */
+   for (ii = 0; ii < n; ii++)
+   {
+      if (out[ii] != out[ii])
+      {
+         out[ii] = pow(x[ii], y[ii]);
+      }
+   }
+} /* end: hpe_fast_pow */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_fast_sin() sets out[i] = sin(x[i]) for i = 0 to n-1.
+  x is reduced to r = x - k * pi/2, |r| <= pi/4, with pi/2 split in
+  three parts, and sin(r) or cos(r) (by the quadrant k) is given by its
+  Taylor polynomial to the 17th or 16th power. |x| > HPE_FAST_SIN_MAX
+  and non-finite x are left to sin().
+
+*************************************************************************/
+
+void hpe_fast_sin(
+   const double* x,           /* I - angle of each value (radians)    */
+   double*       out,         /* O - sin(x)                           */
+   long          n)           /* I - number of values                 */
+{
+   long ii;
+
+   for (ii = 0; ii < n; ii++)
+   {
+      double xx = x[ii];
+      double r, z, sin_r, cos_r, v;
+      long   k;
+
+      xx = (xx > HPE_FAST_SIN_MAX) ? HPE_FAST_SIN_MAX :
+           ((xx < -HPE_FAST_SIN_MAX) ? -HPE_FAST_SIN_MAX : xx);
+
+      /* r = x - k * pi/2 */
+      k = (long) ((xx * HPE_INV_PIO2) + ((xx >= 0.0) ? 0.5 : -0.5));
+      r = ((xx - (double) k * HPE_PIO2_1) - (double) k * HPE_PIO2_2) -
+          (double) k * HPE_PIO2_3;
+      z = r * r;
+
+      sin_r = r * (1.0 - z * (1.0/6.0 - z * (1.0/120.0 - z * (1.0/5040.0 -
+              z * (1.0/362880.0 - z * (1.0/39916800.0 -
+              z * (1.0/6227020800.0 - z * (1.0/1307674368000.0 -
+              z * (1.0/355687428096000.0)))))))));
+      cos_r = 1.0 - z * (1.0/2.0 - z * (1.0/24.0 - z * (1.0/720.0 -
+              z * (1.0/40320.0 - z * (1.0/3628800.0 -
+              z * (1.0/479001600.0 - z * (1.0/87178291200.0 -
+              z * (1.0/20922789888000.0))))))));
+
+      /* quadrant: sin, cos, -sin, -cos */
+      v = (k & 1) ? cos_r : sin_r;
+      out[ii] = (k & 2) ? -v : v;
+   }
+
+   /* values outside of the approximation */
+   for (ii = 0; ii < n; ii++)
+   {
+      if (!(fabs(x[ii]) <= HPE_FAST_SIN_MAX))
+      {
+         out[ii] = sin(x[ii]);
+      }
+   }
+} /* end: hpe_fast_sin */
@@ -0,0 +1,489 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_file_workers.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_file_workers.c contains the following modules used by
+  hrc_process_events() to share the files of the input stack out between
+  worker processes (nprocs > 1):
+
+        start_file_workers()
+        end_file_workers()
+        stop_file_workers()
+        worker_sequence_times()
+        merge_worker_files()
+        free_file_workers()
+
+  start_file_workers() forks one worker process per contiguous range of
+  stack files. Each worker returns to hrc_process_events() and processes
+  the files of its range (inp_p->filestart..filestop) into its own
+  partial output files, '<outfile>.partN' and '<badfile>.partN', which
+  record the range in their header (hpe_write_file_keys()). The parent
+  waits for the workers in end_file_workers() and merges the partial
+  files, in stack order, into outfile and badfile
+  (hpe_merge_event_files()).
+
+* NOTES:
+
+  Worker processes are used rather than threads since pixlib, the
+  parameter interface and the error library keep global state. Each
+  worker starts the out of sequence time check again at its first file
+  and does not write the timing file; the events of a worker earlier
+  than the latest event of the workers before it are flagged out of
+  sequence when the partial files are merged (worker_sequence_times()),
+  the bad event files first so their count is added to the NSEQERR of
+  the output. The key of the pixel randomization is set before the
+  workers are started, so they all use the same one (rand_gen=pixlib,
+  one random sequence per process, is not allowed).
+
+  The calibration (pixlib, the gain, degap, ADC and tap tables, the
+  aspect store and the time window) is set up by the parent, from the
+  header of the first stack file, before the workers are started; they
+  share it and use the calibration of a single process run.
+
+  If a worker can not be started, the workers already started are
+  stopped and nothing is written; if a worker fails, its partial files
+  are not merged. Both are fatal errors.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - a worker which can not be started or fails is a fatal error;
+            stop the workers already started if one can not be started.
+  10/2026 - flag the events out of sequence across the workers when
+            their partial files are merged; the calibration is set up
+            by the parent before the workers are started.
+*H***********************************************************************/
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef HPE_MERGE_DEFS_H
+#include "hpe_merge_defs.h"
+#endif
+
+static double* worker_sequence_times(HPE_FILE_WORKERS_P_T, dsErrList*);
+static long merge_worker_files(char**, int, double*, long, char*,
+                               boolean, int, dsErrList*);
+static void stop_file_workers(HPE_FILE_WORKERS_P_T);
+static void free_file_workers(HPE_FILE_WORKERS_P_T);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine start_file_workers() forks min(nprocs, num_files) worker
+  processes. In a worker, the input parameters are set to its range of
+  stack files and partial output files and NULL is returned. In the
+  parent the workers are returned. NULL is also returned, without any
+  worker, if nprocs is 1 or the stack holds a single file, and (with a
+  fatal error added to the error list) if outfile can not be
+  overwritten, memory could not be allocated or a worker could not be
+  started; the workers already started are then stopped. The messages
+  in the error list are left to the parent; a worker starts with an
+  empty list.
+
+*************************************************************************/
+
+HPE_FILE_WORKERS_P_T start_file_workers(
+   INPUT_PARMS_P_T inp_p,     /* I/O - input parameters               */
+   long            num_files, /* I   - number of files in the stack   */
+   dsErrList*      err_p)     /* O   - error list pointer             */
+{
+   HPE_FILE_WORKERS_P_T wk_p = NULL;
+   int   num_workers;
+   int   kk;
+   pid_t pid;
+
+   if ((inp_p->nprocs <= 1) || (num_files <= 1))
+   {
+      return (NULL);
+   }
+   num_workers = (inp_p->nprocs < num_files) ? inp_p->nprocs : num_files;
+
+   /* check the output before the workers are started */
+   if (ds_clobber(inp_p->outfile, (dsErrBool) inp_p->clobber, err_p)
+       != dsNOERR)
+   {
+      return (NULL);
+   }
+
+   if (((wk_p = (HPE_FILE_WORKERS_P_T) calloc(1,
+                             sizeof(HPE_FILE_WORKERS_T))) == NULL) ||
+       ((wk_p->pid = (pid_t*) calloc(num_workers, sizeof(pid_t))) == NULL) ||
+       ((wk_p->outfile = (char**) calloc(num_workers, sizeof(char*)))
+        == NULL) ||
+       ((wk_p->badfile = (char**) calloc(num_workers, sizeof(char*)))
+        == NULL))
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up worker processes.");
+      free_file_workers(wk_p);
+      return (NULL);
+   }
+   wk_p->size = num_workers;
+
+   for (kk = 0; kk < num_workers; kk++)
+   {
+      wk_p->outfile[kk] = (char*) calloc(DS_SZ_PATHNAME, sizeof(char));
+      wk_p->badfile[kk] = (char*) calloc(DS_SZ_PATHNAME, sizeof(char));
+      if ((wk_p->outfile[kk] == NULL) || (wk_p->badfile[kk] == NULL))
+      {
+         dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+            "ERROR: Memory allocation failed setting up worker processes.");
+         free_file_workers(wk_p);
+         return (NULL);
+      }
+      snprintf(wk_p->outfile[kk], DS_SZ_PATHNAME, "%s.part%d",
+               inp_p->outfile, kk);
+      snprintf(wk_p->badfile[kk], DS_SZ_PATHNAME, "%s.part%d",
+               inp_p->badfile, kk);
+   }
+
+   /* nothing buffered may be written twice */
+   fflush(NULL);
+
+   for (kk = 0; kk < num_workers; kk++)
+   {
+      if ((pid = fork()) == 0)
+      {
+         /* worker: process files filestart..filestop of the stack */
+         inp_p->worker = kk + 1;
+         inp_p->filestart = ((kk * num_files) / num_workers) + 1;
+         inp_p->filestop = ((kk + 1) * num_files) / num_workers;
+         strcpy(inp_p->outfile, wk_p->outfile[kk]);
+         strcpy(inp_p->badfile, wk_p->badfile[kk]);
+         strcpy(inp_p->timingfile, "none");
+         inp_p->clobber = TRUE;
+         inp_p->nprocs = 1;
+         free_file_workers(wk_p);
+
+         /* messages so far are reported by the parent */
+         while (err_p->size > 0) dsErrRemove(err_p);
+         return (NULL);
+      }
+      else if (pid < 0)
+      {
+         dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+            "ERROR: Could not start worker process %d: %s.", kk + 1,
+            strerror(errno));
+         stop_file_workers(wk_p);
+         free_file_workers(wk_p);
+         return (NULL);
+      }
+      wk_p->pid[kk] = pid;
+      wk_p->num_workers++;
+   }
+
+   return (wk_p);
+} /* end: start_file_workers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine end_file_workers() waits for the worker processes. If all
+  of them succeeded, their partial output files are merged into outfile
+  and, if any worker rejected events, their partial bad event files are
+  merged into badfile (first, so the events they flag out of sequence
+  are counted in the output); a fatal error is added to the error list
+  for each worker which failed. The partial files are then removed and the
+  workers freed, setting the pointer to NULL.
+
+*************************************************************************/
+
+void end_file_workers(
+   HPE_FILE_WORKERS_P_T* wk_pp,  /* I/O - worker processes pointer    */
+   INPUT_PARMS_P_T       inp_p,  /* I   - input parameters            */
+   dsErrList*            err_p)  /* O   - error list pointer          */
+{
+   HPE_FILE_WORKERS_P_T wk_p = *wk_pp;
+   int  kk;
+   int  status = 0;
+   int  num_failed = 0;
+   long seq_bad = 0;          /* bad events flagged out of sequence  */
+   double* seq_stop = NULL;   /* latest event time before each worker */
+   pid_t done;
+
+   if (wk_p == NULL)
+   {
+      return;
+   }
+
+   for (kk = 0; kk < wk_p->num_workers; kk++)
+   {
+      while (((done = waitpid(wk_p->pid[kk], &status, 0)) < 0) &&
+             (errno == EINTR))
+      {
+         ;
+      }
+      if ((done < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+      {
+         dsErrAdd(err_p, dsOPENFILEFERR, Individual, Custom,
+            "ERROR: Worker process %d failed; its output %s can not be "
+            "merged.", kk + 1, wk_p->outfile[kk]);
+         num_failed++;
+      }
+   }
+
+   if ((num_failed == 0) && (err_p->contains_fatal == 0))
+   {
+      seq_stop = worker_sequence_times(wk_p, err_p);
+   }
+   if ((seq_stop != NULL) && (err_p->contains_fatal == 0))
+   {
+      seq_bad = merge_worker_files(wk_p->badfile, wk_p->num_workers,
+                                   seq_stop, 0, inp_p->badfile,
+                                   inp_p->clobber, inp_p->debug, err_p);
+      merge_worker_files(wk_p->outfile, wk_p->num_workers, seq_stop,
+                         seq_bad, inp_p->outfile, inp_p->clobber,
+                         inp_p->debug, err_p);
+   }
+   if (seq_stop != NULL)
+   {
+      free(seq_stop);
+   }
+
+   for (kk = 0; kk < wk_p->num_workers; kk++)
+   {
+      remove(wk_p->outfile[kk]);
+      remove(wk_p->badfile[kk]);
+   }
+
+   free_file_workers(wk_p);
+   *wk_pp = NULL;
+} /* end: end_file_workers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine stop_file_workers() stops the worker processes started so
+  far (SIGTERM), waits for them and removes their partial files.
+
+*************************************************************************/
+
+static void stop_file_workers(
+   HPE_FILE_WORKERS_P_T wk_p)    /* I/O - worker processes            */
+{
+   int   kk;
+   int   status;
+
+   for (kk = 0; kk < wk_p->num_workers; kk++)
+   {
+      kill(wk_p->pid[kk], SIGTERM);
+   }
+   for (kk = 0; kk < wk_p->num_workers; kk++)
+   {
+      while ((waitpid(wk_p->pid[kk], &status, 0) < 0) && (errno == EINTR))
+      {
+         ;
+      }
+      remove(wk_p->outfile[kk]);
+      remove(wk_p->badfile[kk]);
+   }
+   wk_p->num_workers = 0;
+} /* end: stop_file_workers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine worker_sequence_times() returns, for each worker, the time
+  of the latest event (good or rejected) of the workers before it, from
+  the EVTTSTOP keys of their partial output files: the last time a
+  single process would have checked the first event of the worker
+  against. NULL is returned, with a fatal error added to the error list,
+  if memory can not be allocated.
+
+*************************************************************************/
+
+static double* worker_sequence_times(
+   HPE_FILE_WORKERS_P_T wk_p,    /* I - worker processes              */
+   dsErrList*           err_p)   /* O - error list pointer            */
+{
+   double* seq_stop;
+   double  last_time = -DBL_MAX;
+   double  evt_tstart;
+   double  evt_tstop;
+   long    rowstart;
+   long    rowstop;
+   STATISTICS_T stat;
+   dmBlock* blk;
+   int     kk;
+
+   if ((seq_stop = (double*) calloc(wk_p->num_workers, sizeof(double)))
+       == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed merging worker outputs.");
+      return (NULL);
+   }
+
+   for (kk = 0; kk < wk_p->num_workers; kk++)
+   {
+      seq_stop[kk] = last_time;
+      if ((access(wk_p->outfile[kk], F_OK) == 0) &&
+          ((blk = dmTableOpen(wk_p->outfile[kk])) != NULL))
+      {
+         if (hpe_read_shard_keys(blk, &rowstart, &rowstop, &evt_tstart,
+                                 &evt_tstop, &stat) &&
+             (evt_tstop > last_time))
+         {
+            last_time = evt_tstop;
+         }
+         dmTableClose(blk);
+      }
+   }
+
+   return (seq_stop);
+} /* end: worker_sequence_times */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine merge_worker_files() merges the partial files written by
+  the workers, in worker (stack) order, into the specified file; the
+  events of a worker earlier than seq_stop (the latest event before the
+  worker) are flagged out of sequence and seq_extra events are added to
+  the count. Workers which did not write the file (no rejected events)
+  are skipped; nothing is written if none of them did. The number of
+  events flagged is returned.
+
+*************************************************************************/
+
+static long merge_worker_files(
+   char**     files,          /* I - partial file of each worker      */
+   int        num_workers,    /* I - number of workers                */
+   double*    seq_stop,       /* I - latest event before each worker  */
+   long       seq_extra,      /* I - events flagged in another file   */
+   char*      outfile,        /* I - merged file                      */
+   boolean    clobber,        /* I - TRUE = overwrite outfile         */
+   int        debug,          /* I - debug level                      */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   char**  found;
+   double* found_stop;
+   long    num_found = 0;
+   long    num_fixed = 0;
+   int     kk;
+
+   found = (char**) calloc(num_workers, sizeof(char*));
+   found_stop = (double*) calloc(num_workers, sizeof(double));
+   if ((found == NULL) || (found_stop == NULL))
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed merging worker outputs.");
+   }
+
+   for (kk = 0; (found != NULL) && (found_stop != NULL) &&
+        (kk < num_workers); kk++)
+   {
+      if (access(files[kk], F_OK) == 0)
+      {
+         found_stop[num_found] = seq_stop[kk];
+         found[num_found++] = files[kk];
+      }
+   }
+
+   if (num_found > 0)
+   {
+      num_fixed = hpe_merge_event_files(found, num_found, outfile, clobber,
+                                        TRUE, found_stop, seq_extra, debug,
+                                        err_p);
+   }
+
+   if (found != NULL)
+   {
+      free(found);
+   }
+   if (found_stop != NULL)
+   {
+      free(found_stop);
+   }
+
+   return (num_fixed);
+} /* end: merge_worker_files */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine free_file_workers() frees the worker processes structure.
+
+*************************************************************************/
+
+static void free_file_workers(
+   HPE_FILE_WORKERS_P_T wk_p)    /* I/O - worker processes            */
+{
+   int kk;
+
+   if (wk_p == NULL)
+   {
+      return;
+   }
+
+   for (kk = 0; (wk_p->outfile != NULL) && (kk < wk_p->size); kk++)
+   {
+      if (wk_p->outfile[kk] != NULL)
+      {
+         free(wk_p->outfile[kk]);
+      }
+   }
+   for (kk = 0; (wk_p->badfile != NULL) && (kk < wk_p->size); kk++)
+   {
+      if (wk_p->badfile[kk] != NULL)
+      {
+         free(wk_p->badfile[kk]);
+      }
+   }
+   if (wk_p->pid != NULL)
+   {
+      free(wk_p->pid);
+   }
+   if (wk_p->outfile != NULL)
+   {
+      free(wk_p->outfile);
+   }
+   if (wk_p->badfile != NULL)
+   {
+      free(wk_p->badfile);
+   }
+   free(wk_p);
+} /* end: free_file_workers */
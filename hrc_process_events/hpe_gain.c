@@ -25,12 +25,78 @@
  * JCC(10/2009) - initial version 
  * JCC(8/2012) - make TIMEGRID_LEN, RAWX_LEN dynamic for hrcS t_gain_map.
  *     ( Note: the old 'fixed' values were TIMEGRID_LEN=18, RAWX_LEN=48 )
+ * 10/2026 - look the gain cell of an event up in raw pixel tables built
+ *     by load_S_new_gain_table() instead of two grid_idx() searches, and
+ *     keep the offset and slope of each cell together (gainCell).
+ * 10/2026 - compute pi_double for a range of events in the PI stage
+ *     (S_new_gain_pi_range) instead of one event in the coordinate stage.
  *----------------------------------------------------------*/
 
 #include "hrc_process_events.h"
 #include "ds_hrc_config.h"
 #include "dsnan.h"
 
+static long gain_lut_idx(long *lut, long lutMin, long lutLen, double evtVal);
+
+/* 10/2026 - # events whose gain cells are looked up at a time */
+#define GAIN_PI_CHUNK  256
+
+/*----------------------------------------------------------
+ * 10/2026 - compute pi_double of the events of a range which were
+ *   not rejected (bad[ii] FALSE; every event if bad is NULL).
+ *   With the raw pixel tables, the gain cells of a chunk of events are
+ *   looked up first, then offset + slope*DDn is computed for each of
+ *   them in a loop of its own; otherwise S_new_gain_index_pi() is
+ *   called for each event.
+ *---------------------------------------------------------- */
+void S_new_gain_pi_range(
+            INPUT_PARMS_P_T inp_p,    /*I: */
+                EVENT_REC_T *evt_p,   /*U: first event of the range */
+                    boolean *bad,     /*I: TRUE = rejected ; or NULL */
+                       long num       /*I: # events in the range */
+                   )
+{
+   long cell[GAIN_PI_CHUNK] ;
+   long first, nn, ii ;
+
+   if ( !((inp_p->gainlutXlen > 0) && (inp_p->gainlutYlen > 0)) )
+   {
+      for (ii = 0; ii < num; ii++)
+      {
+         if ( (bad == NULL) || !bad[ii] )
+            S_new_gain_index_pi(inp_p, &evt_p[ii]);
+      }
+      return ;
+   }
+
+   for (first = 0; first < num; first += nn)
+   {
+      nn = ((num - first) < GAIN_PI_CHUNK) ? (num - first) : GAIN_PI_CHUNK ;
+
+      /* one table load per axis ; out of range values are clamped */
+      for (ii = 0; ii < nn; ii++)
+      {
+         cell[ii] =
+            gain_lut_idx(inp_p->gainlutX, inp_p->gainlutXmin,
+                         inp_p->gainlutXlen,
+                         evt_p[first+ii].rawpos[HDET_PLANE_X]) +
+            gain_lut_idx(inp_p->gainlutY, inp_p->gainlutYmin,
+                         inp_p->gainlutYlen,
+                         evt_p[first+ii].rawpos[HDET_PLANE_Y]) ;
+      }
+
+      /* dph spec eq(8) ;  offset + slope*DDn */
+      for (ii = 0; ii < nn; ii++)
+      {
+         if ( (bad == NULL) || !bad[first+ii] )
+         {
+            evt_p[first+ii].pi_double = inp_p->gainCell[cell[ii]].offset +
+               inp_p->gainCell[cell[ii]].slope * evt_p[first+ii].DDn ;
+         }
+      }
+   }
+} /* end: S_new_gain_pi_range() */
+
 /*----------------------------------------------------------
  * 1. Use evt rawx/rawy to get the index of gainmap column
  *    from dph new hrcS gain table. 
@@ -69,6 +135,90 @@ void S_new_gain_index_pi(
 
 } /* end: S_new_gain_index_pi() */ 
 
+/*------------------------------------------------------------------------
+ * 10/2026 - return the table entry of an evt raw x or y value ;
+ *   values below the table use the first entry, values above it the last.
+ *   (the first entry is also used for NaN, as grid_idx does)
+ *------------------------------------------------------------------------*/
+static long gain_lut_idx(
+      long   *lut,      /*I: raw pixel lookup table */
+      long   lutMin,    /*I: raw pixel of lut[0] */
+      long   lutLen,    /*I: # entries in lut */
+      double evtVal     /*I: evt rawx or rawy */
+                        )
+{
+   double pp = floor(evtVal) - lutMin ;
+
+   if ( !(pp > 0.0) )
+      return lut[0] ;
+   if ( pp >= lutLen )
+      return lut[lutLen-1] ;
+   return lut[ (long) pp ] ;
+} /* end: gain_lut_idx() */
+
+/*------------------------------------------------------------------------
+ * 10/2026 - build the raw pixel lookup table of rawxgrid or rawygrid:
+ *
+ *   lut[pp] = grid_idx( floor(gridCol[0])+pp ) * scale 
+ *
+ * for each integer raw pixel from floor(gridCol[0]) to the last grid
+ * value. When every grid value is an integer, grid_idx() returns the same
+ * index for any evt value in [pixel, pixel+1), so the table gives the
+ * grid_idx() result of any evt value with one load.
+ *
+ * If a grid value is not an integer, the range has more than GAIN_LUT_MAX
+ * pixels or the memory can't be allocated, *lut=NULL and *lutLen=0 ; the
+ * events are then looked up with grid_idx().
+ *------------------------------------------------------------------------*/
+void make_gain_lut (
+      long   dim_Grid,  /*I: dim of gridCol */
+      double *gridCol,  /*I: rawxgrid or rawygrid column ; ascending */
+      long   scale,     /*I: multiplier of the grid index (1 or RAWX_LEN) */
+      long   **lut,     /*O: lookup table */
+      long   *lutMin,   /*O: raw pixel of lut[0] */
+      long   *lutLen    /*O: # entries in lut */
+                   )
+{
+   short fnd ;
+   long  ii ;
+
+   *lut = NULL ;
+   *lutMin = 0 ;
+   *lutLen = 0 ;
+
+   if ( (dim_Grid < 1) || (gridCol == NULL) )
+      return ;
+
+   for (ii=0; ii<dim_Grid; ii++)
+   {
+      if ( (gridCol[ii] != floor(gridCol[ii])) ||
+           (fabs(gridCol[ii]) > (double) GAIN_LUT_MAX) )
+         return ;                    /* not an integer grid: use grid_idx */
+   }
+
+   if ( (gridCol[dim_Grid-1] - gridCol[0]) >= GAIN_LUT_MAX )
+      return ;
+
+   *lutMin = (long) gridCol[0] ;
+   *lutLen = (long) gridCol[dim_Grid-1] - *lutMin + 1 ;
+   if ( *lutLen < 1 )
+      *lutLen = 1 ;
+
+   if ( NULL == (*lut = (long *)calloc( *lutLen, sizeof(long))) )
+   {
+      *lutLen = 0 ;
+      return ;
+   }
+
+   for (ii=0; ii< *lutLen; ii++)
+   {
+      (*lut)[ii] = grid_idx( dim_Grid, gridCol, (double)(*lutMin+ii), &fnd )
+                   * scale ;
+   }
+
+   return ;
+} /* end: make_gain_lut() */
+
 /*------------------------------------------------------------------------
  * Use evt_mjd_obs to find the matched timegrid from dph hrcS gain table:
  *   (timeGrid=timegridVal[ww]) <= evt_mjd_obs < timegridVal[ww+1]
@@ -408,6 +558,35 @@ void load_S_new_gain_table(
       }
    }
 
+  /* ----------------------------------------------------------------
+   * 10/2026 - fused (offset, slope) of each cell and the raw pixel
+   *           lookup tables of rawxgrid/rawygrid (see make_gain_lut)
+   * ----------------------------------------------------------------*/
+   inp_p->gainlutX = NULL ;
+   inp_p->gainlutY = NULL ;
+   inp_p->gainlutXlen = 0 ;
+   inp_p->gainlutYlen = 0 ;
+   inp_p->gainCell=(HPE_GAIN_CELL_P_T)calloc(RAWX_LEN*RAWY_LEN,
+                                             sizeof(HPE_GAIN_CELL_T));
+   if ( (inp_p->gainCell != NULL) && (inp_p->rawygridSize >= RAWY_LEN) )
+   {
+      for (xj=0; xj<RAWX_LEN; xj++)
+      {
+         for (yi=0; yi<RAWY_LEN; yi++)
+         {
+            inp_p->gainCell[g2Idx(xj,yi,RAWX_LEN)].offset = 
+                 inp_p->gainmapVal[gmIdx(0,xj,yi,RAWX_LEN)] ;
+            inp_p->gainCell[g2Idx(xj,yi,RAWX_LEN)].slope = 
+                 inp_p->G_2nd[g2Idx(xj,yi,RAWX_LEN)] ;
+         }
+      }
+
+      make_gain_lut( RAWX_LEN, inp_p->rawxgridVal, 1, &inp_p->gainlutX,
+                     &inp_p->gainlutXmin, &inp_p->gainlutXlen ) ;
+      make_gain_lut( RAWY_LEN, inp_p->rawygridVal, RAWX_LEN, &inp_p->gainlutY,
+                     &inp_p->gainlutYmin, &inp_p->gainlutYlen ) ;
+   }
+
   /* ------------------
    * close the table 
    * ------------------*/
@@ -0,0 +1,129 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/***************************************************************************
+ * 10/2026 - initial version
+ * 10/2026 - add the merge of the outputs of the hrc_process_events worker
+ *           processes (nprocs > 1), one per range of stack files.
+ * 10/2026 - flag the events out of sequence with the earlier partial
+ *           files (seq_time) when they are merged.
+ *
+ * This file defines the structures used by hpe_merge_events, which merges
+ * the partial output files written by hrc_process_events runs on separate
+ * row ranges (rowstart/rowstop) of the same input, and the worker
+ * processes of a hrc_process_events run on a stack (nprocs > 1).
+ *
+ * Must be included after hrc_process_events.h.
+ ***************************************************************************/
+#ifndef HPE_MERGE_DEFS_H
+#define HPE_MERGE_DEFS_H
+
+#include <sys/types.h>
+
+#define HPE_MERGE_BLOCK_ROWS  65536  /* # rows copied per column read    */
+
+/*  the following structure holds a partial output file and the row range,
+ *  time range and statistics read from its header.
+ *
+ *  PARTIAL FILE STRUCTURE
+ */
+
+typedef struct hpe_merge_part_t {
+   char*       file;         /* file name                               */
+   dmDataset*  dataset;      /* file dataset                            */
+   dmBlock*    extension;    /* events block                            */
+   long        num_rows;     /* number of events                        */
+   long        rowstart;     /* first input row processed               */
+   long        rowstop;      /* last input row processed (0 = last)     */
+   double      evt_tstart;   /* time of earliest event                  */
+   double      evt_tstop;    /* time of latest event                    */
+   boolean     has_keys;     /* TRUE = partial output keys were found   */
+   long        filestart;    /* first stack file (0 = not a worker)     */
+   long        filestop;     /* last stack file processed               */
+   double      seq_time;     /* latest event time before the file       */
+   long        seq_fixed;    /* events flagged out of sequence by merge */
+   STATISTICS_T stat;        /* event statistics                        */
+} HPE_MERGE_PART_T, *HPE_MERGE_PART_P_T;
+
+
+/*  the following structure holds an output column and the information
+ *  needed to copy it from the partial files: a scalar or each component
+ *  of a vector is copied a block of rows at a time; array (e.g. bit
+ *  STATUS) columns are copied a row at a time.
+ *
+ *  MERGE COLUMN STRUCTURE
+ */
+
+typedef struct hpe_merge_col_t {
+   char           name[DS_SZ_COLUMN]; /* column name                    */
+   dmDataType     type;          /* column data type                    */
+   long           num_cpts;      /* # vector components (1 = scalar)    */
+   long           array_size;    /* # array elements (1 = not an array) */
+   dmDescriptor*  out_desc;      /* output column                       */
+   dmDescriptor*  in_desc;       /* column of the current partial file  */
+} HPE_MERGE_COL_T, *HPE_MERGE_COL_P_T;
+
+
+/*  the following structure holds the worker processes of a run on a
+ *  stack of input files (nprocs > 1) and the names of their partial
+ *  output files.
+ *
+ *  FILE WORKERS STRUCTURE
+ */
+
+typedef struct hpe_file_workers_t {
+   int      size;            /* number of workers set up                */
+   int      num_workers;     /* number of worker processes started      */
+   pid_t*   pid;             /* process id of each worker               */
+   char**   outfile;         /* partial output file of each worker      */
+   char**   badfile;         /* partial bad event file of each worker   */
+} HPE_FILE_WORKERS_T, *HPE_FILE_WORKERS_P_T;
+
+
+/*
+ *  the following externs are function prototypes of the hpe_merge_events
+ *  routines which have public access from other routines.
+ *
+ *  FUNCTION PROTOTYPES
+ */
+
+/* main routine of the hpe_merge_events tool */
+extern dsErrCode hpe_merge_events(void);
+
+/* routine to merge partial event files into one event file */
+extern long hpe_merge_event_files(char**,
+                                  long,
+                                  char*,
+                                  boolean,
+                                  boolean,
+                                  double*,
+                                  long,
+                                  int,
+                                  dsErrList*);
+
+/* routines to share the input stack files out between worker processes */
+extern HPE_FILE_WORKERS_P_T start_file_workers(INPUT_PARMS_P_T,
+                                               long,
+                                               dsErrList*);
+extern void end_file_workers(HPE_FILE_WORKERS_P_T*,
+                             INPUT_PARMS_P_T,
+                             dsErrList*);
+
+#endif   /* last line of header file- closes #ifndef HPE_MERGE_DEFS_H */
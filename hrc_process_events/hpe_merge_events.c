@@ -0,0 +1,986 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_merge_events.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_merge_events.c contains the hpe_merge_events tool, which
+  merges the partial level 1 event files written by hrc_process_events
+  runs on separate row ranges (rowstart/rowstop) of the same input into
+  one event file:
+
+        hpe_merge_events()
+        hpe_merge_event_files()
+        hpe_open_merge_part()
+        hpe_compare_merge_parts()
+        hpe_check_merge_keys()
+        hpe_check_merge_ranges()
+        hpe_setup_merge_columns()
+        hpe_copy_merge_part()
+        hpe_flag_sequence()
+        hpe_write_merge_keys()
+
+  The partial files are written to the output in input order: by their
+  first input row (ROWSTART), the order in which their row ranges are
+  checked. Each column is copied HPE_MERGE_BLOCK_ROWS rows at a
+  time, so the partial files are never read into memory as a whole.
+
+  The output header is the header of the first partial file with:
+
+     TSTART, TSTOP - the earliest EVTTSTRT and latest EVTTSTOP of the
+                     partial files
+     ROWSTART, ROWSTOP, EVTTSTRT, EVTTSTOP and the statistics keys
+                   - combined over the partial files (see
+                     hpe_shard_keys.c)
+
+  The calibration keys written by hrc_process_setup_output_file() and
+  write_instrume_params() and the columns (names and types) must be the
+  same in every partial file, and the row ranges (stack file ranges) of
+  the partial files must follow on from one another; otherwise nothing
+  is written.
+
+* NOTES:
+
+  Each run (worker) checks the time sequence of its own events only, so
+  the events of a partial file earlier than the latest event of the
+  files before it (seq_time: their EVTTSTOP keys and TIME columns, or
+  the times given by the caller) are flagged out of sequence
+  (HDET_SEQUENCE_STS) as they are copied and added to NSEQERR, as in a
+  single run over the whole input. Files without a STATUS column are
+  copied as they are. The bad event files of rowstart/rowstop runs are
+  merged on their own, without the times of the rejected events of the
+  other runs; hrc_process_events merges the bad event files of its
+  workers first and adds their count to the NSEQERR of the output.
+
+  NFILEIN and NBADFILE count the input files of each run; every run
+  reads the same files, so the largest value is kept instead of the sum.
+  The outputs of the worker processes of hrc_process_events (nprocs > 1)
+  each hold a range of the input stack files (FILESTRT/FILESTOP); they
+  are merged in stack order and their file counts are added.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - move the merge to hpe_merge_event_files() so hrc_process_events
+            can merge the outputs of its worker processes; order and add
+            up the outputs of stack file ranges.
+  10/2026 - mismatched keys and columns are fatal; check the columns by
+            name and type and the row (stack file) ranges for gaps and
+            overlaps; TSTART/TSTOP are the range of the event times.
+  10/2026 - order the partial files by their first input row instead of
+            the time of their earliest event, which a time glitch in a
+            later part could make come first.
+  10/2026 - flag the events earlier than those of the partial files
+            before them out of sequence and count them in NSEQERR.
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef HPE_MERGE_DEFS_H
+#include "hpe_merge_defs.h"
+#endif
+
+static void hpe_open_merge_part(HPE_MERGE_PART_P_T, boolean, dsErrList*);
+static int  hpe_compare_merge_parts(const void*, const void*);
+static void hpe_check_merge_keys(HPE_MERGE_PART_P_T, long, dsErrList*);
+static void hpe_check_merge_ranges(HPE_MERGE_PART_P_T, long, dsErrList*);
+static HPE_MERGE_COL_P_T hpe_setup_merge_columns(dmBlock*, long*,
+                                                 dsErrList*);
+static long hpe_copy_merge_part(HPE_MERGE_PART_P_T, dmBlock*,
+                                HPE_MERGE_COL_P_T, long, long, void*,
+                                double*, double*, dsErrList*);
+static boolean hpe_flag_sequence(unsigned char*);
+static void hpe_write_merge_keys(dmBlock*, HPE_MERGE_PART_P_T, long, long);
+
+/* header keys which must be the same in every partial file */
+static char* hpe_merge_str_keys[] = {
+   "ASOLFILE", "ADCCORF", "BPIXFILE", "GAINCORF", "DEGAP", "HYPFILE",
+   "TAPRING", "FLATFILE", "SATFILE", "AMPSFFIL", ASP_TYPE_KEY,
+   "ACSYS1", "ACSYS2", "ACSYS3", "ACSYS4", "ACSYS5", NULL };
+
+static char* hpe_merge_num_keys[] = {
+   "DEGAP_U1", "DEGAP_U2", "DEGAP_V1", "DEGAP_V2", "WIDTHRES",
+   "RAND_SKY", NULL };
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_merge_events() is the main routine of the tool. It
+  reads the parameters and merges the partial files of the input stack
+  in input row order (hpe_merge_event_files()). The error status is returned.
+
+*************************************************************************/
+
+dsErrCode hpe_merge_events(void)
+{
+   char      stack_in[DS_SZ_PATHNAME];    /* input partial files        */
+   char      outfile[DS_SZ_PATHNAME];     /* output event file          */
+   boolean   clobber = FALSE;
+   int       debug = 0;
+   Stack     instack = NULL;
+   long      num_parts = 0;
+   long      pp;
+   char**    files = NULL;
+   dsErrList* err_p = NULL;
+   dsErrCode  err = dsNOERR;
+
+   dsErrCreateList(&err_p);
+
+   /* load parameters from 'hpe_merge_events.par' */
+   clgstr("infile", stack_in, DS_SZ_PATHNAME);
+   clgstr("outfile", outfile, DS_SZ_PATHNAME);
+   clobber = clgetb("clobber");
+   debug = clgeti("verbose");
+
+   instack = stk_build(stack_in);
+   if ((num_parts = stk_count(instack)) < 1)
+   {
+      dsErrAdd(err_p, dsSTKEMPTYERR, Individual, Custom,
+         "ERROR: No input files found in %s.", stack_in);
+   }
+   else if ((files = (char**) calloc(num_parts, sizeof(char*))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up input files.");
+   }
+   else
+   {
+      for (pp = 0; pp < num_parts; pp++)
+      {
+         files[pp] = stk_read_next(instack);
+      }
+      hpe_merge_event_files(files, num_parts, outfile, clobber, FALSE,
+                            NULL, 0, debug, err_p);
+   }
+
+   /* clean up */
+   for (pp = 0; (files != NULL) && (pp < num_parts); pp++)
+   {
+      if (files[pp] != NULL)
+      {
+         free(files[pp]);
+      }
+   }
+   if (files != NULL)
+   {
+      free(files);
+   }
+   stk_close(instack);
+
+   if (err_p->size > 0)
+   {
+      if (err_p->contains_fatal != 0)
+      {
+         err = dsGENERICERR;
+      }
+      dsErrPrintList(err_p, dsErrTrue);
+   }
+   dsErrDestroyList(&err_p);
+
+   return (err);
+} /* end: hpe_merge_events */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_merge_event_files() opens the partial files, orders
+  them, copies them to the output file and writes the combined header
+  keys. The partial files are put in input row order (stack order for
+  the outputs of worker processes) unless 'listed' is TRUE, in which
+  case they are copied in the order given and need not have the partial
+  output keys (the combined keys are then only written if every file
+  has them). The events of a file earlier than the latest event before
+  it (the seq_stop time given for the file, if any, or that of the
+  files copied before it) are flagged out of sequence; seq_extra events
+  flagged in another file are added to the count written. The number of
+  events flagged is returned. Errors are added to the error list.
+
+*************************************************************************/
+
+long hpe_merge_event_files(
+   char**     files,          /* I - partial file names               */
+   long       num_parts,      /* I - number of partial files          */
+   char*      outfile,        /* I - output event file                */
+   boolean    clobber,        /* I - TRUE = overwrite outfile         */
+   boolean    listed,         /* I - TRUE = merge in the given order  */
+   double*    seq_stop,       /* I - latest event time before each    */
+                              /*     file (NULL = from the files)     */
+   long       seq_extra,      /* I - events flagged in another file   */
+   int        debug,          /* I - debug level                      */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   long      num_cols = 0;
+   long      pp;
+   long      out_row = 1;
+   long      num_fixed = 0;
+   double    last_time = -DBL_MAX; /* latest event of the files copied */
+   boolean   has_keys = TRUE;
+   HPE_MERGE_PART_P_T parts = NULL;
+   HPE_MERGE_COL_P_T  cols = NULL;
+   dmDataset* out_ds = NULL;
+   dmBlock*   out_blk = NULL;
+   void*      buf = NULL;
+   double*    times = NULL;
+
+   if ((parts = (HPE_MERGE_PART_P_T) calloc(num_parts,
+                                 sizeof(HPE_MERGE_PART_T))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up input files.");
+   }
+   else
+   {
+      /* open the partial files and read their header keys */
+      for (pp = 0; (pp < num_parts) && (err_p->contains_fatal == 0); pp++)
+      {
+         parts[pp].file = files[pp];
+         parts[pp].seq_time = (seq_stop != NULL) ? seq_stop[pp] : -DBL_MAX;
+         hpe_open_merge_part(&parts[pp], listed, err_p);
+         has_keys = has_keys && parts[pp].has_keys;
+      }
+   }
+
+   if (err_p->contains_fatal == 0)
+   {
+      if (!listed)
+      {
+         qsort(parts, num_parts, sizeof(HPE_MERGE_PART_T),
+               hpe_compare_merge_parts);
+      }
+      hpe_check_merge_keys(parts, num_parts, err_p);
+      if (has_keys)
+      {
+         hpe_check_merge_ranges(parts, num_parts, err_p);
+      }
+   }
+
+   /* create the output file from the first partial file */
+   if ((err_p->contains_fatal == 0) &&
+       (ds_clobber(outfile, (dsErrBool) clobber, err_p) == dsNOERR))
+   {
+      if (((out_ds = dmDatasetCreate(outfile)) == NULL) ||
+          ((out_blk = dmDatasetCreateTableCopy(out_ds, "EVENTS",
+                                               parts[0].extension)) == NULL))
+      {
+         dsErrAdd(err_p, dsCREATEFILEERR, Individual, Generic, outfile);
+      }
+      else
+      {
+         cols = hpe_setup_merge_columns(out_blk, &num_cols, err_p);
+         buf = calloc(HPE_MERGE_BLOCK_ROWS, sizeof(double));
+         times = (double*) calloc(HPE_MERGE_BLOCK_ROWS, sizeof(double));
+         if ((buf == NULL) || (times == NULL))
+         {
+            dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+               "ERROR: Memory allocation failed setting up column buffer.");
+         }
+      }
+   }
+
+   /* copy the events of each partial file, in order */
+   for (pp = 0; (pp < num_parts) && (out_blk != NULL) && (buf != NULL) &&
+        (times != NULL) && (err_p->contains_fatal == 0); pp++)
+   {
+      /* its events earlier than those before it are out of sequence */
+      if (last_time > parts[pp].seq_time)
+      {
+         parts[pp].seq_time = last_time;
+      }
+
+      if (debug > DEBUG_LEVEL_0)
+      {
+         fprintf(stdout, "  merge %s: rows %ld to %ld, %ld events\n",
+            parts[pp].file, parts[pp].rowstart, parts[pp].rowstop,
+            parts[pp].num_rows);
+      }
+      out_row = hpe_copy_merge_part(&parts[pp], out_blk, cols, num_cols,
+                                    out_row, buf, times, &last_time, err_p);
+      if (parts[pp].evt_tstop > last_time)
+      {
+         last_time = parts[pp].evt_tstop;
+      }
+      parts[pp].stat.sequence_err += parts[pp].seq_fixed;
+      num_fixed += parts[pp].seq_fixed;
+   }
+
+   if ((out_blk != NULL) && (err_p->contains_fatal == 0))
+   {
+      if (has_keys)
+      {
+         hpe_write_merge_keys(out_blk, parts, num_parts, seq_extra);
+      }
+      if (debug > DEBUG_LEVEL_0)
+      {
+         fprintf(stdout, "  %ld events written to %s (%ld flagged out "
+                 "of sequence)\n", out_row - 1, outfile, num_fixed);
+      }
+   }
+
+   /* clean up */
+   if (out_blk != NULL)
+   {
+      dmBlockClose(out_blk);
+   }
+   if (out_ds != NULL)
+   {
+      dmDatasetClose(out_ds);
+   }
+   for (pp = 0; (parts != NULL) && (pp < num_parts); pp++)
+   {
+      if (parts[pp].extension != NULL)
+      {
+         dmTableClose(parts[pp].extension);
+      }
+   }
+   if (parts != NULL)
+   {
+      free(parts);
+   }
+   if (cols != NULL)
+   {
+      free(cols);
+   }
+   if (buf != NULL)
+   {
+      free(buf);
+   }
+   if (times != NULL)
+   {
+      free(times);
+   }
+
+   return (num_fixed);
+} /* end: hpe_merge_event_files */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_open_merge_part() opens a partial file and reads the
+  row range, time range and statistics written by hpe_write_shard_keys()
+  and the stack file range written by hpe_write_file_keys(). An error is
+  added to the error list if the file can not be opened or (unless the
+  files are merged as listed) was not written by a hrc_process_events
+  run on a row range or a range of stack files.
+
+*************************************************************************/
+
+static void hpe_open_merge_part(
+   HPE_MERGE_PART_P_T part_p, /* I/O - partial file                    */
+   boolean            listed, /* I   - TRUE = keys are not required    */
+   dsErrList*         err_p)  /* O   - error list pointer              */
+{
+   if ((part_p->extension = dmTableOpen(part_p->file)) == NULL)
+   {
+      dsErrAdd(err_p, dsOPENFILEFERR, Individual, Generic, part_p->file);
+   }
+   else if (!(part_p->has_keys = hpe_read_shard_keys(part_p->extension,
+                 &part_p->rowstart, &part_p->rowstop, &part_p->evt_tstart,
+                 &part_p->evt_tstop, &part_p->stat)) && !listed)
+   {
+      dsErrAdd(err_p, dsFINDKEYWORDFERR, Individual, Custom,
+         "ERROR: %s has no %s key; it is not a partial hrc_process_events "
+         "output (rowstart/rowstop).", part_p->file, HPE_ROWSTART_KEY);
+   }
+   else
+   {
+      part_p->num_rows = dmTableGetNoRows(part_p->extension);
+      hpe_read_file_keys(part_p->extension, &part_p->filestart,
+                         &part_p->filestop);
+   }
+} /* end: hpe_open_merge_part */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_compare_merge_parts() is the qsort comparison routine
+  which orders the partial files by their first input row, the order
+  hpe_check_merge_ranges() checks. The outputs of worker processes are
+  ordered by their first stack file. Files without the partial output
+  keys fall back to the time of their earliest event.
+
+*************************************************************************/
+
+static int hpe_compare_merge_parts(
+   const void* aa,            /* I - first partial file               */
+   const void* bb)            /* I - second partial file              */
+{
+   HPE_MERGE_PART_P_T pa = (HPE_MERGE_PART_P_T) aa;
+   HPE_MERGE_PART_P_T pb = (HPE_MERGE_PART_P_T) bb;
+   int cmp = 0;
+
+   if ((pa->filestart > 0) && (pb->filestart > 0) &&
+       (pa->filestart != pb->filestart))
+   {
+      cmp = (pa->filestart < pb->filestart) ? -1 : 1;
+   }
+   else if (pa->has_keys && pb->has_keys &&
+            (pa->rowstart != pb->rowstart))
+   {
+      cmp = (pa->rowstart < pb->rowstart) ? -1 : 1;
+   }
+   else if (pa->evt_tstart < pb->evt_tstart)
+   {
+      cmp = -1;
+   }
+   else if (pa->evt_tstart > pb->evt_tstart)
+   {
+      cmp = 1;
+   }
+
+   return (cmp);
+} /* end: hpe_compare_merge_parts */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_check_merge_keys() verifies that the calibration keys
+  of every partial file match those of the first one, and that the
+  partial files have the same columns: the same names, data types,
+  vector components and array sizes. A fatal error is added to the
+  error list for each mismatch.
+
+*************************************************************************/
+
+static void hpe_check_merge_keys(
+   HPE_MERGE_PART_P_T parts,     /* I - partial files (time order)    */
+   long               num_parts, /* I - number of partial files       */
+   dsErrList*         err_p)     /* O - error list pointer            */
+{
+   char   val0[DS_SZ_PATHNAME];
+   char   val[DS_SZ_PATHNAME];
+   char   name[DS_SZ_COLUMN];
+   double dval0;
+   double dval;
+   boolean has0;
+   boolean has;
+   dmDescriptor* col0;
+   dmDescriptor* col;
+   long   num_cols = dmTableGetNoCols(parts[0].extension);
+   long   cc;
+   long   pp;
+   int    kk;
+
+   for (pp = 1; pp < num_parts; pp++)
+   {
+      if (dmTableGetNoCols(parts[pp].extension) != num_cols)
+      {
+         dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+            "ERROR: Columns of %s do not match %s.",
+            parts[pp].file, parts[0].file);
+      }
+
+      /* the columns are copied by name */
+      for (cc = 1; cc <= num_cols; cc++)
+      {
+         col0 = dmTableOpenColumnNo(parts[0].extension, cc);
+         dmGetName(col0, name, DS_SZ_COLUMN);
+         if ((col = dmTableOpenColumn(parts[pp].extension, name)) == NULL)
+         {
+            dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+               "ERROR: Column %s of %s not found in %s.", name,
+               parts[0].file, parts[pp].file);
+         }
+         else if ((dmGetElementDim(col) != dmGetElementDim(col0)) ||
+                  (dmGetArraySize(col) != dmGetArraySize(col0)) ||
+                  ((dmGetElementDim(col0) > 1) ?
+                   (dmGetDataType(dmGetCpt(col, 1)) !=
+                    dmGetDataType(dmGetCpt(col0, 1))) :
+                   (dmGetDataType(col) != dmGetDataType(col0))))
+         {
+            dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+               "ERROR: Column %s of %s does not have the type of %s.",
+               name, parts[pp].file, parts[0].file);
+         }
+      }
+
+      for (kk = 0; hpe_merge_str_keys[kk] != NULL; kk++)
+      {
+         val0[0] = val[0] = '\0';
+         has0 = (dmKeyRead_c(parts[0].extension, hpe_merge_str_keys[kk],
+                             val0, DS_SZ_PATHNAME) != NULL);
+         has = (dmKeyRead_c(parts[pp].extension, hpe_merge_str_keys[kk],
+                            val, DS_SZ_PATHNAME) != NULL);
+         if ((has0 != has) || (strcmp(val0, val) != 0))
+         {
+            dsErrAdd(err_p, dsFINDKEYWORDFERR, Individual, Custom,
+               "ERROR: Header keyword %s of %s does not match %s.",
+               hpe_merge_str_keys[kk], parts[pp].file, parts[0].file);
+         }
+      }
+
+      for (kk = 0; hpe_merge_num_keys[kk] != NULL; kk++)
+      {
+         dval0 = dval = 0.0;
+         has0 = (dmKeyRead_d(parts[0].extension, hpe_merge_num_keys[kk],
+                             &dval0) != NULL);
+         has = (dmKeyRead_d(parts[pp].extension, hpe_merge_num_keys[kk],
+                            &dval) != NULL);
+         if ((has0 != has) || (dval0 != dval))
+         {
+            dsErrAdd(err_p, dsFINDKEYWORDFERR, Individual, Custom,
+               "ERROR: Header keyword %s of %s does not match %s.",
+               hpe_merge_num_keys[kk], parts[pp].file, parts[0].file);
+         }
+      }
+   }
+} /* end: hpe_check_merge_keys */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_check_merge_ranges() verifies that the partial files
+  cover their input without gaps or overlaps. The outputs of worker
+  processes must hold consecutive ranges of stack files (in their merge
+  order); the outputs of runs on row ranges of the same input file must
+  hold consecutive row ranges (in row order), with only the last one
+  going up to the last row (ROWSTOP = 0). A fatal error is added to the
+  error list for each gap or overlap.
+
+*************************************************************************/
+
+static void hpe_check_merge_ranges(
+   HPE_MERGE_PART_P_T parts,     /* I - partial files (merge order)   */
+   long               num_parts, /* I - number of partial files       */
+   dsErrList*         err_p)     /* O - error list pointer            */
+{
+   long* order = NULL;        /* partial files in row order            */
+   long  pp;
+   long  qq;
+   long  prev;
+   long  next;
+
+   if (parts[0].filestart > 0)
+   {
+      /* worker outputs: consecutive stack file ranges */
+      for (pp = 1; pp < num_parts; pp++)
+      {
+         if (parts[pp].filestart != parts[pp - 1].filestop + 1)
+         {
+            dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+               "ERROR: Stack files %ld to %ld of %s do not follow on "
+               "from files %ld to %ld of %s.", parts[pp].filestart,
+               parts[pp].filestop, parts[pp].file, parts[pp - 1].filestart,
+               parts[pp - 1].filestop, parts[pp - 1].file);
+         }
+      }
+      return;
+   }
+
+   if ((order = (long*) calloc(num_parts, sizeof(long))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed checking the row ranges.");
+      return;
+   }
+
+   /* order the partial files by their first row (insertion sort) */
+   for (pp = 0; pp < num_parts; pp++)
+   {
+      for (qq = pp; (qq > 0) &&
+           (parts[order[qq - 1]].rowstart > parts[pp].rowstart); qq--)
+      {
+         order[qq] = order[qq - 1];
+      }
+      order[qq] = pp;
+   }
+
+   for (pp = 1; pp < num_parts; pp++)
+   {
+      prev = order[pp - 1];
+      next = order[pp];
+      if ((parts[next].filestart > 0) || (parts[prev].rowstop == 0) ||
+          (parts[next].rowstart != parts[prev].rowstop + 1))
+      {
+         dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+            "ERROR: Rows %ld to %ld of %s do not follow on from rows %ld "
+            "to %ld of %s (0 = last row).", parts[next].rowstart,
+            parts[next].rowstop, parts[next].file, parts[prev].rowstart,
+            parts[prev].rowstop, parts[prev].file);
+      }
+   }
+
+   free(order);
+} /* end: hpe_check_merge_ranges */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_setup_merge_columns() returns the list of the columns
+  of the output file with their type, number of vector components and
+  array size. The number of columns is returned in num_cols_p.
+
+*************************************************************************/
+
+static HPE_MERGE_COL_P_T hpe_setup_merge_columns(
+   dmBlock*   out_blk,        /* I - output events block              */
+   long*      num_cols_p,     /* O - number of columns                */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   HPE_MERGE_COL_P_T cols = NULL;
+   long cc;
+
+   *num_cols_p = dmTableGetNoCols(out_blk);
+
+   if ((cols = (HPE_MERGE_COL_P_T) calloc(*num_cols_p,
+                                    sizeof(HPE_MERGE_COL_T))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up output columns.");
+      *num_cols_p = 0;
+   }
+
+   for (cc = 0; cc < *num_cols_p; cc++)
+   {
+      cols[cc].out_desc = dmTableOpenColumnNo(out_blk, cc + 1);
+      dmGetName(cols[cc].out_desc, cols[cc].name, DS_SZ_COLUMN);
+      cols[cc].num_cpts = dmGetElementDim(cols[cc].out_desc);
+      cols[cc].type = (cols[cc].num_cpts > 1) ?
+         dmGetDataType(dmGetCpt(cols[cc].out_desc, 1)) :
+         dmGetDataType(cols[cc].out_desc);
+      cols[cc].array_size = (cols[cc].num_cpts > 1) ? 1 :
+         dmGetArraySize(cols[cc].out_desc);
+      if (cols[cc].array_size < 1)
+      {
+         cols[cc].array_size = 1;
+      }
+   }
+
+   return (cols);
+} /* end: hpe_setup_merge_columns */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_copy_merge_part() appends the rows of a partial file
+  to the output file, starting at output row out_row. Scalar columns and
+  vector components are copied a block of rows at a time (through buf,
+  which holds HPE_MERGE_BLOCK_ROWS doubles); array columns are then
+  copied row by row. The TIME values of the block are kept in times;
+  the STATUS of an event earlier than part_p->seq_time is flagged out
+  of sequence (counted in part_p->seq_fixed) and the latest TIME is
+  kept in last_time_p. The next output row is returned.
+
+*************************************************************************/
+
+static long hpe_copy_merge_part(
+   HPE_MERGE_PART_P_T part_p,    /* I - partial file                  */
+   dmBlock*           out_blk,   /* I - output events block           */
+   HPE_MERGE_COL_P_T  cols,      /* I - output columns                */
+   long               num_cols,  /* I - number of columns             */
+   long               out_row,   /* I - first output row to write     */
+   void*              buf,       /* W - column buffer                 */
+   double*            times,     /* W - TIME values of a block        */
+   double*            last_time_p, /* I/O - latest TIME copied        */
+   dsErrList*         err_p)     /* O - error list pointer            */
+{
+   long first;
+   long nrows;
+   long rr;
+   long cc;
+   long kk;
+   long time_col = -1;       /* TIME column (-1 = none)             */
+   long status_col = -1;     /* STATUS bit column (-1 = none)       */
+
+   part_p->seq_fixed = 0;
+
+   for (cc = 0; cc < num_cols; cc++)
+   {
+      if ((cols[cc].in_desc = dmTableOpenColumn(part_p->extension,
+                                                cols[cc].name)) == NULL)
+      {
+         dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+            "ERROR: Column %s not found in %s.", cols[cc].name,
+            part_p->file);
+      }
+      else if ((ds_strcmp_cis(cols[cc].name, "time") == 0) &&
+               (cols[cc].num_cpts == 1) && (cols[cc].array_size == 1) &&
+               ((cols[cc].type == dmDOUBLE) || (cols[cc].type == dmFLOAT)))
+      {
+         time_col = cc;
+      }
+      else if ((ds_strcmp_cis(cols[cc].name, "status") == 0) &&
+               (cols[cc].type == dmBIT) && (cols[cc].array_size >= 4))
+      {
+         status_col = cc;
+      }
+   }
+   if (time_col < 0)
+   {
+      status_col = -1;
+   }
+
+   for (first = 1; (first <= part_p->num_rows) &&
+        (err_p->contains_fatal == 0); first += nrows)
+   {
+      nrows = part_p->num_rows - first + 1;
+      if (nrows > HPE_MERGE_BLOCK_ROWS)
+      {
+         nrows = HPE_MERGE_BLOCK_ROWS;
+      }
+
+      /* scalar columns and vector components- a block at a time */
+      for (cc = 0; cc < num_cols; cc++)
+      {
+         if (cols[cc].array_size > 1)
+         {
+            continue;
+         }
+
+         for (kk = 1; kk <= cols[cc].num_cpts; kk++)
+         {
+            dmDescriptor* in_d = (cols[cc].num_cpts > 1) ?
+               dmGetCpt(cols[cc].in_desc, kk) : cols[cc].in_desc;
+            dmDescriptor* out_d = (cols[cc].num_cpts > 1) ?
+               dmGetCpt(cols[cc].out_desc, kk) : cols[cc].out_desc;
+
+            switch (cols[cc].type)
+            {
+               case dmDOUBLE:
+               case dmFLOAT:
+                  dmGetScalars_d(in_d, (double*) buf, first, nrows);
+                  dmSetScalars_d(out_d, (double*) buf, out_row, nrows);
+                  if (cc == time_col)
+                  {
+                     memcpy(times, buf, nrows * sizeof(double));
+                  }
+               break;
+
+               default:
+                  dmGetScalars_l(in_d, (long*) buf, first, nrows);
+                  dmSetScalars_l(out_d, (long*) buf, out_row, nrows);
+               break;
+            }
+         }
+      }
+
+      /* array columns (e.g. STATUS bits)- a row at a time */
+      for (cc = 0; cc < num_cols; cc++)
+      {
+         if (cols[cc].array_size <= 1)
+         {
+            continue;
+         }
+
+         for (rr = 0; rr < nrows; rr++)
+         {
+            dmTableSetRow(part_p->extension, first + rr);
+            dmTableSetRow(out_blk, out_row + rr);
+            switch (cols[cc].type)
+            {
+               case dmBIT:
+                  dmGetArray_bit(cols[cc].in_desc, (unsigned char*) buf,
+                                 cols[cc].array_size);
+                  if ((cc == status_col) &&
+                      (times[rr] < part_p->seq_time) &&
+                      hpe_flag_sequence((unsigned char*) buf))
+                  {
+                     part_p->seq_fixed++;
+                  }
+                  dmSetArray_bit(cols[cc].out_desc, (unsigned char*) buf,
+                                 cols[cc].array_size);
+               break;
+
+               case dmDOUBLE:
+               case dmFLOAT:
+                  dmGetArray_d(cols[cc].in_desc, (double*) buf,
+                               cols[cc].array_size);
+                  dmSetArray_d(cols[cc].out_desc, (double*) buf,
+                               cols[cc].array_size);
+               break;
+
+               default:
+                  dmGetArray_l(cols[cc].in_desc, (long*) buf,
+                               cols[cc].array_size);
+                  dmSetArray_l(cols[cc].out_desc, (long*) buf,
+                               cols[cc].array_size);
+               break;
+            }
+         }
+      }
+
+      for (rr = 0; (time_col >= 0) && (rr < nrows); rr++)
+      {
+         if (times[rr] > *last_time_p)
+         {
+            *last_time_p = times[rr];
+         }
+      }
+
+      out_row += nrows;
+   }
+
+   return (out_row);
+} /* end: hpe_copy_merge_part */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_flag_sequence() sets HDET_SEQUENCE_STS in the STATUS
+  bits of an event, which are held most significant byte first (see
+  st_status_bit() in write_hrc_events.c). TRUE is returned if the bit
+  was not already set, i.e. the event was not counted out of sequence
+  by the run which wrote it.
+
+*************************************************************************/
+
+static boolean hpe_flag_sequence(
+   unsigned char* bits)       /* I/O - STATUS bits of an event        */
+{
+   boolean flagged = FALSE;
+   unsigned char mask;
+   int bb;
+
+   for (bb = 0; bb < 4; bb++)
+   {
+      mask = (unsigned char) ((HDET_SEQUENCE_STS >> (8 * (3 - bb))) & 0xff);
+      if ((mask != 0) && ((bits[bb] & mask) == 0))
+      {
+         bits[bb] |= mask;
+         flagged = TRUE;
+      }
+   }
+
+   return (flagged);
+} /* end: hpe_flag_sequence */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_write_merge_keys() writes the combined row range, time
+  range and statistics of the partial files to the output header, with
+  seq_extra added to the out of sequence count. The stack file range
+  keys of worker outputs are not written, since the merged file holds
+  every file of the stack.
+
+*************************************************************************/
+
+static void hpe_write_merge_keys(
+   dmBlock*           out_blk,   /* I - output events block           */
+   HPE_MERGE_PART_P_T parts,     /* I - partial files                 */
+   long               num_parts, /* I - number of partial files       */
+   long               seq_extra) /* I - events flagged in another file */
+{
+   HPE_MERGE_PART_T all;
+   STATISTICS_P_T   st;
+   long pp;
+
+   memset(&all, 0, sizeof(HPE_MERGE_PART_T));
+   all.rowstart = parts[0].rowstart;
+   all.rowstop = parts[0].rowstop;
+   all.evt_tstart = DBL_MAX;
+   all.evt_tstop = -DBL_MAX;
+   all.stat.sequence_err = seq_extra;
+
+   for (pp = 0; pp < num_parts; pp++)
+   {
+      st = &parts[pp].stat;
+
+      if (parts[pp].rowstart < all.rowstart)
+      {
+         all.rowstart = parts[pp].rowstart;
+      }
+      if ((parts[pp].rowstop == 0) || (all.rowstop == 0))
+      {
+         all.rowstop = 0;     /* up to the last row */
+      }
+      else if (parts[pp].rowstop > all.rowstop)
+      {
+         all.rowstop = parts[pp].rowstop;
+      }
+
+      if (parts[pp].evt_tstart < all.evt_tstart)
+      {
+         all.evt_tstart = parts[pp].evt_tstart;
+      }
+      if (parts[pp].evt_tstop > all.evt_tstop)
+      {
+         all.evt_tstop = parts[pp].evt_tstop;
+      }
+
+      all.stat.total_events_in  += st->total_events_in;
+      all.stat.total_events_out += st->total_events_out;
+      all.stat.bad_grid_ratio   += st->bad_grid_ratio;
+      all.stat.bad_pha_ratio    += st->bad_pha_ratio;
+      all.stat.bad_dist[HDET_PLANE_X] += st->bad_dist[HDET_PLANE_X];
+      all.stat.bad_dist[HDET_PLANE_Y] += st->bad_dist[HDET_PLANE_Y];
+      all.stat.bad_bot          += st->bad_bot;
+      all.stat.fixed_mfinpos    += st->fixed_mfinpos;
+      all.stat.fixed_pfinpos    += st->fixed_pfinpos;
+      all.stat.sequence_err     += st->sequence_err;
+
+      if (parts[pp].filestart > 0)
+      {
+         /* each worker process reads its own stack files */
+         all.stat.num_files_in  += st->num_files_in;
+         all.stat.num_bad_files += st->num_bad_files;
+      }
+      else
+      {
+         /* every run reads the same input files */
+         if (st->num_files_in > all.stat.num_files_in)
+         {
+            all.stat.num_files_in = st->num_files_in;
+         }
+         if (st->num_bad_files > all.stat.num_bad_files)
+         {
+            all.stat.num_bad_files = st->num_bad_files;
+         }
+      }
+   }
+
+   /* TSTART/TSTOP span the events of the partial files */
+   if (all.evt_tstart != DBL_MAX)
+   {
+      dmKeyWrite_d(out_blk, "TSTART", all.evt_tstart, "s", NULL);
+   }
+   if (all.evt_tstop != -DBL_MAX)
+   {
+      dmKeyWrite_d(out_blk, "TSTOP", all.evt_tstop, "s", NULL);
+   }
+
+   hpe_write_shard_keys(out_blk, all.rowstart, all.rowstop, all.evt_tstart,
+                        all.evt_tstop, &all.stat);
+} /* end: hpe_write_merge_keys */
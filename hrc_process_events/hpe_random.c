@@ -0,0 +1,161 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_random.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_random.c contains the following modules used by
+  hrc_process_events() for the pixel randomization (rand_pix_size > 0)
+  when rand_gen=counter:
+
+        hpe_philox4x32()
+        hpe_random_offsets()
+
+  The random values of an event are computed from the random seed, the
+  position of the input file in the stack and the input row of the event
+  with a counter based generator (Philox4x32-10, Salmon et al. 2011,
+  "Parallel Random Numbers: As Easy as 1, 2, 3"). Unlike the pixlib
+  generator (rand_gen=pixlib), which returns the next value of a single
+  sequence, the values of an event do not depend on which events were
+  processed before it, so they are the same whatever the processing
+  order, batch size or number of threads, or if only part of a file is
+  processed.
+
+* NOTES:
+
+  One call of the generator returns four 32 bit values, which give the
+  53 bit x and y offsets of an event.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#include <stdint.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+/* Philox4x32 multipliers and key increments (Weyl sequence) */
+#define PHILOX_M0       0xD2511F53UL
+#define PHILOX_M1       0xCD9E8D57UL
+#define PHILOX_W0       0x9E3779B9UL
+#define PHILOX_W1       0xBB67AE85UL
+#define PHILOX_ROUNDS   10
+
+/* 2^-53, to scale a 53 bit integer to [0,1) */
+#define HPE_RAND_2POW53 (1.0 / 9007199254740992.0)
+
+static void hpe_philox4x32(const uint32_t[4], const uint32_t[2], uint32_t[4]);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_philox4x32() computes the four 32 bit random values
+  for the counter ctr and the key key (Philox4x32 with 10 rounds).
+
+*************************************************************************/
+
+static void hpe_philox4x32(
+   const uint32_t ctr[4],     /* I - counter                          */
+   const uint32_t key[2],     /* I - key                              */
+   uint32_t       out[4])     /* O - random values                    */
+{
+   uint32_t c0 = ctr[0];
+   uint32_t c1 = ctr[1];
+   uint32_t c2 = ctr[2];
+   uint32_t c3 = ctr[3];
+   uint32_t k0 = key[0];
+   uint32_t k1 = key[1];
+   uint64_t p0;
+   uint64_t p1;
+   int      rr;
+
+   for (rr = 0; rr < PHILOX_ROUNDS; rr++)
+   {
+      p0 = (uint64_t) PHILOX_M0 * c0;
+      p1 = (uint64_t) PHILOX_M1 * c2;
+
+      c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+      c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+      c1 = (uint32_t) p1;
+      c3 = (uint32_t) p0;
+
+      k0 += (uint32_t) PHILOX_W0;
+      k1 += (uint32_t) PHILOX_W1;
+   }
+
+   out[0] = c0;
+   out[1] = c1;
+   out[2] = c2;
+   out[3] = c3;
+} /* end: hpe_philox4x32 */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_random_offsets() returns the x and y randomization
+  offsets, from -randpixsize to +randpixsize, of an event. The counter
+  is made of the input row of the event and the position of the input
+  file in the stack; the key is the random seed.
+
+*************************************************************************/
+
+void hpe_random_offsets(
+   INPUT_PARMS_P_T inp_p,     /* I - rand_key, file_num, randpixsize  */
+   EVENT_REC_P_T   evt_p,     /* I - event record (row)               */
+   VEC2_DBLE       offset)    /* O - x and y offsets                  */
+{
+   uint32_t ctr[4];
+   uint32_t key[2];
+   uint32_t out[4];
+   double   uu[HDET_NUM_PLANES];
+   int      plane;
+
+   ctr[0] = (uint32_t) ((uint64_t) evt_p->row & 0xFFFFFFFFUL);
+   ctr[1] = (uint32_t) ((uint64_t) evt_p->row >> 32);
+   ctr[2] = (uint32_t) inp_p->file_num;
+   ctr[3] = 0;
+
+   key[0] = (uint32_t) ((uint64_t) inp_p->rand_key & 0xFFFFFFFFUL);
+   key[1] = (uint32_t) ((uint64_t) inp_p->rand_key >> 32);
+
+   hpe_philox4x32(ctr, key, out);
+
+   /* 27 + 26 bits -> uniform value in [0,1) */
+   uu[HDET_PLANE_X] = ((double) (out[0] >> 5) * 67108864.0 +
+                       (double) (out[1] >> 6)) * HPE_RAND_2POW53;
+   uu[HDET_PLANE_Y] = ((double) (out[2] >> 5) * 67108864.0 +
+                       (double) (out[3] >> 6)) * HPE_RAND_2POW53;
+
+   for (plane = 0; plane < HDET_NUM_PLANES; plane++)
+   {
+      offset[plane] = (uu[plane] - 0.5) * (2.0 * inp_p->randpixsize);
+   }
+} /* end: hpe_random_offsets */
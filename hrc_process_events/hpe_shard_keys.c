@@ -0,0 +1,220 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_shard_keys.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_shard_keys.c contains the following modules which write
+  and read the header keys of an output made from part of the input rows
+  (rowstart/rowstop). They are used by hrc_process_events() and by the
+  hpe_merge_events tool:
+
+        hpe_write_shard_keys()
+        hpe_read_shard_keys()
+        hpe_write_file_keys()
+        hpe_read_file_keys()
+
+  The keys (HPE_*_KEY in hrc_process_events.h) hold the row range, the
+  times of the earliest and latest events and the STATISTICS_T counters.
+  An output written by a worker process (nprocs > 1) also records the
+  range of input stack files it processed.
+
+* NOTES:
+
+* REVISION HISTORY:
+  10/2026 - initial version; hpe_write_shard_keys moved here from
+            hrc_process_setup_output_file.c.
+  10/2026 - add the stack file range keys (worker processes).
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_write_shard_keys() writes the row range, event time
+  range and statistics to the header of an event file. The time range
+  is only written if the file has events (evt_tstart <= evt_tstop).
+
+*************************************************************************/
+
+void hpe_write_shard_keys(
+   dmBlock*       bb,         /* I - events block                     */
+   long           rowstart,   /* I - first input row processed        */
+   long           rowstop,    /* I - last input row (0 = last row)    */
+   double         evt_tstart, /* I - time of earliest event           */
+   double         evt_tstop,  /* I - time of latest event             */
+   STATISTICS_P_T stat_p)     /* I - event statistics                 */
+{
+   dmKeyWrite_l(bb, HPE_ROWSTART_KEY, rowstart, NULL,
+                "first input row processed");
+   dmKeyWrite_l(bb, HPE_ROWSTOP_KEY, rowstop, NULL,
+                "last input row processed (0 = last row)");
+
+   if (evt_tstart <= evt_tstop)
+   {
+      dmKeyWrite_d(bb, HPE_EVTTSTRT_KEY, evt_tstart, "s",
+                   "time of earliest event");
+      dmKeyWrite_d(bb, HPE_EVTTSTOP_KEY, evt_tstop, "s",
+                   "time of latest event");
+   }
+
+   dmKeyWrite_l(bb, HPE_NEVTIN_KEY, stat_p->total_events_in, NULL,
+                "events in");
+   dmKeyWrite_l(bb, HPE_NEVTOUT_KEY, stat_p->total_events_out, NULL,
+                "events out");
+   dmKeyWrite_l(bb, HPE_NFILEIN_KEY, stat_p->num_files_in, NULL,
+                "input files");
+   dmKeyWrite_l(bb, HPE_NBADFILE_KEY, stat_p->num_bad_files, NULL,
+                "bad input files");
+   dmKeyWrite_l(bb, HPE_NBADGRID_KEY, stat_p->bad_grid_ratio, NULL,
+                "events with bad grid ratio");
+   dmKeyWrite_l(bb, HPE_NBADPHA_KEY, stat_p->bad_pha_ratio, NULL,
+                "events with bad pha ratio");
+   dmKeyWrite_l(bb, HPE_NBADU_KEY, stat_p->bad_dist[HDET_PLANE_X], NULL,
+                "events with bad u distance");
+   dmKeyWrite_l(bb, HPE_NBADV_KEY, stat_p->bad_dist[HDET_PLANE_Y], NULL,
+                "events with bad v distance");
+   dmKeyWrite_l(bb, HPE_NBADBOT_KEY, stat_p->bad_bot, NULL,
+                "events with bad denominator");
+   dmKeyWrite_l(bb, HPE_NFIXMFIN_KEY, stat_p->fixed_mfinpos, NULL,
+                "negative spillovers fixed");
+   dmKeyWrite_l(bb, HPE_NFIXPFIN_KEY, stat_p->fixed_pfinpos, NULL,
+                "positive spillovers fixed");
+   dmKeyWrite_l(bb, HPE_NSEQERR_KEY, stat_p->sequence_err, NULL,
+                "out of sequence events");
+} /* end: hpe_write_shard_keys */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_read_shard_keys() reads the keys written by
+  hpe_write_shard_keys(). FALSE is returned if the file has no ROWSTART
+  key (it was not made from a row range). If the file has no events, the
+  time range is returned as DBL_MAX, -DBL_MAX.
+
+*************************************************************************/
+
+boolean hpe_read_shard_keys(
+   dmBlock*       bb,           /* I - events block                   */
+   long*          rowstart_p,   /* O - first input row processed      */
+   long*          rowstop_p,    /* O - last input row (0 = last row)  */
+   double*        evt_tstart_p, /* O - time of earliest event         */
+   double*        evt_tstop_p,  /* O - time of latest event           */
+   STATISTICS_P_T stat_p)       /* O - event statistics               */
+{
+   boolean found = FALSE;
+
+   memset(stat_p, 0, sizeof(STATISTICS_T));
+   *rowstart_p = 1;
+   *rowstop_p = 0;
+   *evt_tstart_p = DBL_MAX;
+   *evt_tstop_p = -DBL_MAX;
+
+   if (dmKeyRead_l(bb, HPE_ROWSTART_KEY, rowstart_p) != NULL)
+   {
+      found = TRUE;
+
+      dmKeyRead_l(bb, HPE_ROWSTOP_KEY, rowstop_p);
+
+      if ((dmKeyRead_d(bb, HPE_EVTTSTRT_KEY, evt_tstart_p) == NULL) ||
+          (dmKeyRead_d(bb, HPE_EVTTSTOP_KEY, evt_tstop_p) == NULL))
+      {
+         *evt_tstart_p = DBL_MAX;
+         *evt_tstop_p = -DBL_MAX;
+      }
+
+      dmKeyRead_l(bb, HPE_NEVTIN_KEY, &stat_p->total_events_in);
+      dmKeyRead_l(bb, HPE_NEVTOUT_KEY, &stat_p->total_events_out);
+      dmKeyRead_l(bb, HPE_NFILEIN_KEY, &stat_p->num_files_in);
+      dmKeyRead_l(bb, HPE_NBADFILE_KEY, &stat_p->num_bad_files);
+      dmKeyRead_l(bb, HPE_NBADGRID_KEY, &stat_p->bad_grid_ratio);
+      dmKeyRead_l(bb, HPE_NBADPHA_KEY, &stat_p->bad_pha_ratio);
+      dmKeyRead_l(bb, HPE_NBADU_KEY, &stat_p->bad_dist[HDET_PLANE_X]);
+      dmKeyRead_l(bb, HPE_NBADV_KEY, &stat_p->bad_dist[HDET_PLANE_Y]);
+      dmKeyRead_l(bb, HPE_NBADBOT_KEY, &stat_p->bad_bot);
+      dmKeyRead_l(bb, HPE_NFIXMFIN_KEY, &stat_p->fixed_mfinpos);
+      dmKeyRead_l(bb, HPE_NFIXPFIN_KEY, &stat_p->fixed_pfinpos);
+      dmKeyRead_l(bb, HPE_NSEQERR_KEY, &stat_p->sequence_err);
+   }
+
+   return (found);
+} /* end: hpe_read_shard_keys */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_write_file_keys() writes the range of input stack files
+  processed by a worker process to the header of its event file.
+
+*************************************************************************/
+
+void hpe_write_file_keys(
+   dmBlock* bb,               /* I - events block                     */
+   long     filestart,        /* I - first stack file processed       */
+   long     filestop)         /* I - last stack file processed        */
+{
+   dmKeyWrite_l(bb, HPE_FILESTRT_KEY, filestart, NULL,
+                "first input stack file processed");
+   dmKeyWrite_l(bb, HPE_FILESTOP_KEY, filestop, NULL,
+                "last input stack file processed");
+} /* end: hpe_write_file_keys */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_read_file_keys() reads the keys written by
+  hpe_write_file_keys(). FALSE is returned, and the range set to 0, 0,
+  if the file has no FILESTRT key (it was not written by a worker).
+
+*************************************************************************/
+
+boolean hpe_read_file_keys(
+   dmBlock* bb,               /* I - events block                     */
+   long*    filestart_p,      /* O - first stack file processed       */
+   long*    filestop_p)       /* O - last stack file processed        */
+{
+   *filestart_p = 0;
+   *filestop_p = 0;
+
+   if (dmKeyRead_l(bb, HPE_FILESTRT_KEY, filestart_p) == NULL)
+   {
+      *filestart_p = 0;
+      return (FALSE);
+   }
+   dmKeyRead_l(bb, HPE_FILESTOP_KEY, filestop_p);
+
+   return (TRUE);
+} /* end: hpe_read_file_keys */
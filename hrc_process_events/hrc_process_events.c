@@ -127,12 +127,74 @@ Notes on outCol PI (use OLD_SI_GAIN to set different output range ):
     for new hrcI gain image :    maxPI=1023   dtype=short !
 
 5/2010 - write out ASPTYPE when infile has 0 row.
+10/2026 - read the input events in blocks of HDET_BLOCK_ROWS rows
+          (load_event_block) instead of advancing with dmTableNextRow.
+10/2026 - move the body of the event loop to event_batch_functions.c;
+          add the batch parameter to process a block of events stage 
+          by stage (batch=yes) or one event at a time (batch=no).
+10/2026 - add the nthreads parameter to share the stages of a batch
+          out between worker threads.
+10/2026 - number the input files and rows for the counter based pixel
+          randomization (rand_gen).
+10/2026 - add the rowstart/rowstop parameters to process part of each
+          input file; the statistics of a partial output are written
+          to its header (hpe_write_shard_keys).
+10/2026 - keep a per chip tiled bitmap index of the hot spots for
+          check_for_bad_pixels().
+10/2026 - the hot spots of each chip are held in a sorted array.
+10/2026 - free the hrcS gain lookup tables.
+10/2026 - time the processing stages of each input file and of the run
+          (verbose > 0 or timingfile set).
+10/2026 - the output rows are buffered; flush them at the end of each
+          input file.
+10/2026 - add the writequeue parameter to write the output rows with a
+          writer thread; its rows are written before each new input file
+          and before the output header keys.
+10/2026 - add the prefetch parameter to open the next input file of the
+          stack (and read its first block) while a file is processed.
+10/2026 - add the nprocs parameter to share the stack files out between
+          worker processes (start_file_workers); each worker processes
+          its range of files into a partial output, merged by the parent
+          (end_file_workers).
+10/2026 - add the fastread parameter to decode the input blocks of plain
+          FITS files from a memory map (fits_map_functions.c).
+10/2026 - read only the input fields used by the stages or listed in the
+          output eventdefs (set_input_projection).
+10/2026 - add the tmin/tmax/gtifile parameters to process only the rows
+          of each input file within a time window (find_time_window).
+10/2026 - the tap ring correction is applied to a range of events at a
+          time; add the fastmath parameter (hpe_fast_math.c).
+10/2026 - resolve the alignment and aspect once per event time
+          (hpe_resolve_aspect); log the number of updates.
+10/2026 - add the fastsky parameter to compute sky positions with one
+          transform per aspect record (hpe_tan_xform.c).
+10/2026 - add the aspstore parameter to read the aspect stack into
+          memory before the events (hpe_aspect_store.c).
+10/2026 - add the fastchip/chipcheck parameters to take events from chip
+          to fpc/tdet with per chip transforms fitted to pixlib
+          (hpe_chip_xform.c).
+10/2026 - pack the ADC coefficients and tap ranges into one record per
+          tap of each axis (hpe_tap_cal.c).
+10/2026 - hold the datamodel lock while the stack of files is processed,
+          so the writer thread only writes while no datamodel call is made.
+10/2026 - without an alignment file, resolve the alignment and aspect
+          once per aspect record instead of once per event time.
+10/2026 - skip the events of the time window rows whose TIME is outside
+          the window (outside_time_window).
+10/2026 - with worker processes, set up the calibration from the first
+          stack file before the workers are started.
 *H***********************************************************************/
 
+#include <unistd.h>
+
 #ifndef HRC_PROCESS_EVENTS_H
 #include "hrc_process_events.h"
 #endif 
 
+#ifndef HPE_MERGE_DEFS_H
+#include "hpe_merge_defs.h"
+#endif
+
 #ifndef L1_ASPECT_DEFS_H
 #include "l1_aspect_defs.h"
 #define L1_ASPECT_DEFS_H
@@ -148,6 +210,10 @@ Notes on outCol PI (use OLD_SI_GAIN to set different output range ):
 #define DS_HRC_CONFIG_H
 #endif
 
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
 dsErrCode hrc_process_events(void)
 {
     /* CL INPUT PARAMETERS */ 
@@ -181,12 +247,10 @@ dsErrCode hrc_process_events(void)
     /* BAD EVENT FILE VARIABLES */ 
     EVENT_SETUP_T evt_bout;     /* output bad event file information       */
     EVENT_SETUP_P_T evtbout_p = &evt_bout; /* pointer to bad event file    */
-    boolean setup_badfile = TRUE; /* T= bad event file has not been created*/
 
     /* STATISTICS/LOGFILE VARIABLES */
     STATISTICS_T stat;          /* struct to keep track of event statistics*/
     STATISTICS_P_T stat_p = &stat;/* pointer to statistics structure       */
-    long      bad_interval = 0; /* keep track of # consecutive bad times   */ 
     register int     debug;     /* register reference to debug param value */ 
     FILE            *log_ptr;   /* L - pointer to logfile                  */ 
 
@@ -194,6 +258,7 @@ dsErrCode hrc_process_events(void)
     DEGAP_CONFIG_P_T dgp_p = NULL;    /* degap table structure             */
     ADC_CORR_P_T adc_x = NULL;  /* pointer to x axis adc correction table  */
     ADC_CORR_P_T adc_y = NULL;  /* pointer to y axis adc correction table  */
+    HPE_TAP_CAL_TABLE_P_T tapcal_p = NULL; /* tap calibration records    */
 
     /* GAIN CORRECTION VARIABLES */
     float*      gain_p = NULL;  /* for old 2dim gain map image */
@@ -201,14 +266,13 @@ dsErrCode hrc_process_events(void)
     EVENT_REC_P_T evt_p = &evt; /* pointer to the event structure          */
     INST_KEYWORDS_T inst;       /*  instrument keyword data structure      */
     INST_KEYWORDS_P_T inst_p = &inst; /* instrument keyword structure pntr */
-    double    last_time = -1.0; /* to keep track of out of sequence events */
-    BAD_PIX_A_T  hotpix_p = {NULL, NULL, NULL}; /* hot spot (bad pixel) lists*/
+    BAD_PIX_A_T  hotpix_p = {{NULL, 0}}; /* hot spot (bad pixel) arrays   */
+    BAD_PIX_INDEX_T hotidx_p = {{0}}; /* hot spot (bad pixel) chip index   */
     char*     evtfile = NULL;   /* pointer to store input file name        */
     dsErrCode erR = dsNOERR;    /* return error status for this routine    */
     dsErrList* hpe_err_p = NULL; /* pointer to list of errors/warnings     */
 
     char** e_names;   /*eventdef's col names */
-    char** b_names;   /*bad event's col names */
 
     /* ADC FILTERING VARIABLES */
     double *flat_test_coeffs_p = NULL;
@@ -220,16 +284,25 @@ dsErrCode hrc_process_events(void)
     /* amp_sf_correction   */ 
     AMPSFCOR_COEFF_P_T ampsfcor_coeff = NULL ;
 
+    /* EVENT PROCESSING VARIABLES */
+    HPE_PIPELINE_T   pipeline;  /* calibration data and state for events  */
+    HPE_PIPELINE_P_T pln_p = &pipeline; /* pointer to event pipeline      */
+    EVENT_BATCH_P_T  bat_p = NULL; /* batch of events (batch=yes)         */
+    HPE_FILE_WORKERS_P_T workers_p = NULL; /* worker processes (nprocs>1)*/
+    boolean calibrated = FALSE; /* T= calibration set up before workers */
+
     /* initialize error list */ 
     dsErrCreateList(&hpe_err_p);
 
     /* initialize data structures */
     memset(evtout_p, 0, sizeof(EVENT_SETUP_T));
+    memset(evtbout_p, 0, sizeof(EVENT_SETUP_T));
     memset(aln_p, 0, sizeof(ALIGNMENT_REC_T)); 
     memset(aln_hk_p, 0, sizeof(ALIGNMENT_INFRA_T)); 
     memset(asp_p, 0, sizeof(ASPECT_ENTRY_T)); 
     memset(asp_hk_p, 0, sizeof(ASPECT_INFRA_T)); 
     memset(stat_p, 0, sizeof(STATISTICS_T));
+    memset(pln_p, 0, sizeof(HPE_PIPELINE_T));
 
     /* load input parameters from 'hrc_process_events.par' */ 
     /* (4/2003)-intialized variables for inp_p */
@@ -343,6 +416,17 @@ dsErrCode hrc_process_events(void)
        }
     }
 
+    /* (10/2026) read the aspect stack into memory (aspstore) */
+    if (inp_p->aspstore && (hpe_err_p->contains_fatal == 0))
+    {
+       pln_p->asp_store_p = load_aspect_store(asp_hk_p, hpe_err_p);
+    }
+
+    /* (10/2026) without an alignment file, the alignment/aspect are the
+     * same for every event time up to that of the aspect record */
+    pln_p->aspect_seg.spans = (align_file_p == NULL);
+    pln_p->aspect_seg.asp_stop = -DBL_MAX;
+
 
     if (debug > DEBUG_LEVEL_0)
     {
@@ -368,6 +452,16 @@ dsErrCode hrc_process_events(void)
              "ERROR: The coordinate transformation starting point must be either coarse, chip, or tdet.");  
        }
     }
+
+    /* (10/2026) read only the input fields the run uses */
+    set_input_projection(inp_p);
+
+    /* (10/2026) and only the events of the time window, if any */
+    if (hpe_err_p->contains_fatal == 0)
+    {
+       load_time_window(inp_p, hpe_err_p);
+    }
+
     /********************************************************************
      * (8/2002) - perform amp_sf corrections
      ********************************************************************/
@@ -404,6 +498,124 @@ dsErrCode hrc_process_events(void)
     open_evt_flatness_file(inp_p->ampflatfile, &flat_test_coeffs_p, hpe_err_p);
     open_hyperbolic_file(inp_p->hypfile, &hyp_test_coeffs_p, hpe_err_p);
 
+    /* (10/2026) with worker processes, set up the calibration from the
+     * header of the first stack file, as a single process run does, so
+     * it is read once; the workers are then started and carry on below,
+     * the parent waits and merges their outputs */
+    if ((inp_p->nprocs > 1) && (num_evtfile > 1) &&
+        (hpe_err_p->contains_fatal == 0))
+    {
+       EVENT_SETUP_T evt_first;  /* first input file of the stack      */
+       STATISTICS_T  stat_first; /* its counts (kept by the workers)   */
+
+       memset(&evt_first, 0, sizeof(EVENT_SETUP_T));
+       memset(&stat_first, 0, sizeof(STATISTICS_T));
+       evtstack = stk_build(inp_p->stack_in);
+       evt_first.file = stk_read_num(evtstack, 1);
+       evt_first.read_field = inp_p->read_field;
+       stk_close(evtstack);
+
+       hrc_process_setup_input_file(&evt_first, inp_p, &stat_first,
+                                    hpe_err_p);
+       hrc_process_set_instrume(inp_p, hpe_err_p);
+       aln_hk_p->processing = (inp_p->processing == HRC_PROC_FLIGHT) ?
+                              ALN_FLIGHT_DATA : ALN_XRCF_DATA;
+
+       if (hpe_err_p->contains_fatal == 0)
+       {
+          hrc_process_configure_pixlib(&evt_first, inp_p, inst_p, aln_p,
+                                       hpe_err_p);
+       }
+       if (hpe_err_p->contains_fatal == 0)
+       {
+          if (inp_p->fastchip)
+          {
+             setup_chip_xforms(&pln_p->chip_xform, inp_p, aln_p);
+          }
+          load_gain_image(inp_p->gain_file, inp_p, &gain_p, hpe_err_p);
+          hpe_setup_degap_file(inp_p, &dgp_p, hpe_err_p);
+          if (inp_p->do_ADC)
+          {
+             if (!allocate_adc_table(inp_p, &adc_x, &adc_y, hpe_err_p))
+             {
+                adc_table_load(inp_p, adc_x, adc_y, hpe_err_p);
+             }
+          }
+          if ((dgp_p != NULL) && (hpe_err_p->contains_fatal == 0))
+          {
+             tapcal_p = allocate_tap_cal_table(inp_p, adc_x, adc_y, dgp_p,
+                                               hpe_err_p);
+          }
+          calibrated = TRUE;
+       }
+       hrc_process_evt_file_cleanup(&evt_first);
+       free(evt_first.file);
+
+       if (hpe_err_p->contains_fatal == 0)
+       {
+          workers_p = start_file_workers(inp_p, num_evtfile, hpe_err_p);
+       }
+       if ((workers_p != NULL) || (hpe_err_p->contains_fatal != 0))
+       {
+          end_file_workers(&workers_p, inp_p, hpe_err_p);
+          erR = hpePrintErr( hpe_err_p, log_ptr, inp_p->debug);
+          if ((debug > DEBUG_LEVEL_0) && (log_ptr != NULL))
+          {
+             fclose(log_ptr); 
+          } 
+          return (erR);
+       }
+    }
+
+    /* (10/2026) event pipeline state kept across the input files */
+    pln_p->inp_p = inp_p;
+    pln_p->stat_p = stat_p;
+    pln_p->log_ptr = log_ptr;
+    pln_p->debug = debug;
+    pln_p->err_p = hpe_err_p;
+    pln_p->evtout_p = evtout_p;
+    pln_p->evtbout_p = evtbout_p;
+    pln_p->setup_badfile = TRUE; /* T= bad event file has not been created*/
+    pln_p->aln_p = aln_p;
+    pln_p->aln_hk_p = aln_hk_p;
+    pln_p->asp_p = asp_p;
+    pln_p->asp_hk_p = asp_hk_p;
+    pln_p->hotpix_p = hotpix_p;
+    pln_p->hotidx_p = hotidx_p;
+    pln_p->ampsfcor_coeff = ampsfcor_coeff;
+    pln_p->tring_coeffs_p = tring_coeffs_p;
+    pln_p->hyp_test_coeffs_p = hyp_test_coeffs_p;
+    pln_p->sat_test_coeffs_p = sat_test_coeffs_p;
+    pln_p->flat_test_coeffs_p = flat_test_coeffs_p;
+    pln_p->last_time = -1.0;    /* to keep track of out of sequence events */
+    pln_p->bad_interval = 0;    /* keep track of # consecutive bad times   */
+
+    /* (10/2026) worker threads for the batch stages (nthreads > 1) */
+    if (inp_p->batch && (inp_p->nthreads > 1) && 
+        (hpe_err_p->contains_fatal == 0))
+    {
+       pln_p->threads_p = allocate_event_threads(inp_p->nthreads, hpe_err_p);
+    }
+
+    /* (10/2026) stage timers for the logfile and/or the timing file */
+    if (((debug > DEBUG_LEVEL_0) ||
+         ((ds_strcmp_cis(inp_p->timingfile, "none") != 0) &&
+          (strcmp(inp_p->timingfile, "\0") != 0))) &&
+        (hpe_err_p->contains_fatal == 0))
+    {
+       pln_p->timers_p = allocate_stage_timers(inp_p->timingfile, hpe_err_p);
+    }
+
+    /* (10/2026) open the next input file in the background */
+    if (inp_p->prefetch && (hpe_err_p->contains_fatal == 0))
+    {
+       pln_p->prefetch_p = allocate_input_prefetch(inp_p, hpe_err_p);
+    }
+
+    /* (10/2026) the datamodel lock is held while the files are processed
+     * (see event_writer_functions.c) */
+    lock_datamodel();
+
     /********************************************************************
      * start going through stack of infile          
      ********************************************************************/
@@ -414,13 +626,49 @@ dsErrCode hrc_process_events(void)
        EVENT_SETUP_T evt_in;   /* input event file information */
        EVENT_SETUP_P_T evtin_p = &evt_in;
        long        row_check = dmSUCCESS;
+       long        first_row = 1;      /* first row of the file processed */
+       EVENT_BLOCK_P_T evt_blk_p = NULL; /* block of input event rows */
        char  *tmp=NULL ;
 
+       memset(evtin_p, 0, sizeof(EVENT_SETUP_T));
        evtin_p->file = evtfile; 
+       evtin_p->fastread = (inp_p->fastread && inp_p->batch);
+       evtin_p->read_field = inp_p->read_field;
+       inp_p->file_num++;    /* (10/2026) randomization counter */
+
+       /* (10/2026) a worker process only reads its range of files */
+       if ((inp_p->filestop > 0) && (inp_p->file_num > inp_p->filestop))
+       {
+          free(evtfile);
+          evtfile = NULL;
+          break;
+       }
+       if (inp_p->file_num < inp_p->filestart)
+       {
+          free(evtfile);
+          evtfile = NULL;
+          continue;
+       }
+       start_file_timers(pln_p->timers_p, stat_p);
+
+       /* (10/2026) update the alignment/aspect at the first event and
+        * set up the sky transform for the nominal pointing of the file */
+       pln_p->aspect_seg.valid = FALSE;
+       pln_p->tan_xform.set = FALSE;
 
-       /* open input file */
+       /* open input file- (10/2026) unless the prefetch thread did */
+       take_input_prefetch(pln_p->prefetch_p, evtin_p, &evt_blk_p);
        hrc_process_setup_input_file(evtin_p, inp_p, stat_p, hpe_err_p);
 
+       /* (10/2026) open the next input file while this one is processed */
+       if ((pln_p->prefetch_p != NULL) &&
+           (inp_p->file_num < stk_count(evtstack)) &&
+           ((inp_p->filestop == 0) || (inp_p->file_num < inp_p->filestop)))
+       {
+          start_input_prefetch(pln_p->prefetch_p,
+                               stk_read_num(evtstack, inp_p->file_num + 1));
+       }
+
        /* set up instrument specific info */
        hrc_process_set_instrume(inp_p, hpe_err_p);
 
@@ -438,12 +686,22 @@ dsErrCode hrc_process_events(void)
           evtout_p->file = inp_p->outfile; 
           evtout_p->eventdef = inp_p->outcols; 
 
-          hrc_process_configure_pixlib(evtin_p, inp_p, inst_p, aln_p, 
-                                       hpe_err_p);
-          if (hpe_err_p->contains_fatal!=0) break;
+          /* (10/2026) unless set up before the workers were started */
+          if (!calibrated)
+          {
+             hrc_process_configure_pixlib(evtin_p, inp_p, inst_p, aln_p, 
+                                          hpe_err_p);
+             if (hpe_err_p->contains_fatal!=0) break;
 
-          /*(10/2009)-set up gain file. return 3 values of gainflag */
-          load_gain_image(inp_p->gain_file, inp_p, &gain_p, hpe_err_p); 
+             /* (10/2026) fit the per chip transforms to pixlib (fastchip) */
+             if (inp_p->fastchip)
+             {
+                setup_chip_xforms(&pln_p->chip_xform, inp_p, aln_p);
+             }
+
+             /*(10/2009)-set up gain file. return 3 values of gainflag */
+             load_gain_image(inp_p->gain_file, inp_p, &gain_p, hpe_err_p); 
+          }
 
           /*(10/2009)outCol PI will depend on inp_p->gainflag */
           hrc_process_setup_output_file(evtin_p, evtout_p, inp_p,  
@@ -455,14 +713,24 @@ dsErrCode hrc_process_events(void)
           /* write instrument parameters as output header keywords */
           write_instrume_params(evtout_p->extension, inst_p);
 
-          /* setup degap tables */
-          hpe_setup_degap_file(inp_p, &dgp_p, hpe_err_p);
-
-          if (inp_p->do_ADC)
+          if (!calibrated)
           {
-             if (!allocate_adc_table(inp_p, &adc_x, &adc_y, hpe_err_p))
+             /* setup degap tables */
+             hpe_setup_degap_file(inp_p, &dgp_p, hpe_err_p);
+
+             if (inp_p->do_ADC)
              {
-                adc_table_load(inp_p, adc_x, adc_y, hpe_err_p);
+                if (!allocate_adc_table(inp_p, &adc_x, &adc_y, hpe_err_p))
+                {
+                   adc_table_load(inp_p, adc_x, adc_y, hpe_err_p);
+                }
+             }
+
+             /* (10/2026) one record per tap of the ADC and degap tables */
+             if ((dgp_p != NULL) && (hpe_err_p->contains_fatal == 0))
+             {
+                tapcal_p = allocate_tap_cal_table(inp_p, adc_x, adc_y,
+                                                  dgp_p, hpe_err_p);
              }
           }
 
@@ -483,8 +751,17 @@ dsErrCode hrc_process_events(void)
              }
           }
 
+          /* (10/2026) write the output rows with a writer thread */
+          if ((inp_p->writequeue > 0) && (hpe_err_p->contains_fatal == 0))
+          {
+             pln_p->writer_p = allocate_event_writer(inp_p->writequeue,
+                                                     hpe_err_p);
+             attach_event_writer(pln_p->writer_p, evtout_p, hpe_err_p);
+          }
+
           /* set up hot pixel list- set do_raw flag if hot pixel list exists */
-          if (load_bad_pixel_files(inp_p->badpixfile, &hotpix_p[0]) != 0)
+          if (load_bad_pixel_files(inp_p->badpixfile, hotpix_p,
+                                   hotidx_p) != 0)
           {
              inp_p->do_raw = TRUE; 
           } 
@@ -497,16 +774,16 @@ dsErrCode hrc_process_events(void)
 
           if (debug > DEBUG_LEVEL_4)
           {
-             BAD_PIX_P_T hotspot_p = hotpix_p[0];
+             BAD_PIX_P_T hotspot_p = hotpix_p[0].pix;
+             long        hh;
            
              fprintf(log_ptr, " HOT SPOTS (BAD PIXELS)\n");  
-             while (hotspot_p != NULL)
+             for (hh = 0; hh < hotpix_p[0].num_pix; hh++, hotspot_p++)
              {
                 fprintf(log_ptr, 
                    "        (%4ld, %4ld) to (%4ld, %4ld)\n", 
                    hotspot_p->x[0], hotspot_p->y[0], 
                    hotspot_p->x[1], hotspot_p->y[1]); 
-                hotspot_p = hotspot_p->next; 
              } 
              fprintf(log_ptr, "\n\n");  
           }
@@ -553,230 +830,128 @@ dsErrCode hrc_process_events(void)
              fprintf(log_ptr, "\n"); 
           }
 
-          /*******************************************************/
-          /* only loop if 1 or more rows in the input event file */
-          /*******************************************************/
-          if (dmTableGetRowNo(evtin_p->extension) != dmBADROW)
-{
-          row_check = dmTableSetRow(evtin_p->extension, 1); /*(8/2003)*/
-          while ((row_check != dmNOMOREROWS) &&      /* while(evt_next_row)*/
-                 (hpe_err_p->contains_fatal == 0)) 
+          /* calibration data is set up with the first input file */
+          pln_p->evtin_p = evtin_p;
+          pln_p->dgp_p = dgp_p;
+          pln_p->adc_x = adc_x;
+          pln_p->adc_y = adc_y;
+          pln_p->tapcal_p = tapcal_p;
+          pln_p->gain_p = gain_p;
+
+          /* (10/2026) only rows rowstart to rowstop are processed */
+          evtin_p->num_rows = dmTableGetNoRows(evtin_p->extension);
+          if ((inp_p->rowstop > 0) && (inp_p->rowstop < evtin_p->num_rows))
           {
-             /* initialize event record structure */
-             memset(evt_p, 0, sizeof(EVENT_REC_T));
-
-             evt_p->time = inp_p->default_time; 
-
-             /*************************************
-              * load data into event record 
-              *************************************/
-             load_event_data(evtin_p, evt_p);
-             initial_status(inp_p, evt_p);
-
-             /*************************************
-              * (8/2002) - amp_sf corrections
-              *************************************/
-             if (( inp_p->do_amp_sf_cor == TRUE) &&
-                 ( inp_p->get_range_switch_level == TRUE) &&
-                 ( inp_p->match_range_switch_level == TRUE)  )
-             {
-                apply_amp_sf_cor(evt_p, ampsfcor_coeff) ;
-             }
+             evtin_p->num_rows = inp_p->rowstop;
+          }
 
-             /*********************************************************
-              * JCC(5/1/00) -
-              *   check_tap_ring  computes the corrected A3 and stored in 
-              *   evt_p->amps_dd[u:v_axes][3]. The new A3 will be used to 
-              *   compute the fine coordinates and for other tests.
-              *   
-              *   The fine coordinates will be computed in the existing 
-              *   function calculate_coords_hrc. 
-              *********************************************************/
-             if (tring_coeffs_p != NULL)
-                 check_tap_ring(inp_p, evt_p, tring_coeffs_p );
-
-             /* keep track of earliest and latest event times */
-             if (evt_p->time < inp_p->evt_tstart)
-             {
-                inp_p->evt_tstart = evt_p->time;
-             }
-             else if (evt_p->time > inp_p->evt_tstop)
-             {
-                inp_p->evt_tstop = evt_p->time;
-             }
+          /* (10/2026) and of those, the rows of the time window */
+          first_row = inp_p->rowstart;
+          if (inp_p->time_window &&
+              (dmTableGetRowNo(evtin_p->extension) != dmBADROW))
+          {
+             find_time_window(evtin_p, inp_p->tmin, inp_p->tmax, &first_row);
 
-             /* if HRC-i flight data extra bit should be removed */
-             if ((evt_p->cp[HDET_PLANE_Y] >= 64) &&
-                 (inp_p->hrc_system == HRC_IMG_SYS))
+             if (debug > DEBUG_LEVEL_0)
              {
-                evt_p->cp[HDET_PLANE_Y] -= 64;
+                fprintf(log_ptr, "TIME window rows %ld to %ld of %s\n",
+                        first_row, (long) evtin_p->num_rows, evtin_p->file);
              }
+          }
 
-             if (inp_p->do_ADC)
+          /*******************************************************/
+          /* only loop if 1 or more rows in the input event file */
+          /*******************************************************/
+          if ((dmTableGetRowNo(evtin_p->extension) == dmBADROW) ||
+              (first_row > evtin_p->num_rows))
+          {
+             /* empty input file (or row range)- nothing to process */
+          }
+          else if (inp_p->batch)
+          {
+             /* (10/2026) read the input columns a block of rows at a   */
+             /* time and run each processing stage over the block       */
+             if (evt_blk_p == NULL)
              {
-                apply_adc_correction(adc_x, adc_y, inp_p, evt_p); 
+                evt_blk_p = allocate_event_block(evtin_p, HDET_BLOCK_ROWS,
+                                                 hpe_err_p);
              }
-
-             /********************************************************
-	      * perform ADC filtering tests, if ARDs were provided.
-              * hyperbolic test :
-              ********************************************************/
-	     if (hyp_test_coeffs_p != NULL)
-	     {
-	        check_hyperbolic(evt_p, hyp_test_coeffs_p);
-	     }
-
-             /*---------------------
-	      * saturation tests
-              *--------------------*/
-	     if (sat_test_coeffs_p != NULL)
-	     {
-	        check_amp_saturation(evt_p, sat_test_coeffs_p);
-	     }
-
-	     if (flat_test_coeffs_p != NULL)
-	     {
-	        check_evt_flatness(evt_p, *flat_test_coeffs_p);
-	     }
-
-             if (evt_p->time < last_time)
+             if (bat_p == NULL)
              {
-                dsErrAdd(hpe_err_p, dsHPEEVENTSEQERR, Accumulation, Generic,
-                   evtin_p->file);
-                evt_p->status |= HDET_SEQUENCE_STS; 
-                stat_p->sequence_err++; 
-                bad_interval++; 
+                bat_p = allocate_event_batch(HDET_BLOCK_ROWS, hpe_err_p);
              }
-             else
-             {
-                if ((debug > DEBUG_LEVEL_3) && (bad_interval != 0))
-                {
-                   fprintf(log_ptr, 
-                      "%3ld bad events occurred between time %8f and %8f\n",
-                      bad_interval, last_time, evt_p->time); 
-                   bad_interval = 0; 
-                } 
-                last_time = evt_p->time; 
-             } 
-
-             /* add time offset to event time for alignment sequence */
-             evt_p->time += inp_p->time_offset;
-
-             if (alignment_update(aln_p, aln_hk_p, evt_p->time))
+             row_check = first_row;
+             while ((row_check <= evtin_p->num_rows) &&
+                    (evt_blk_p != NULL) && (bat_p != NULL) &&
+                    (hpe_err_p->contains_fatal == 0))
              {
-                dsErrAdd(hpe_err_p, dsHPEALIGNMENTERR, Individual, Generic); 
-             }  
+                double tt = start_stage_timer(pln_p->timers_p);
 
-             /* remove time offset added to event time for alignment sequence*/
-             evt_p->time -= inp_p->time_offset;
+                /* the first block may have been read by the prefetch */
+                if (((evt_blk_p->first_row != row_check) ||
+                     (evt_blk_p->num_rows == 0)) &&
+                    (load_event_block(evtin_p, evt_blk_p, row_check,
+                                      hpe_err_p) == 0))
+                {
+                   break;
+                }
+                load_event_batch(pln_p, evt_blk_p, bat_p);
+                lap_stage_timer(pln_p->timers_p, HPE_TIMER_LOAD, &tt);
 
-             if (aspect_update(asp_p, asp_hk_p, evt_p->time))
-             {
-                dsErrAdd(hpe_err_p, dsHPEASPECTERR, Individual, Generic); 
+                process_event_batch(pln_p, bat_p);
+                row_check += bat_p->num_rows;
              }
 
-             /* update statistical file counts */
-             stat_p->total_events_in++;
-
-             /* set next-in-line status bit if needed */
-             if (inp_p->next_in_line)
+             deallocate_event_block(&evt_blk_p);
+          }
+          else
+          {
+             /* original per-event loop (batch=no) */
+             pln_p->row = first_row;
+             row_check = dmTableSetRow(evtin_p->extension, 
+                                       first_row);           /*(8/2003)*/
+             while ((row_check != dmNOMOREROWS) &&   /* while(evt_next_row)*/
+                    (pln_p->row <= evtin_p->num_rows) &&
+                    (hpe_err_p->contains_fatal == 0))
              {
-                evt_p->status |= HDET_NEXT_IN_LINE_STS; 
-             }
+                double tt = start_stage_timer(pln_p->timers_p);
 
-             /*********************************************************
-              *   compute the fine coordinates
-              *********************************************************/
-             if (calculate_coords_hrc(evt_p, inp_p, stat_p, 
-                                      &asp_p->entry[asp_p->next],
-                                      dgp_p, asp_hk_p->asp_file_type,
-				      hpe_err_p))
-             {
-                /* reject event */ 
-                if (setup_badfile)
-                {
-                   evtbout_p->file = inp_p->badfile; 
-                   evtbout_p->eventdef = inp_p->badoutcols;
-                   hrc_process_setup_output_file(evtin_p, evtbout_p, 
-                                          inp_p, aln_p, &b_names, hpe_err_p);
-                   setup_badfile = FALSE; 
-                } 
-
-                /* update- add current event to bad event file */ 
-                write_hrc_events(evtbout_p, evt_p, hpe_err_p); 
-                dsErrAdd(hpe_err_p, dsHPEBADEVTFILEERR, Accumulation, Generic,
-                         evtbout_p->file); 
-             }      
-             else 
-             {
-                if (debug > DEBUG_LEVEL_4)
-                {
-                   fprintf(log_ptr, 
-                      "%9.4f   %3d %3d %4d %4d %4d %4d %4d %4d %5d\n",
-                      evt_p->time, evt_p->cp[HDET_PLANE_X], 
-                      evt_p->cp[HDET_PLANE_Y],
-                      evt_p->amps_sh[HDET_PLANE_X][HDET_1ST_AMP],
-                      evt_p->amps_sh[HDET_PLANE_X][HDET_2ND_AMP],
-                      evt_p->amps_sh[HDET_PLANE_X][HDET_3RD_AMP],
-                      evt_p->amps_sh[HDET_PLANE_Y][HDET_1ST_AMP],
-                      evt_p->amps_sh[HDET_PLANE_Y][HDET_2ND_AMP],
-                      evt_p->amps_sh[HDET_PLANE_Y][HDET_3RD_AMP], 
-                      evt_p->sum_amps);
-                }
+                /* initialize event record structure */
+                memset(evt_p, 0, sizeof(EVENT_REC_T));
 
-                if (debug > DEBUG_LEVEL_4 )
-                {
-                   printf(
-                      "%9.4f %6ld %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f\n",
-                      evt_p->time, row_check, 
-                      evt_p->amps_dd[HDET_PLANE_X][HDET_1ST_AMP],
-                      evt_p->amps_dd[HDET_PLANE_X][HDET_2ND_AMP],
-                      evt_p->amps_dd[HDET_PLANE_X][HDET_3RD_AMP],
-                      evt_p->amps_dd[HDET_PLANE_Y][HDET_1ST_AMP],
-                      evt_p->amps_dd[HDET_PLANE_Y][HDET_2ND_AMP],
-                      evt_p->amps_dd[HDET_PLANE_Y][HDET_3RD_AMP],
-                      evt_p->amp_tot[HDET_PLANE_X]);
-                }
+                evt_p->time = inp_p->default_time;
+                evt_p->row = pln_p->row;
 
-                /* use the gain map to calculate pi , or set pi=pha*/
-                if (inpars.do_pi)
-                {
-                   calculate_pi_hrc(gain_p, inp_p, evt_p);
-                }  
-                else                                /* 7/18/00 */
+                /*************************************
+                 * load data into event record
+                 *************************************/
+                load_event_data(evtin_p, NULL, 0, evt_p);
+                lap_stage_timer(pln_p->timers_p, HPE_TIMER_LOAD, &tt);
+
+                /* (10/2026) skip a row out of the time window */
+                if (!outside_time_window(inp_p, evt_p->time))
                 {
-                   evt_p->pi = evt_p->pha ;
-
-                  /*10/2009- see 'Notes on outCol PI' */
-                   long HDET_MAX_PI_VALUE =  HDET_MAX_PI_OLD ;   /* 255 */
-                   if (inp_p->gainflag != OLD_SI_GAIN )
-                      HDET_MAX_PI_VALUE = HDET_MAX_PI_NEW ;      /* 1023*/
-
-                   /* (6/25/01) - add */
-                   if (evt_p->pi > HDET_MAX_PI_VALUE)     /*255 or 1023*/
-                   {
-                      evt_p->status |= HDET_PI_VALUE_STS; /*flag if pi > max */
-                      evt_p->pi = HDET_MAX_PI_VALUE ; 
-                   }
-                   /* end: (6/25/01) */
+                   process_event(pln_p, evt_p);
                 }
 
-                /* set status bits of hot spots (bad pixels) */
-                check_for_bad_pixels(hotpix_p, evt_p); 
-
-                /* write data to output event file */
-                write_hrc_events(evtout_p, evt_p, hpe_err_p);
-
-                /* update statistical file counts */
-                stat_p->total_events_out++;
-             } /* end:  if (calculate_coords == TRUE) */ 
-             row_check = dmTableNextRow(evtin_p->extension);
-          } /* end:  while (evt_next_row)  */ 
-} /* end : if ( dmTableGetRowNo != dmBADROW ) */
+                row_check = dmTableNextRow(evtin_p->extension);
+                pln_p->row++;
+             } /* end:  while (evt_next_row)  */
+          } /* end : if ( dmTableGetRowNo != dmBADROW ) */
           /*******************************************************
            * end: loop thru all records of one infile
            *******************************************************/
 
+          /* (10/2026) write the output rows still buffered */
+          {
+             double tt = start_stage_timer(pln_p->timers_p);
+
+             flush_hrc_events(evtout_p);
+             flush_hrc_events(evtbout_p);
+             drain_event_writer(pln_p->writer_p);
+             lap_stage_timer(pln_p->timers_p, HPE_TIMER_WRITE, &tt);
+          }
+
           while ((rr< evtin_p->num_cols) && (!in_time_exists))
           {
              in_time_exists = (evtin_p->mapping[rr++] == HDET_TIME);
@@ -797,11 +972,14 @@ dsErrCode hrc_process_events(void)
        {
           stat_p->num_bad_files++;    
        } 
+
+       end_file_timers(pln_p->timers_p, evtin_p->file, stat_p, log_ptr, debug);
   
        if ((evtin_p->file != NULL) && (debug > DEBUG_LEVEL_0))
        {
           fprintf(log_ptr,"  close file: %s\n", evtin_p->file);
        }
+       deallocate_event_block(&evt_blk_p);
        hrc_process_evt_file_cleanup(evtin_p);
 
        if (evtfile != NULL)
@@ -826,13 +1004,54 @@ dsErrCode hrc_process_events(void)
 
     /* free up memory from adc correction tables */ 
     deallocate_adc_table(&adc_x, &adc_y);
+    deallocate_tap_cal_table(&tapcal_p);
+
+    /* free up memory for the event batch and stop the worker threads */
+    deallocate_event_batch(&bat_p);
+    deallocate_event_threads(&pln_p->threads_p);
+
+    if ((debug > DEBUG_LEVEL_0) && (pln_p->aspect_seg.num_events > 0))
+    {
+       fprintf(log_ptr, "\n ============ ASPECT SEGMENTS ===========\n");
+       fprintf(log_ptr, "EVENTS  resolved = %ld   alignment/aspect updates"
+               " = %ld   aspect records = %ld\n",
+               pln_p->aspect_seg.num_events, pln_p->aspect_seg.num_segments,
+               pln_p->aspect_seg.num_records);
+    }
+    if ((debug > DEBUG_LEVEL_0) && inp_p->fastsky)
+    {
+       fprintf(log_ptr, "SKY     transforms = %ld   left to dmTan = %ld\n",
+               pln_p->tan_xform.num_fits, pln_p->tan_xform.num_failed);
+    }
+    if ((debug > DEBUG_LEVEL_0) && inp_p->fastchip)
+    {
+       fprintf(log_ptr, "CHIP    transforms = %ld   left to pixlib = %ld"
+               "   positions = %ld   checked = %ld   mismatched = %ld\n",
+               pln_p->chip_xform.num_fits, pln_p->chip_xform.num_failed,
+               pln_p->chip_xform.num_applied, pln_p->chip_xform.num_checked,
+               pln_p->chip_xform.num_mismatch);
+    }
+    if ((debug > DEBUG_LEVEL_0) && (pln_p->asp_store_p != NULL))
+    {
+       fprintf(log_ptr, "ASPECT  records loaded = %ld from %d files"
+               "   records found = %ld\n", pln_p->asp_store_p->num_recs,
+               pln_p->asp_store_p->num_files, pln_p->aspect_seg.num_records);
+    }
+
+    /* (10/2026) close a file opened ahead but not processed */
+    deallocate_input_prefetch(&pln_p->prefetch_p, log_ptr, debug);
+
+    /* (10/2026) stop the writer thread before the header keys are written */
+    deallocate_event_writer(&pln_p->writer_p, log_ptr, debug);
+    unlock_datamodel();
 
     /* free up memory allocated for hot pixel list */
-    cleanup_bad_pixel_data(hotpix_p); 
+    cleanup_bad_pixel_data(hotpix_p, hotidx_p); 
 
     /* free memory for alignment/aspect files */
     close_alignment_file(aln_hk_p); 
     close_aspect_file(asp_hk_p); 
+    deallocate_aspect_store(&pln_p->asp_store_p);
     if (asp_hk_p->asp_type[0] != '\0')
     {
        dmKeyWrite_c(evtout_p->extension, ASP_TYPE_KEY,
@@ -861,6 +1080,9 @@ dsErrCode hrc_process_events(void)
        free(inp_p->timegridVal);
        free(inp_p->obs_tgain);
        free(inp_p->G_2nd);
+       free(inp_p->gainlutX);
+       free(inp_p->gainlutY);
+       free(inp_p->gainCell);
     }
 
     /* free memory for tap ring corrections */
@@ -889,12 +1111,31 @@ dsErrCode hrc_process_events(void)
        free(inp_p->old_sys);
     } 
 
+    /* (10/2026) record the statistics of a partial (row range or worker
+     * process) output */
+    if ((inp_p->rowstart > 1) || (inp_p->rowstop > 0) || (inp_p->worker > 0))
+    {
+       hpe_write_shard_keys(evtout_p->extension, inp_p->rowstart,
+                            inp_p->rowstop, inp_p->evt_tstart,
+                            inp_p->evt_tstop, stat_p);
+    }
+    if (inp_p->worker > 0)
+    {
+       hpe_write_file_keys(evtout_p->extension, inp_p->filestart,
+                           inp_p->filestop);
+       if (!pln_p->setup_badfile)
+       {
+          hpe_write_file_keys(evtbout_p->extension, inp_p->filestart,
+                              inp_p->filestop);
+       }
+    }
+
     /* close output file */
     hpe_set_ranges( evtout_p, inp_p, e_names ); 
     hrc_process_evt_file_cleanup(evtout_p); 
 
     /* if a bad event file was generated- do housekeeping */
-    if (!setup_badfile)
+    if (!pln_p->setup_badfile)
     {
        hrc_process_evt_file_cleanup(evtbout_p);
     } 
@@ -936,6 +1177,9 @@ dsErrCode hrc_process_events(void)
           stat_p->sequence_err); 
     }
 
+    /* (10/2026) stage times of the run, close the timing file */
+    deallocate_stage_timers(&pln_p->timers_p, stat_p, log_ptr, debug);
+
     erR = hpePrintErr( hpe_err_p, log_ptr, inp_p->debug);   /* 1/2009 */
 
     /* close up log file */
@@ -947,6 +1191,14 @@ dsErrCode hrc_process_events(void)
    if (inp_p->hcp->flg == INIT_OK ) 
       calClose(inp_p->hcp->myCaldb);
 
+    /* (10/2026) a worker process ends here; the parameter file is left
+     * to the parent */
+    if (inp_p->worker > 0)
+    {
+       fflush(NULL);
+       _exit((erR == dsNOERR) ? 0 : 1);
+    }
+
     return (erR);
 
 }
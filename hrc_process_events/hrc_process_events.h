@@ -155,6 +155,15 @@
 #define tgIdx(yi,ww)    ( (yi) + (ww)*RAWY_LEN )
 #define gmIdx(kk,xj,yi,RAWX_LEN) ((kk)+(xj)*ORDER_LEN+(yi)*ORDER_LEN*RAWX_LEN)
 #define g2Idx(xj,yi,RAWX_LEN)    ((xj)+(yi)*RAWX_LEN)
+
+/* 10/2026 - max # raw pixels of the rawxgrid/rawygrid lookup tables */
+#define GAIN_LUT_MAX  1048576
+
+/* 10/2026 - fused gain of a (xj,yi) cell: pi_double = offset + slope*DDn */
+typedef struct hpe_gain_cell_t {
+   double offset;   /* gainmap[0,xj,yi]  */
+   double slope;    /* G_2nd[xj,yi]      */
+} HPE_GAIN_CELL_T, *HPE_GAIN_CELL_P_T;
 /*----------- end:*/
 
 
@@ -231,6 +240,7 @@
 #define HDET_RAW               54  /* vector column- rawx,rawy          */ 
 
 /* #define HDET_NUM_COLS  55 */ /* total number of possible fields   */
+#define HDET_NUM_FIELDS        55  /* number of mapping codes above     */
 
 
 
@@ -351,6 +361,10 @@
 #define HDET_TAN_VAL      16 
 #define HDET_SKY_VAL      32 
  
+/* values of the rand_gen parameter (pixel randomization generator) */
+#define HPE_RAND_COUNTER  "counter"   /* keyed by seed, file and row     */
+#define HPE_RAND_PIXLIB   "pixlib"    /* pixlib sequential generator     */
+ 
 
 /*  the following macros define the ranges of various arrays used in the
  *  hrc_process_events code. They are meant to assist in the readability of 
@@ -689,16 +703,79 @@ double DDn;       /*10/2009 - to compute pi_double for dph hrcS gain table*/
    unsigned char veto_status;                 /* veto status (lab/hsi)   */
    unsigned char e_trig;                      /* trigger (flight)        */ 
    unsigned char det_id;                      /* 0 = imaging 1 = spect   */ 
+   long   row;       /* input row of the event (randomization counter) */
 
 } EVENT_REC_T, *EVENT_REC_P_T;
 
 
+/*  the following structures hold the write plan of an output event file.
+ *  For each output column, the plan has the routine which casts the event
+ *  record field found at 'offset' to the column type and stores it in the
+ *  row buffer of the column. The plan is compiled once per output file by
+ *  compile_write_plan() (see write_hrc_events.c), so write_hrc_events()
+ *  does not switch on the column mapping and data type of every column of
+ *  every row. When 'size' rows are buffered (or at the end of an input
+ *  file) flush_hrc_events() writes each column, or each component of a
+ *  vector column, with one dmSetScalars call; bit columns are written a
+ *  row at a time from their buffer.
+ *
+ *  WRITE PLAN STRUCTURES
+ */
+
+#define HPE_WCOL_NONE          0  /* nothing written for the column        */
+#define HPE_WCOL_SHORT         1  /* column buffered as short              */
+#define HPE_WCOL_LONG          2  /* column buffered as long               */
+#define HPE_WCOL_DOUBLE        3  /* column buffered as double (or float)  */
+#define HPE_WCOL_BIT           4  /* column buffered as bytes of bits      */
+
+/* casts a field (src) into row ii of a column buffer of 'size' rows */
+typedef void (*HPE_STORE_FN_T)(void*, long, long, const char*);
+
+typedef struct hpe_write_col_t {
+   HPE_STORE_FN_T store;     /* stores the field (NULL = unknown field)    */
+   dmDescriptor*  desc;      /* output column                              */
+   dmDescriptor*  cpt[HDET_NUM_PLANES]; /* components of a vector column   */
+   size_t         offset;    /* offset of the field in EVENT_REC_T         */
+   short          kind;      /* buffer type of the column (HPE_WCOL_*)     */
+   short          width;     /* values per row (2 = vector, 4 = 32 bits)   */
+} HPE_WRITE_COL_T, *HPE_WRITE_COL_P_T;
+
+typedef struct hpe_write_plan_t {
+   int               num_cols; /* number of output columns                 */
+   HPE_WRITE_COL_P_T col;      /* plan of each output column               */
+   void**            buf;      /* row buffer of each column being filled   */
+                               /* (vector: x rows then y rows)             */
+   long              size;     /* number of rows the buffers can hold      */
+   long              num_rows; /* number of rows currently buffered        */
+   long              next_row; /* table row of the first buffered row     */
+   struct hpe_writer_file_t* async_p; /* writer thread queue of the file   */
+                               /* (NULL = rows written by the caller)      */
+} HPE_WRITE_PLAN_T, *HPE_WRITE_PLAN_P_T;
+
+
 /*  The following structure is used by hrc_process_events to store information
  *  pertaining to event files (both input and output). The fields in this
  *  structure are populated via a call to setup_event_files().
  *
  *  EVENT FILE SETUP STRUCTURE
  */
+/*  the following structure holds the memory map of a plain FITS input
+ *  event file (fastread = yes) and where the values of each input column
+ *  component are found in a row (see fits_map_functions.c).
+ *
+ *  FITS MAP STRUCTURE
+ */
+typedef struct hpe_fits_map_t {
+   unsigned char* base;      /* start of the mapped file                   */
+   long          size;       /* length of the mapped file                  */
+   unsigned char* data;      /* first row of the event table               */
+   long          row_len;    /* row length in bytes (NAXIS1)               */
+   long          num_rows;   /* number of rows (NAXIS2)                    */
+   int           num_cols;   /* number of input column components          */
+   long*         offset;     /* row offset of each component (-1 = datamodel)*/
+   char*         code;       /* FITS type code (B, I, J, E, D) of each one */
+} HPE_FITS_MAP_T, *HPE_FITS_MAP_P_T;
+
 typedef struct event_setup_t {
    dmDataset*    dataset;    /* dataset (file) handle                      */
    dmBlock*      primary;    /* header keyword extension handle            */
@@ -711,8 +788,43 @@ typedef struct event_setup_t {
    short*        mapping;    /* mapping of data structure and file columns */
    char*         file;       /* file name                                  */ 
    char*         eventdef;   /* output columns                             */
+   HPE_WRITE_PLAN_P_T plan;  /* write plan and buffers of an output file   */
+   boolean       prefetched; /* TRUE = opened by the prefetch thread       */
+   boolean       fastread;   /* TRUE = map the file if it is plain FITS    */
+   HPE_FITS_MAP_P_T fits_p;  /* memory map of the input file (or NULL)     */
+   boolean*      read_field; /* fields to read, by mapping (NULL = all)    */
 } EVENT_SETUP_T, *EVENT_SETUP_P_T;
 
+
+/*  the following structure holds a block of consecutive rows of the input
+ *  event file. Each column used by load_event_data is read into a typed
+ *  buffer with one datamodel call per block (see load_event_block.c);
+ *  bit and vector columns are still read from the current row.
+ *
+ *  EVENT BLOCK STRUCTURE
+ */
+
+#define HDET_BLOCK_ROWS     4096  /* number of input rows read per block   */
+#define HPE_MAX_THREADS       64  /* maximum value of nthreads parameter   */
+#define HPE_MAX_WRITEQUEUE    64  /* maximum value of writequeue parameter */
+#define HPE_MAX_PROCS         64  /* maximum value of nprocs parameter     */
+
+#define HDET_BLK_SKIP          0  /* column not loaded into event record   */
+#define HDET_BLK_SHORT         1  /* column buffered as short              */
+#define HDET_BLK_LONG          2  /* column buffered as long               */
+#define HDET_BLK_DOUBLE        3  /* column buffered as double             */
+#define HDET_BLK_ROW           4  /* column read from the current row      */
+
+typedef struct event_block_t {
+   long          size;       /* number of rows the buffers can hold        */
+   long          first_row;  /* table row number of first buffered row     */
+   long          num_rows;   /* number of rows currently in the buffers    */
+   int           num_cols;   /* number of input column components          */
+   short*        kind;       /* buffer type of each column (HDET_BLK_*)    */
+   void**        buf;        /* row buffer of each column                  */
+   boolean       row_access; /* TRUE if any column is read row by row      */
+} EVENT_BLOCK_T, *EVENT_BLOCK_P_T;
+
   /*-----------------------------------------------------------
    * variable flg  :
    *    INIT_OK = callInit was called and is ok.
@@ -770,6 +882,15 @@ typedef struct input_parms_t {
    double cdelt[2];        /* sky coordinate values for wcs/asp corrections  */
    float  randpixsize;     /* width of randomization (-size..+size)          */
    unsigned long rand_seed; /* seed for pixlib randomization (0 = use time)  */
+   unsigned long rand_key; /* key of counter randomization (seed or time) */
+   long   file_num;        /* position of the input file in the stack        */
+   long   rowstart;        /* first row of each input file to process        */
+   long   rowstop;         /* last row of each input file (0 = last row)     */
+   double tmin;            /* earliest event time to process (0 = no limit) */
+   double tmax;            /* latest event time to process (0 = no limit)   */
+   boolean time_window;    /* TRUE = tmin, tmax or gtifile given            */
+   long   filestart;       /* first stack file processed (worker process)    */
+   long   filestop;        /* last stack file processed (0 = last file)      */
    long   gain_axlen[2];  /* axes lengths for old 2dim gain image */
 
 /* ---- 10/2009 - for dph hrcS gain table. */
@@ -786,6 +907,14 @@ double *rawygridVal ;  /* rawygrid column ; dim=576 */
 double *timegridVal ;  /* timegrid column ; dim=18 */
 double *obs_tgain;     /* adjusted tgain(func. of evt MJD_OBS) ; dim=576*/ 
 double *G_2nd;         /* adjusted gainmap ; dim=48*576 */
+/* ---- 10/2026 - direct-indexed lookup of the hrcS gain table cells */
+long gainlutXmin ;    /* raw x of gainlutX[0] */
+long gainlutYmin ;    /* raw y of gainlutY[0] */
+long gainlutXlen ;    /* # raw x pixels in gainlutX (0 = use grid_idx) */
+long gainlutYlen ;    /* # raw y pixels in gainlutY (0 = use grid_idx) */
+long *gainlutX ;      /* raw x pixel -> xj */
+long *gainlutY ;      /* raw y pixel -> yi*RAWX_LEN */
+HPE_GAIN_CELL_P_T gainCell ; /* fused gain of each cell ; dim=48*576 */
 /* ---- end */
 
 /*10/2009-value of key sampnorm in fap new hrcI gainImg (only); gain_factor;*/
@@ -802,6 +931,20 @@ double sampnorm;
    boolean scl_xsts;       /* TRUE = scale column (amp_sf) is in input file  */
    boolean do_ratio;       /* TRUE = perform ratio validity checks           */ 
    boolean do_ADC;         /* TRUE = perform ADC corrections                 */ 
+   boolean batch;          /* TRUE = process events in blocks, stage by stage*/
+   boolean rand_counter;   /* TRUE = counter based pixel randomization      */
+   int     nthreads;       /* # threads used to process a block (batch=yes) */
+   int     writequeue;     /* # output blocks queued for the writer thread  */
+   boolean prefetch;       /* TRUE = open the next input file in background */
+   int     nprocs;         /* # processes sharing out the input files       */
+   boolean fastread;       /* TRUE = decode plain FITS input files directly */
+   boolean fastmath;       /* TRUE = fast pow/sin in the tap ring correction*/
+   boolean fastsky;        /* TRUE = sky positions by a per-aspect transform*/
+   boolean aspstore;       /* TRUE = read the aspect stack into memory      */
+   boolean fastchip;       /* TRUE = chip to tdet/fpc by per chip transforms*/
+   int     chipcheck;      /* check every n'th fastchip position (0 = none) */
+   int     worker;         /* worker process number (0 = not a worker)      */
+   boolean read_field[HDET_NUM_FIELDS]; /* input fields used by the run     */
 
    /* for amp_sf_cor */
    boolean do_amp_sf_cor;  /* TRUE = perform amp_sf correction (from hpe.par)*/
@@ -840,6 +983,8 @@ double sampnorm;
    char   outfile[DS_SZ_PATHNAME];  /* I - file name of output event file    */
    char   obsfile[DS_SZ_PATHNAME];  /* I - name of obs.par file              */
    char   logfile[DS_SZ_PATHNAME];  /* I - file name of output debug log file*/
+   char   timingfile[DS_SZ_PATHNAME]; /* I - JSON file of stage times        */
+   char   gtifile[DS_SZ_PATHNAME]; /* I - GTI file bounding the event times  */
    char   align_file[DS_SZ_PATHNAME]; /* I - path/name of alignment file     */
    char   asp_file[DS_SZ_PATHNAME]; /* I - path/name of aspect file          */
    char   gain_file[DS_SZ_PATHNAME]; /* I - path/name of gain image file     */
@@ -876,6 +1021,83 @@ double sampnorm;
 } INPUT_PARMS_T, *INPUT_PARMS_P_T;
 
 
+/*  the following structure holds the projective transform which takes the
+ *  focal plane position of an event to its sky position for one aspect
+ *  record that is not an offsets file (fastsky = yes). It stands for the
+ *  dmTanPixToWorld()/dmTanWorldToPix() pair of calculate_coords_hrc.
+ *
+ *  SKY TRANSFORM STRUCTURE
+ */
+
+typedef struct hpe_tan_xform_t {
+   boolean      set;        /* TRUE = set up for the record in asp         */
+   boolean      valid;      /* TRUE = h matches the dmTan calls            */
+   ASPECT_REC_T asp;        /* aspect record of the transform              */
+   double       h[3][3];    /* sky = (h[0..1] * [fpc,1]) / (h[2] * [fpc,1])*/
+   long         num_fits;   /* aspect records given a transform            */
+   long         num_failed; /* aspect records left to the dmTan calls      */
+} HPE_TAN_XFORM_T, *HPE_TAN_XFORM_P_T;
+
+
+/*  the following structure holds, for each chip, the projective transforms
+ *  which stand for pix_chip_to_fpc() and pix_chip_to_tdet() (fastchip =
+ *  yes). The chip to focal plane transforms depend on the alignment and
+ *  are fitted again when it changes.
+ *
+ *  CHIP TRANSFORM STRUCTURE
+ */
+
+#define HPE_NUM_CHIPS        4    /* chip ids 0 (HRC-I) and 1 to 3 (HRC-S)*/
+#define HPE_CHIP_TO_FPC      0    /* pix_chip_to_fpc()                    */
+#define HPE_CHIP_TO_TDET     1    /* pix_chip_to_tdet()                   */
+#define HPE_NUM_CHIP_XFORMS  2
+
+typedef struct hpe_chip_xform_t {
+   boolean set[HPE_NUM_CHIP_XFORMS][HPE_NUM_CHIPS];   /* TRUE = fitted    */
+   boolean valid[HPE_NUM_CHIP_XFORMS][HPE_NUM_CHIPS]; /* TRUE = matches
+                                                         pixlib           */
+   double  h[HPE_NUM_CHIP_XFORMS][HPE_NUM_CHIPS][3][3]; /* transforms     */
+   ALIGNMENT_REC_T aln;     /* alignment of the chip to fpc transforms     */
+   long    check_every;     /* check every n'th position against pixlib    */
+   long    until_check[HPE_NUM_CHIP_XFORMS]; /* positions to the next check*/
+   long    num_applied;     /* positions given by a transform              */
+   long    num_fits;        /* transforms fitted                           */
+   long    num_failed;      /* transforms left to pixlib                   */
+   long    num_checked;     /* positions checked against pixlib            */
+   long    num_mismatch;    /* checked positions which did not match       */
+} HPE_CHIP_XFORM_T, *HPE_CHIP_XFORM_P_T;
+
+
+/*  the following structures hold the calibration of each tap of an axis
+ *  read per event by the ADC correction and the coordinate stage: the
+ *  ADC coefficients and whether the tap is within the ADC and degap tap
+ *  ranges, one 32 byte record per tap (hpe_tap_cal.c).
+ *
+ *  TAP CALIBRATION STRUCTURES
+ */
+
+typedef struct hpe_tap_cal_t {
+   float  p[HDET_NUM_AMPS];  /* ADC intercepts of the three amps         */
+   float  q[HDET_NUM_AMPS];  /* ADC slopes of the three amps             */
+   short  adc_ok;            /* TRUE = tap within the ADC tap range      */
+   short  degap_ok;          /* TRUE = tap within the degap tap range    */
+   short  tap_num;           /* tap number (-1 = none)                   */
+   short  spare;             /* pads the record to 32 bytes              */
+} HPE_TAP_CAL_T, *HPE_TAP_CAL_P_T;
+
+typedef struct hpe_tap_cal_table_t {
+   HPE_TAP_CAL_P_T rec[HDET_NUM_PLANES];      /* records of each axis    */
+   long            num_taps[HDET_NUM_PLANES]; /* records of each axis    */
+   HPE_TAP_CAL_T   none;     /* record of a tap outside of the records   */
+   void*           block;    /* aligned memory holding the records       */
+} HPE_TAP_CAL_TABLE_T, *HPE_TAP_CAL_TABLE_P_T;
+
+/* record of a tap of an axis */
+#define HPE_TAP_CAL_REC(tc_p, plane, tap) \
+   ((((tap) >= 0) && ((tap) < (tc_p)->num_taps[plane])) ? \
+    &(tc_p)->rec[plane][tap] : &(tc_p)->none)
+
+
 
 
 /*  the following structure is used by hrc_process_events to keep track of 
@@ -900,6 +1122,32 @@ typedef struct statistics_t {
    unsigned short dependencies; /* dependency mask */ 
 } STATISTICS_T, *STATISTICS_P_T;
 
+/*  the following header keywords record the statistics and event time
+ *  range of an output made from part of the input rows (rowstart/rowstop),
+ *  so that partial outputs can be merged.
+ */
+#define HPE_ROWSTART_KEY  "ROWSTART"  /* first input row processed        */
+#define HPE_ROWSTOP_KEY   "ROWSTOP"   /* last input row (0 = last row)    */
+#define HPE_EVTTSTRT_KEY  "EVTTSTRT"  /* time of earliest event           */
+#define HPE_EVTTSTOP_KEY  "EVTTSTOP"  /* time of latest event             */
+#define HPE_NEVTIN_KEY    "NEVTIN"    /* total_events_in                  */
+#define HPE_NEVTOUT_KEY   "NEVTOUT"   /* total_events_out                 */
+#define HPE_NFILEIN_KEY   "NFILEIN"   /* num_files_in                     */
+#define HPE_NBADFILE_KEY  "NBADFILE"  /* num_bad_files                    */
+#define HPE_NBADGRID_KEY  "NBADGRID"  /* bad_grid_ratio                   */
+#define HPE_NBADPHA_KEY   "NBADPHA"   /* bad_pha_ratio                    */
+#define HPE_NBADU_KEY     "NBADDSTU"  /* bad_dist[HDET_PLANE_X]           */
+#define HPE_NBADV_KEY     "NBADDSTV"  /* bad_dist[HDET_PLANE_Y]           */
+#define HPE_NBADBOT_KEY   "NBADBOT"   /* bad_bot                          */
+#define HPE_NFIXMFIN_KEY  "NFIXMFIN"  /* fixed_mfinpos                    */
+#define HPE_NFIXPFIN_KEY  "NFIXPFIN"  /* fixed_pfinpos                    */
+#define HPE_NSEQERR_KEY   "NSEQERR"   /* sequence_err                     */
+
+/* 10/2026 - range of the input stack files of an output written by a
+ * worker process (nprocs > 1) */
+#define HPE_FILESTRT_KEY  "FILESTRT"  /* first stack file processed       */
+#define HPE_FILESTOP_KEY  "FILESTOP"  /* last stack file processed        */
+
 
 
 #define HPE_LEN_80     80 
@@ -952,14 +1200,53 @@ extern void   write_hrc_events(EVENT_SETUP_P_T,
                                EVENT_REC_P_T,
                                dsErrList*);  
 
+/* 10/2026 - routines to compile the write plan of an output event file,
+ * write the buffered events and free the plan */
+extern boolean compile_write_plan(EVENT_SETUP_P_T, long, dsErrList*);
+extern void   flush_hrc_events(EVENT_SETUP_P_T);
+extern void   write_event_rows(EVENT_SETUP_P_T, void**, long, long);
+extern void** allocate_write_buffers(HPE_WRITE_PLAN_P_T);
+extern void   deallocate_write_buffers(HPE_WRITE_PLAN_P_T, void***);
+extern void   deallocate_write_plan(HPE_WRITE_PLAN_P_T*);
+
+/* 10/2026 - routines to hand the output rows to the writer thread (see
+ * event_writer_functions.c) */
+extern void   queue_event_rows(EVENT_SETUP_P_T);
+extern void   detach_event_writer(HPE_WRITE_PLAN_P_T);
+
 /* routine to set up mapping of event columns */
 extern bool   parse_hrc_evt_columns (char**, 
                                      int, 
                                      short*); 
 
 /* routine to map input event columns to event record structure */
-extern void   load_event_data(EVENT_SETUP_P_T, EVENT_REC_P_T);
-extern void   initial_status(INPUT_PARMS_P_T,  EVENT_REC_P_T); 
+extern void   load_event_data(EVENT_SETUP_P_T,
+                              EVENT_BLOCK_P_T,
+                              long,
+                              EVENT_REC_P_T);
+extern void   initial_status(INPUT_PARMS_P_T,  EVENT_REC_P_T);
+
+/* routines to read the input event columns a block of rows at a time */
+extern short  event_block_kind(short,
+                               dmDataType);
+extern EVENT_BLOCK_P_T allocate_event_block(EVENT_SETUP_P_T,
+                                            long,
+                                            dsErrList*);
+extern long   load_event_block(EVENT_SETUP_P_T,
+                               EVENT_BLOCK_P_T,
+                               long,
+                               dsErrList*);
+extern void   deallocate_event_block(EVENT_BLOCK_P_T*);
+
+/* routines to decode the columns of a plain FITS input file (fastread) */
+extern HPE_FITS_MAP_P_T open_fits_map(EVENT_SETUP_P_T);
+extern boolean read_fits_map_column(HPE_FITS_MAP_P_T,
+                                    int,
+                                    short,
+                                    void*,
+                                    long,
+                                    long);
+extern void   close_fits_map(HPE_FITS_MAP_P_T*);
 
 /* routine to setup bit mask for data dependency check */
 extern unsigned short   dependency_check_init (short*, 
@@ -975,6 +1262,15 @@ extern boolean   output_coord_validate(short*,
                                        int, 
                                        INPUT_PARMS_P_T);
 
+/* routines to process only the events of a time window (tmin/tmax) */
+extern void   load_time_window(INPUT_PARMS_P_T, dsErrList*);
+extern void   find_time_window(EVENT_SETUP_P_T, double, double, long*);
+extern boolean outside_time_window(INPUT_PARMS_P_T, double);
+
+/* routines to read only the input fields used by the run */
+extern void   set_input_projection(INPUT_PARMS_P_T);
+extern int    project_input_columns(EVENT_SETUP_P_T);
+
 /* routine to read input parameters */ 
 extern void   load_input_parameters(INPUT_PARMS_P_T, 
                                     dsErrList*);
@@ -1000,16 +1296,21 @@ extern void   hrc_tel_to_chip(double*,
                               short*, 
                               double*);
 
-/* routine to add a hot spot to the ordered bad pixel list */ 
-extern void   update_bad_pixel_list(BAD_PIX_P_T, 
-                                    BAD_PIX_P_T*);
+/* routine to sort a chip's hot spot array and remove duplicates */ 
+extern void   sort_bad_pixel_list(BAD_PIX_LIST_P_T);
  
-/* routine to remove the hot spot list and deallocate the list's memory */ 
-extern void   cleanup_bad_pixel_data(BAD_PIX_A_T);
+/* routine to remove the hot spot list and index and deallocate memory */ 
+extern void   cleanup_bad_pixel_data(BAD_PIX_A_T,
+                                     BAD_PIX_INDEX_T);
  
 /* routine to load a stack of hot spot (bad pixel) files into memory */ 
 extern boolean   load_bad_pixel_files(char*, 
-                                      BAD_PIX_P_T*);
+                                      BAD_PIX_A_T,
+                                      BAD_PIX_INDEX_T);
+
+/* routine to build the per chip tiled bitmap index of the hot spots */
+extern void   build_bad_pixel_index(BAD_PIX_A_T,
+                                    BAD_PIX_INDEX_T);
  
 /* routine to access and load a single hot spot (bad pixel) file */ 
 extern boolean   open_bad_pixel_file(BAD_PIX_SETUP_P_T);
@@ -1018,14 +1319,15 @@ extern boolean   open_bad_pixel_file(BAD_PIX_SETUP_P_T);
 extern short   map_bad_pixel_column(char[]);
  
 /* routine to load a column value from a row in a hot spot file */
-extern void   load_bad_pixel_data(BAD_PIX_SETUP_P_T, 
-                                  BAD_PIX_P_T*);
+extern boolean   load_bad_pixel_data(BAD_PIX_SETUP_P_T, 
+                                     BAD_PIX_A_T);
 
 /* function to deallocate memory and close descriptors for bad pixel routines*/
 extern void   close_bad_pixel_file(BAD_PIX_SETUP_P_T hk_p);
  
 /* function to check for hot pixels */
 extern void   check_for_bad_pixels(BAD_PIX_A_T, 
+                                   BAD_PIX_INDEX_T,
                                    EVENT_REC_P_T);
  
 /* function to adjust the output eventdef based on output system */
@@ -1049,6 +1351,9 @@ extern void   hrc_process_setup_input_file(EVENT_SETUP_P_T,
                                            STATISTICS_P_T,
                                            dsErrList*);
 
+/* 10/2026 - routine to open the input file and set up its columns only */
+extern boolean open_input_event_file(EVENT_SETUP_P_T);
+
 /* routine to open the output file and take care of input housekeeping */
 extern void   hrc_process_setup_output_file(EVENT_SETUP_P_T,
                                             EVENT_SETUP_P_T,
@@ -1067,6 +1372,31 @@ extern void hrc_setup_columns(EVENT_SETUP_P_T, INPUT_PARMS_P_T, char**, dsErrLis
 void hpeSetRange_s(dmBlock* bb, dmDescriptor* dd, char *n1, short v1, short v2);
 void hpe_set_ranges( EVENT_SETUP_P_T evtout, INPUT_PARMS_P_T inp, char** name);
 
+/* routine to write the statistics of a partial output to its header */
+extern void hpe_write_shard_keys(dmBlock*,
+                                 long,
+                                 long,
+                                 double,
+                                 double,
+                                 STATISTICS_P_T);
+
+/* routine to read the statistics of a partial output from its header */
+extern boolean hpe_read_shard_keys(dmBlock*,
+                                   long*,
+                                   long*,
+                                   double*,
+                                   double*,
+                                   STATISTICS_P_T);
+
+/* 10/2026 - routines to write/read the stack file range of a partial
+ * output (worker process) */
+extern void hpe_write_file_keys(dmBlock*,
+                                long,
+                                long);
+extern boolean hpe_read_file_keys(dmBlock*,
+                                  long*,
+                                  long*);
+
 /* routine to load old or new gain file */
 extern void load_gain_image(char*, INPUT_PARMS_P_T, float**, dsErrList*);
  
@@ -1081,8 +1411,45 @@ extern boolean calculate_coords_hrc(EVENT_REC_P_T,
                                     ASPECT_REC_P_T,
                                     DEGAP_CONFIG_P_T,
 				    short,
+                                    HPE_TAN_XFORM_P_T,
+                                    HPE_CHIP_XFORM_P_T,
+                                    HPE_TAP_CAL_TABLE_P_T,
                                     dsErrList*);
+
+/* 10/2026 - routines to set up and apply the sky transform of an aspect
+ * record (fastsky; hpe_tan_xform.c) */
+extern boolean hpe_tan_xform_ready(HPE_TAN_XFORM_P_T,
+                                   ASPECT_REC_P_T,
+                                   INPUT_PARMS_P_T);
+extern void hpe_apply_tan_xform(HPE_TAN_XFORM_P_T,
+                                double*,
+                                double*);
+extern boolean hpe_fit_projective(double[4][2],
+                                  double[4][2],
+                                  double[3][3]);
+extern void hpe_apply_projective(double[3][3],
+                                 double*,
+                                 double*);
+
+/* 10/2026 - routines to set up and apply the per chip transforms which
+ * stand for pix_chip_to_fpc()/pix_chip_to_tdet() (fastchip;
+ * hpe_chip_xform.c) */
+extern void setup_chip_xforms(HPE_CHIP_XFORM_P_T,
+                              INPUT_PARMS_P_T,
+                              ALIGNMENT_REC_P_T);
+extern void update_chip_xforms(HPE_CHIP_XFORM_P_T,
+                               ALIGNMENT_REC_P_T);
+extern void hpe_chip_xform(HPE_CHIP_XFORM_P_T,
+                           short,
+                           short,
+                           double*,
+                           double*);
  
+/* routine to compute the pixel randomization offsets of an event */
+extern void hpe_random_offsets(INPUT_PARMS_P_T,
+                               EVENT_REC_P_T,
+                               VEC2_DBLE);
+
 /* routine to print out and remove warnings from error list */
 extern boolean process_warnings(dsErrList*, FILE*, int);
  
@@ -1151,6 +1518,13 @@ extern double hyperbolic_help(double,
                               double, 
                               double);
 
+/* routine to evaluate the three tests above on a range of events */
+extern void check_adc_filters(EVENT_REC_P_T,
+                              long,
+                              HYP_TEST_P_T,
+                              SAT_TEST_P_T,
+                              double*);
+
 /* amp_sf correction functions */
 extern void open_amp_sf_cor_file(INPUT_PARMS_P_T inp_p, 
              AMPSFCOR_COEFF_P_T *ampsfcor_coeff, dsErrList *hpe_err_p) ;
@@ -1169,6 +1543,13 @@ extern void open_tap_ring_file(INPUT_PARMS_P_T,
 extern void check_tap_ring(INPUT_PARMS_P_T,EVENT_REC_P_T, 
                            TRING_COEFFS_P_T ) ; 
 
+/* 10/2026 - tap ring correction of a range of events, the pow/sin of the
+ * corrected axes evaluated together (fastmath: hpe_fast_math.c) */
+extern void check_tap_ring_batch(INPUT_PARMS_P_T, EVENT_REC_P_T, long,
+                                 TRING_COEFFS_P_T);
+extern void hpe_fast_pow(const double*, const double*, double*, long);
+extern void hpe_fast_sin(const double*, double*, long);
+
 /* for old 2dim gain image or fap new hrcI 2dim gain image*/
 /* 10/2009 - rename old_gain_index to image_2dim_gain_index(); no code changes;*/
 extern void image_2dim_gain_index( INPUT_PARMS_P_T inp_p, EVENT_REC_T *evt_p);
@@ -1184,6 +1565,10 @@ extern void read_gainTab_col(dmBlock* srcBlock, char* colName,
                              double** colVal, long* colSize);
 extern void load_S_new_gain_table( INPUT_PARMS_P_T inp_p);
 extern void S_new_gain_index_pi(INPUT_PARMS_P_T inp_p, EVENT_REC_T *evt_p);
+extern void S_new_gain_pi_range(INPUT_PARMS_P_T inp_p, EVENT_REC_T *evt_p,
+                                boolean *bad, long num);
+extern void make_gain_lut(long dim_Grid, double *gridCol, long scale,
+                          long **lut, long *lutMin, long *lutLen);
 /* end: */ 
 
 /* 10/2009 - functions for both dph and fap new gain file*/
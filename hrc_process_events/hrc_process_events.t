@@ -100,6 +100,28 @@ zerotest()
  fi
 }
 
+######################################################################
+# subroutine
+# evtdiff <reference file> <output file> <dmlist options>
+# (10/2026) Compares the EVENTS blocks of two outputs of this tool (e.g.
+# a batch=no and a batch=yes run), filtered by keyfilter(), above.
+# Sets mismatch=0 if they differ.
+
+evtdiff()
+{
+  dmlist "$1[EVENTS]" $3 > $OUTDIR/${testid}.dmp1_std  2>>$LOGFILE
+  keyfilter $OUTDIR/${testid}.dmp1_std $OUTDIR/${testid}.dmp2_std \
+            2>>$LOGFILE
+  dmlist "$2[EVENTS]" $3 > $OUTDIR/${testid}.dmp1  2>>$LOGFILE
+  keyfilter $OUTDIR/${testid}.dmp1 $OUTDIR/${testid}.dmp2  2>>$LOGFILE
+  diff $OUTDIR/${testid}.dmp2 $OUTDIR/${testid}.dmp2_std > \
+       /dev/null 2>>$LOGFILE
+  if  test $? -ne 0 ; then
+    echo "ERROR: MISMATCH in $2 (against $1)" >> $LOGFILE
+    mismatch=0
+  fi
+}
+
 ######################################################################
 # subroutine
 # pset_hrc_I()
@@ -314,11 +336,11 @@ toolname="hrc_process_events"
 
 # set up list of tests
 # !!4
-alltests="S_warn_nom I_obsfile S_rmNewKey S_addNewKey hrc_I hrc_I_a hrc_I_b hrc_I_c hrc_S hrcS_no_rangelev hrcS_low_rangelev S_no_ampsfcor S_no_ampsfcor2 S_172 S_172_a S_172_a2 S_172_a3 S_172_b S_2582_gainTab S_2582_gainTab_b S_2582_gainTab_c S_1246_gainTab S_1246_gainTab_b S_1246_gainTab_c S_1246_gainTab_d new_I_gainImg new_I_gainImg_b new_I_gainImg_c new_I_gainImg_d"
+alltests="S_warn_nom I_obsfile S_rmNewKey S_addNewKey hrc_I hrc_I_a hrc_I_b hrc_I_c hrc_S hrcS_no_rangelev hrcS_low_rangelev S_no_ampsfcor S_no_ampsfcor2 S_172 S_172_a S_172_a2 S_172_a3 S_172_b S_2582_gainTab S_2582_gainTab_b S_2582_gainTab_c S_1246_gainTab S_1246_gainTab_b S_1246_gainTab_c S_1246_gainTab_d new_I_gainImg new_I_gainImg_b new_I_gainImg_c new_I_gainImg_d hrc_I_batch hrc_S_batch hrc_S_threads hrc_S_nprocs hrc_S_rows S_172_aspstore hrc_S_fastread hrc_S_fastmath S_172_fastsky hrc_S_fastchip hrc_S_writequeue hrc_S_prefetch S_1246_chip hrc_S_window S_1246_gainTab_e S_172_a3_tap"
 
 # "short" test to run
 # !!5
-shortlist="S_warn_nom I_obsfile S_rmNewKey S_addNewKey hrc_I hrc_S hrcS_no_rangelev hrcS_low_rangelev S_no_ampsfcor S_no_ampsfcor2 S_172 S_172_a"
+shortlist="S_warn_nom I_obsfile S_rmNewKey S_addNewKey hrc_I hrc_S hrcS_no_rangelev hrcS_low_rangelev S_no_ampsfcor S_no_ampsfcor2 S_172 S_172_a hrc_S_batch"
 
 
 # compute date string for log file
@@ -409,6 +431,7 @@ fi
 
 find_tool dmlist
 find_tool dmimgcalc
+find_tool dmcopy
 
 
 
@@ -621,6 +644,396 @@ do
             eval  $test2_string
             ;;
 
+    #!(10/2026) same as hrc_I, run one event at a time (batch=no) as the
+    #!reference and in blocks (batch=yes); the event files must agree
+    hrc_I_batch)  pset_hrc_I
+            savfile=$OUTDIR/${testid}_ref.fits
+            test1_string="hrc_process_events \
+               infile=${INDIR}/3c273_small_evt0a.fits \
+               outfile=$savfile badpixfile=NONE \
+               acaofffile=${INDIR}/hrcf461_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf461_000N001_soff1.fits \
+               batch=no > /dev/null"
+            echo $test1_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test1_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (batch=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test1_string="hrc_process_events \
+               infile=${INDIR}/3c273_small_evt0a.fits \
+               outfile=$outfile badpixfile=NONE \
+               acaofffile=${INDIR}/hrcf461_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf461_000N001_soff1.fits \
+               batch=yes > /dev/null"
+            echo $test1_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test1_string
+            ;;
+    #!(10/2026) same as hrc_S, batch=no against batch=yes
+    hrc_S_batch)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               batch=no > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (batch=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               batch=yes > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S, one thread (the reference) against four
+    #!threads processing each block of events
+    hrc_S_threads)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               nthreads=1 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (nthreads=1)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               nthreads=4 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+    #!(10/2026) hrc_S input split in two files; the stack is processed
+    #!by one process (the reference) and shared out between two
+    #!worker processes (nprocs=2), whose outputs are merged; the pixel
+    #!randomization is keyed by row (rand_gen=counter)
+    hrc_S_nprocs)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            nrows=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS]" counts`
+            half=`expr $nrows / 2`
+            dmcopy "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=1:${half}]" \
+                   $OUTDIR/${testid}_in1.fits clobber=yes 2>>$LOGFILE
+            dmcopy "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=`expr $half + 1`:${nrows}]" \
+                   $OUTDIR/${testid}_in2.fits clobber=yes 2>>$LOGFILE
+            instack="$OUTDIR/${testid}_in1.fits,$OUTDIR/${testid}_in2.fits"
+            test2_string="hrc_process_events \
+               infile=${instack} \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               nprocs=1 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (nprocs=1)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${instack} \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               nprocs=2 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+    #!(10/2026) hrc_S processed in two row ranges (rowstart/rowstop)
+    #!whose outputs are merged by hpe_merge_events, against the whole
+    #!file (the reference); rand_gen=counter
+    hrc_S_rows)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            nrows=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS]" counts`
+            half=`expr $nrows / 2`
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               rowstart=1 rowstop=0 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (whole file)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$OUTDIR/${testid}_part1.fits \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               rowstart=1 rowstop=${half} > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (rows 1-${half})" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$OUTDIR/${testid}_part2.fits \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               rowstart=`expr $half + 1` rowstop=0 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (rows `expr $half + 1`-${nrows})" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test5_string="hpe_merge_events \
+               infile=$OUTDIR/${testid}_part2.fits,$OUTDIR/${testid}_part1.fits \
+               outfile=$outfile clobber=yes > /dev/null"
+            echo $test5_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test5_string
+            ;;
+
+    #!(10/2026) same as hrc_S, the input columns decoded by the
+    #!datamodel (fastread=no, the reference) and from a memory map of
+    #!the FITS file (fastread=yes)
+    hrc_S_fastread)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               fastread=no > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (fastread=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               fastread=yes > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S with the tap ring correction, pow() and
+    #!sin() from the math library (fastmath=no, the reference) and
+    #!from the polynomial approximations (fastmath=yes)
+    hrc_S_fastmath)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               tapfile=${INDIR}/hrcsD1999-07-22tapringN0001.fits \
+               fastmath=no > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (fastmath=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               tapfile=${INDIR}/hrcsD1999-07-22tapringN0001.fits \
+               fastmath=yes > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S, the chip to tdet/det positions taken
+    #!through pixlib (fastchip=no, the reference) and through the per
+    #!chip transforms fitted to pixlib (fastchip=yes)
+    hrc_S_fastchip)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               fastchip=no > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (fastchip=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               fastchip=yes > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S, the output blocks written by the main
+    #!thread (writequeue=0, the reference) and by the writer thread
+    #!(writequeue=4)
+    hrc_S_writequeue)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               writequeue=0 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (writequeue=0)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               writequeue=4 > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S with the input split into a stack of two
+    #!files, each file opened when it is reached (prefetch=no, the
+    #!reference) and the next file opened while the current one is
+    #!processed (prefetch=yes)
+    hrc_S_prefetch)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            nrows=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS]" counts`
+            half=`expr $nrows / 2`
+            dmcopy "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=1:${half}]" \
+                   $OUTDIR/${testid}_in1.fits clobber=yes 2>>$LOGFILE
+            dmcopy "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=`expr $half + 1`:${nrows}]" \
+                   $OUTDIR/${testid}_in2.fits clobber=yes 2>>$LOGFILE
+            instack="$OUTDIR/${testid}_in1.fits,$OUTDIR/${testid}_in2.fits"
+            test2_string="hrc_process_events \
+               infile=${instack} \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               prefetch=no > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (prefetch=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${instack} \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter \
+               prefetch=yes > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
+    #!(10/2026) same as hrc_S, restricted to the events from a third to
+    #!two thirds of the way through the input with tmin/tmax; compared
+    #!with the same events of the full run
+    hrc_S_window)  pset_hrc_S
+            savfile=$OUTDIR/${testid}_ref.fits
+            nrows=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS]" counts`
+            row1=`expr $nrows / 3`
+            row2=`expr $nrows \* 2 / 3`
+            t1=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=${row1}][cols time]" \
+                data,clean | tail -1`
+            t2=`dmlist "${INDIR}/1246_small_evt0a.fits[EVENTS][#row=${row2}][cols time]" \
+                data,clean | tail -1`
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$savfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (no time window)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test2_string="hrc_process_events \
+               infile=${INDIR}/1246_small_evt0a.fits \
+               outfile=$outfile \
+               badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+               acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+               alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+               rand_gen=counter tmin=${t1} tmax=${t2} > /dev/null"
+            echo $test2_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test2_string
+            ;;
+
     # !!8
     hrcS_no_rangelev)  pset_hrcS_no_rangelev
             test3_string="hrc_process_events \
@@ -692,6 +1105,90 @@ do
             echo "" | tee -a  $LOGFILE
             eval  $test4_string
             ;;
+    #!(10/2026) same as S_172, the aspect solution read in sequence
+    #!(aspstore=no, the reference) and from memory (aspstore=yes)
+    S_172_aspstore)  pset_S_172
+            savfile=$OUTDIR/${testid}_ref.fits
+            test4_string="hrc_process_events \
+               infile=${INDIR}/S_172_in.fits \
+               outfile=$savfile  \
+               badpixfile=${INDIR}/hrcf00172_000N002_bpix1.fits \
+               acaofffile=@${INDIR}/pcadf052944519N002_asol1.lis \
+               alignmentfile=${INDIR}/pcadf052944519N002_asol1.fits \
+               aspstore=no > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (aspstore=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test4_string="hrc_process_events \
+               infile=${INDIR}/S_172_in.fits \
+               outfile=$outfile  \
+               badpixfile=${INDIR}/hrcf00172_000N002_bpix1.fits \
+               acaofffile=@${INDIR}/pcadf052944519N002_asol1.lis \
+               alignmentfile=${INDIR}/pcadf052944519N002_asol1.fits \
+               aspstore=yes > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            ;;
+    #!(10/2026) same as S_172 (an aspect solution, not offsets), the sky
+    #!positions from the two tangent plane projections (fastsky=no, the
+    #!reference) and from one transform per aspect record (fastsky=yes)
+    S_172_fastsky)  pset_S_172
+            savfile=$OUTDIR/${testid}_ref.fits
+            test4_string="hrc_process_events \
+               infile=${INDIR}/S_172_in.fits \
+               outfile=$savfile  \
+               badpixfile=${INDIR}/hrcf00172_000N002_bpix1.fits \
+               acaofffile=@${INDIR}/pcadf052944519N002_asol1.lis \
+               alignmentfile=${INDIR}/pcadf052944519N002_asol1.fits \
+               fastsky=no > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (fastsky=no)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test4_string="hrc_process_events \
+               infile=${INDIR}/S_172_in.fits \
+               outfile=$outfile  \
+               badpixfile=${INDIR}/hrcf00172_000N002_bpix1.fits \
+               acaofffile=@${INDIR}/pcadf052944519N002_asol1.lis \
+               alignmentfile=${INDIR}/pcadf052944519N002_asol1.fits \
+               fastsky=yes > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            ;;
+    #!(10/2026) same as S_172_a3 (ADC, degap and tap files from CALDB)
+    #!one event at a time (batch=no); the ADC correction and the degap
+    #!tap range come from the tap calibration records, and are compared
+    #!with the saved S_172_a3 output
+    S_172_a3_tap)  pset_S_172
+            savfile=$SAVDIR/S_172_a3.fits
+            test4_string="hrc_process_events \
+               infile=${INDIR}/S_172_in.fits \
+               outfile=$outfile  \
+               degapfile=CALDB \
+               gainfile=CALDB \
+               ADCfile=CALDB \
+               hypfile=CALDB \
+               tapfile=CALDB \
+               evtflatfile=CALDB \
+               ampsatfile=CALDB \
+               ampsfcorfile=CALDB \
+               badpixfile=${INDIR}/hrcf00172_000N002_bpix1.fits \
+               acaofffile=${INDIR}/pcadf052944519N002_asol1.fits \
+               alignmentfile=${INDIR}/pcadf052944519N002_asol1.fits \
+               batch=no > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            ;;
     # test degap calib ; test new degap format ; 
     S_172_a)  pset_S_172
             test4_string="hrc_process_events \
@@ -907,6 +1404,85 @@ do
             eval  $test4_string
             ;;
 
+    #!(10/2026) same as S_1246_gainTab with the gain cells looked up one
+    #!event at a time (batch=no) rather than over the PI slice; both
+    #!paths go through the raw pixel tables, and are compared with the
+    #!saved S_1246_gainTab output
+    S_1246_gainTab_e )  savfile=$SAVDIR/S_1246_gainTab.fits
+            test4_string="hrc_process_events \
+            infile=${INDIR}/upd_S_1246_evt1.fits outfile=${outfile} \
+            gainfile=${INDIR}//hrcsD1999-08-22tgainN0001.fits \
+            degapfile=${INDIR}/hrcsD1999-11-08gapN0002.fits \
+            badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+            acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+            alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+            do_ratio=yes  do_amp_sf_cor=no \
+            ADCfile=NONE ampsfcorfile=NONE \
+            tapfile=NONE hypfile=${INDIR}/hrcsD1999-07-23fptestN0001.fits \
+            ampsatfile=${INDIR}/hrcsD1999-07-23sattestN0001.fits \
+            evtflatfile=${INDIR}/hrcsD1999-07-22eftestN0001.fits \
+            cfu1=1.18 cfu2=-0.16 cfv1=1.11 cfv2=-0.1 amp_gain=75 \
+            badfile=${OUTDIR}/lev1_hrcs_bad_out.fits \
+            logfile=${OUTDIR}/lev1_hrcs_out.log \
+            time_offset=0 instrume=HRC-S batch=no \
+            clob+ verbose=0 > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            ;;
+
+    #!(10/2026) same as S_1246_gainTab starting at chip coordinates; the
+    #!reference reads every input column for the default eventdef, the
+    #!output of a short eventdef reads only the columns it needs and is
+    #!compared with the same columns of the reference
+    S_1246_chip )  savfile=$OUTDIR/${testid}_ref.fits
+            test4_string="hrc_process_events \
+            infile=${INDIR}/upd_S_1246_evt1.fits outfile=${savfile} \
+            gainfile=${INDIR}//hrcsD1999-08-22tgainN0001.fits \
+            degapfile=${INDIR}/hrcsD1999-11-08gapN0002.fits \
+            badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+            acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+            alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+            do_ratio=yes  do_amp_sf_cor=no \
+            ADCfile=NONE ampsfcorfile=NONE \
+            tapfile=NONE hypfile=${INDIR}/hrcsD1999-07-23fptestN0001.fits \
+            ampsatfile=${INDIR}/hrcsD1999-07-23sattestN0001.fits \
+            evtflatfile=${INDIR}/hrcsD1999-07-22eftestN0001.fits \
+            cfu1=1.18 cfu2=-0.16 cfv1=1.11 cfv2=-0.1 amp_gain=75 \
+            badfile=${OUTDIR}/lev1_hrcs_bad_out.fits \
+            logfile=${OUTDIR}/lev1_hrcs_out.log \
+            time_offset=0 instrume=HRC-S start=chip \
+            clob+ verbose=0 > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            if test $? -ne 0; then
+               echo "$toolname failed to run (default eventdef)" | tee -a $LOGFILE
+               mismatch=0
+            fi
+            test4_string="hrc_process_events \
+            infile=${INDIR}/upd_S_1246_evt1.fits outfile=${outfile} \
+            gainfile=${INDIR}//hrcsD1999-08-22tgainN0001.fits \
+            degapfile=${INDIR}/hrcsD1999-11-08gapN0002.fits \
+            badpixfile=${INDIR}/hrcf01246_000N001_bpix1.fits \
+            acaofffile=${INDIR}/hrcf01246_000N001_aoff1.fits \
+            alignmentfile=${INDIR}/hrcf01246_000N001_soff1.fits \
+            do_ratio=yes  do_amp_sf_cor=no \
+            ADCfile=NONE ampsfcorfile=NONE \
+            tapfile=NONE hypfile=${INDIR}/hrcsD1999-07-23fptestN0001.fits \
+            ampsatfile=${INDIR}/hrcsD1999-07-23sattestN0001.fits \
+            evtflatfile=${INDIR}/hrcsD1999-07-22eftestN0001.fits \
+            cfu1=1.18 cfu2=-0.16 cfv1=1.11 cfv2=-0.1 amp_gain=75 \
+            badfile=${OUTDIR}/lev1_hrcs_bad_out.fits \
+            logfile=${OUTDIR}/lev1_hrcs_out.log \
+            time_offset=0 instrume=HRC-S start=chip \
+            eventdef=\"{d:time,s:chip,l:tdet,f:det,f:sky,s:pi,x:status}\" \
+            clob+ verbose=0 > /dev/null"
+            echo $test4_string | tee -a  $LOGFILE
+            echo "" | tee -a  $LOGFILE
+            eval  $test4_string
+            ;;
+
     # ref. hrc_I_a; add CHK_GAIN key to gainfile=hrciD1999-10-04gainN0001.fits;
     # use amp_sf corr ; use tapring corr ;
     new_I_gainImg )  pset_hrc_I           
@@ -1067,11 +1643,47 @@ do
   # !!12
   #diff $OUTDIR/${testid}.dmp2 $OUTDIR/${testid}.dmp2_std > \
   #     /dev/null 2>>$LOGFILE
-  dmdiff $outfile $savfile tol=$SAVDIR/tolerance > /dev/null 2>>$LOGFILE
-  if  test $? -ne 0 ; then
-    echo "ERROR: MISMATCH in $outfile" >> $LOGFILE
-    mismatch=0
-  fi
+  case ${testid} in
+    # (10/2026) outputs compared with the tool's own reference run
+    hrc_I_batch|hrc_S_batch|hrc_S_threads|S_172_aspstore|hrc_S_fastread|\
+    hrc_S_writequeue|hrc_S_prefetch)
+      evtdiff $savfile $outfile header,data,clean
+      ;;
+    # the headers of merged outputs record the parts they were merged from
+    hrc_S_nprocs|hrc_S_rows)
+      evtdiff $savfile $outfile data,clean
+      ;;
+    # (10/2026) column projection: compared with the same columns of the
+    # reference run
+    S_1246_chip)
+      dmcopy "$savfile[EVENTS][cols time,chip,tdet,det,sky,pi,status]" \
+             $OUTDIR/${testid}_cols.fits clobber=yes 2>>$LOGFILE
+      evtdiff $OUTDIR/${testid}_cols.fits $outfile data,clean
+      ;;
+    # (10/2026) time window: compared with the events of the full run in
+    # the window
+    hrc_S_window)
+      dmcopy "$savfile[EVENTS][time=${t1}:${t2}]" \
+             $OUTDIR/${testid}_win.fits clobber=yes 2>>$LOGFILE
+      evtdiff $OUTDIR/${testid}_win.fits $outfile data,clean
+      ;;
+    # (10/2026) approximations: compared with the reference run within
+    # the tolerances
+    hrc_S_fastmath|S_172_fastsky|hrc_S_fastchip)
+      dmdiff $outfile $savfile tol=$SAVDIR/tolerance > /dev/null 2>>$LOGFILE
+      if  test $? -ne 0 ; then
+        echo "ERROR: MISMATCH in $outfile (against $savfile)" >> $LOGFILE
+        mismatch=0
+      fi
+      ;;
+    *)
+      dmdiff $outfile $savfile tol=$SAVDIR/tolerance > /dev/null 2>>$LOGFILE
+      if  test $? -ne 0 ; then
+        echo "ERROR: MISMATCH in $outfile" >> $LOGFILE
+        mismatch=0
+      fi
+      ;;
+  esac
   ####################################################################
   # FITS image  (duplicate for as many images per test as needed)
 
@@ -50,9 +50,29 @@
 *              or RANGELEV from evt1 header file.
 * (1/2009)- Add gdropfile parameter for hrcS 3dim gain:  ( obsolete 10/2009 )
 *10/2009 - remove gdropfile from hpe.par
+*10/2026 - add batch parameter to load_input_parameters.
+*10/2026 - add nthreads parameter to load_input_parameters.
+*10/2026 - add rand_gen parameter to load_input_parameters.
+*10/2026 - add rowstart/rowstop parameters to load_input_parameters.
+*10/2026 - add the timingfile parameter to load_input_parameters.
+*10/2026 - flush and free the write plan in hrc_process_evt_file_cleanup.
+*10/2026 - add the writequeue parameter to load_input_parameters.
+*10/2026 - add the prefetch parameter to load_input_parameters.
+*10/2026 - add the nprocs parameter to load_input_parameters.
+*10/2026 - add the fastread parameter to load_input_parameters; unmap the
+*          input file in hrc_process_evt_file_cleanup.
+*10/2026 - add the tmin/tmax/gtifile parameters to load_input_parameters.
+*10/2026 - add the fastmath parameter to load_input_parameters.
+*10/2026 - add the fastsky parameter to load_input_parameters.
+*10/2026 - add the aspstore parameter to load_input_parameters.
+*10/2026 - add the fastchip and chipcheck parameters to load_input_parameters.
+*10/2026 - set the key of the counter based pixel randomization in
+*          load_input_parameters (before any worker process is started);
+*          rand_gen=pixlib is not supported with nprocs > 1.
 *H***********************************************************************/
 
 #include <float.h> 
+#include <time.h>
 
 #ifndef HRC_PROCESS_EVENTS_H
 #include "hrc_process_events.h"
@@ -435,6 +455,16 @@ void load_input_parameters(
       dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
                "logfile", "hrc_process_events.par");
    }
+   if (paccess(PFFile, "timingfile"))
+   {
+      clgstr("timingfile", inp_p->timingfile, DS_SZ_PATHNAME);
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "timingfile", "hrc_process_events.par");
+   }
    if (paccess(PFFile, "instrume"))
    {
       clgstr("instrume", inp_p->instrume, DS_SZ_KEYWORD);
@@ -558,6 +588,11 @@ void load_input_parameters(
    if (paccess(PFFile, "rand_seed"))
    {
       inp_p->rand_seed = clgeti("rand_seed");
+
+      /* (10/2026) key for the counter based pixel randomization- set
+       * once, so every worker process (nprocs > 1) uses the same key */
+      inp_p->rand_key = (inp_p->rand_seed != 0) ?
+                         inp_p->rand_seed : (unsigned long) time(NULL);
    }
    else
    {
@@ -575,6 +610,19 @@ void load_input_parameters(
       dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
                "rand_pix_size", "hrc_process_events.par");
    }
+   if (paccess(PFFile, "rand_gen"))
+   {
+      char rand_gen[DS_SZ_KEYWORD];   /* pixel randomization generator */
+
+      clgstr("rand_gen", rand_gen, DS_SZ_KEYWORD);
+      inp_p->rand_counter = (ds_strcmp_cis(rand_gen, HPE_RAND_PIXLIB) != 0);
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "rand_gen", "hrc_process_events.par");
+   }
    if (paccess(PFFile, "tstart"))
    {
       clgstr("tstart", inp_p->time_start, DS_SZ_KEYWORD);
@@ -618,6 +666,215 @@ void load_input_parameters(
       dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
                "stop", "hrc_process_events.par");
    }
+   if (paccess(PFFile, "rowstart"))
+   {
+      inp_p->rowstart = clgeti("rowstart");
+      if (inp_p->rowstart < 1)
+      {
+         inp_p->rowstart = 1;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "rowstart", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "rowstop"))
+   {
+      inp_p->rowstop = clgeti("rowstop");
+      if (inp_p->rowstop < 0)
+      {
+         inp_p->rowstop = 0;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "rowstop", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "tmin"))
+   {
+      inp_p->tmin = clgetd("tmin");
+      if (inp_p->tmin < 0.0)
+      {
+         inp_p->tmin = 0.0;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "tmin", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "tmax"))
+   {
+      inp_p->tmax = clgetd("tmax");
+      if (inp_p->tmax < 0.0)
+      {
+         inp_p->tmax = 0.0;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "tmax", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "gtifile"))
+   {
+      clgstr("gtifile", inp_p->gtifile, DS_SZ_PATHNAME);
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "gtifile", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "batch"))
+   {
+      inp_p->batch = clgetb("batch");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "batch", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "nthreads"))
+   {
+      inp_p->nthreads = clgeti("nthreads");
+      if (inp_p->nthreads < 1)
+      {
+         inp_p->nthreads = 1;
+      }
+      else if (inp_p->nthreads > HPE_MAX_THREADS)
+      {
+         inp_p->nthreads = HPE_MAX_THREADS;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "nthreads", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "writequeue"))
+   {
+      inp_p->writequeue = clgeti("writequeue");
+      if (inp_p->writequeue < 0)
+      {
+         inp_p->writequeue = 0;
+      }
+      else if (inp_p->writequeue > HPE_MAX_WRITEQUEUE)
+      {
+         inp_p->writequeue = HPE_MAX_WRITEQUEUE;
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "writequeue", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "prefetch"))
+   {
+      inp_p->prefetch = clgetb("prefetch");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "prefetch", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "nprocs"))
+   {
+      inp_p->nprocs = clgeti("nprocs");
+      if (inp_p->nprocs < 1)
+      {
+         inp_p->nprocs = 1;
+      }
+      else if (inp_p->nprocs > HPE_MAX_PROCS)
+      {
+         inp_p->nprocs = HPE_MAX_PROCS;
+      }
+
+      /* (10/2026) pixlib draws from one sequence per process, so the
+       * random numbers would depend on how the files are shared out */
+      if ((inp_p->nprocs > 1) && !inp_p->rand_counter)
+      {
+         dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Custom,
+            "ERROR: rand_gen=pixlib is not supported with nprocs > 1; "
+            "use rand_gen=counter or nprocs=1.");
+      }
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "nprocs", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "fastread"))
+   {
+      inp_p->fastread = clgetb("fastread");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "fastread", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "fastmath"))
+   {
+      inp_p->fastmath = clgetb("fastmath");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "fastmath", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "fastsky"))
+   {
+      inp_p->fastsky = clgetb("fastsky");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "fastsky", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "aspstore"))
+   {
+      inp_p->aspstore = clgetb("aspstore");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "aspstore", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "fastchip"))
+   {
+      inp_p->fastchip = clgetb("fastchip");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "fastchip", "hrc_process_events.par");
+   }
+   if (paccess(PFFile, "chipcheck"))
+   {
+      inp_p->chipcheck = clgeti("chipcheck");
+   }
+   else
+   {
+      /* parameter does not exist- push error message onto stack */
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Generic,
+               "chipcheck", "hrc_process_events.par");
+   }
    if (paccess(PFFile, "clobber"))
    {
       inp_p->clobber  = clgetb("clobber");
@@ -665,6 +922,9 @@ void load_input_parameters(
  
 void hrc_process_evt_file_cleanup(EVENT_SETUP_P_T evt_set_p)
 {
+   /* write any buffered output rows before the file is closed */
+   flush_hrc_events(evt_set_p);
+
    if ((evt_set_p->primary != evt_set_p->extension) &&
        (evt_set_p->primary != NULL))
    {
@@ -704,4 +964,9 @@ void hrc_process_evt_file_cleanup(EVENT_SETUP_P_T evt_set_p)
       free(evt_set_p->dim);
       evt_set_p->dim = NULL; 
    }
+   /* free dynamic memory for the write plan and row buffers */
+   deallocate_write_plan(&evt_set_p->plan);
+
+   /* unmap an input file read directly (fastread) */
+   close_fits_map(&evt_set_p->fits_p);
 }
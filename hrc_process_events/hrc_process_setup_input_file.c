@@ -41,6 +41,14 @@ JCC(11/2002)- if ra/dec_nom not get from obsfile, then get them from evt1 infile
         -add hpePrintErr()
 10/2009-get mjd_obs from evtfile for dph new hrcS gain table. 
        -rename MAX_INST_KYWRD_LEN to HPE_LEN_80.
+10/2026-move the opening of the file and the column set up to
+        open_input_event_file(), which uses neither the parameters nor
+        the error list, so the prefetch thread can open the next input
+        file; a file it opened (evtin_p->prefetched) is not opened again.
+10/2026-map a plain FITS input file (evtin_p->fastread) once its columns
+        are set up.
+10/2026-unmap the input columns whose fields are not read
+        (project_input_columns()).
 *H***********************************************************************/
 
 #include <stdio.h>
@@ -51,19 +59,19 @@ JCC(11/2002)- if ra/dec_nom not get from obsfile, then get them from evt1 infile
 #define HRC_PROCESS_EVENTS_H
 #endif
 
-void hrc_process_setup_input_file(
-   EVENT_SETUP_P_T evtin_p,   /* I/O - input event file housekeeping ptr*/
-   INPUT_PARMS_P_T inp_p,     /* I/O - input parameter/run data pointer */ 
-   STATISTICS_P_T  stat_p,    /* O   - statistics data structure ptr    */
-   dsErrList*      hpe_err_p) /* O   - error list pointer               */
+/* -----------------------------------------------------------------------
+ * 10/2026: open the input event file and set up its column descriptors,
+ *          data types and mappings. FALSE is returned if the memory could
+ *          not be allocated. Called by hrc_process_setup_input_file() or
+ *          by the prefetch thread (input_prefetch_functions.c).
+ * ----------------------------------------------------------------------- */
+boolean open_input_event_file(
+   EVENT_SETUP_P_T evtin_p)   /* I/O - input event file housekeeping ptr*/
 {
    short   rr, cc; 
    char**  in_names;       /* input evt file col names    */
    boolean alloc_failure = FALSE; 
 
-   /* update statistical file counts */
-   stat_p->num_files_in++;
-
   /* ------------------------------------------------------------------
    * 1/2009: assume "infile-stack & infile-access were already checked 
    *         in hpe.c.  So, we won't need to verify them again here.  
@@ -126,17 +134,10 @@ void hrc_process_setup_input_file(
       if ((evtin_p->desc == NULL) || (in_names == NULL) ||
          (evtin_p->mapping == NULL) || alloc_failure)
       {
-         dsErrAdd(hpe_err_p, dsALLOCERR, Individual, Custom,
-            "ERROR: Memory allocation failed setting up input event file.");
+         alloc_failure = TRUE;
       }
       else
       {
-         char    telescop[HPE_LEN_80];
-         char    datamode[HPE_LEN_80];
-         char    detnam[HPE_LEN_80]; 
-         double  time_val;
-         double  evt_ra_nom, evt_dec_nom ;   /* 11/2002 */
-
          for (cc = rr = 0; rr < temp_cols; rr++)
          {
             if (temp_dim[rr] == 1)
@@ -184,14 +185,58 @@ void hrc_process_setup_input_file(
          /* set up mappings */
          parse_hrc_evt_columns(in_names, evtin_p->num_cols, evtin_p->mapping); 
 
+         /* (10/2026) drop the columns no stage or output uses */
+         project_input_columns(evtin_p);
+
          for (rr = evtin_p->num_cols; rr--; )
          {
-            inp_p->scl_xsts |= (evtin_p->mapping[rr] == HDET_AMP_SF);
             if (in_names[rr])
             {
                free(in_names[rr]);
             } 
          }
+         free(in_names); 
+      }
+
+      /* (10/2026) decode plain FITS columns from a memory map */
+      if (!alloc_failure && evtin_p->fastread)
+      {
+         evtin_p->fits_p = open_fits_map(evtin_p);
+      }
+
+      return (!alloc_failure);
+
+} /* end: open_input_event_file() */
+
+
+void hrc_process_setup_input_file(
+   EVENT_SETUP_P_T evtin_p,   /* I/O - input event file housekeeping ptr*/
+   INPUT_PARMS_P_T inp_p,     /* I/O - input parameter/run data pointer */ 
+   STATISTICS_P_T  stat_p,    /* O   - statistics data structure ptr    */
+   dsErrList*      hpe_err_p) /* O   - error list pointer               */
+{
+   short   rr; 
+
+   /* update statistical file counts */
+   stat_p->num_files_in++;
+
+      if (!evtin_p->prefetched && !open_input_event_file(evtin_p))
+      {
+         dsErrAdd(hpe_err_p, dsALLOCERR, Individual, Custom,
+            "ERROR: Memory allocation failed setting up input event file.");
+      }
+      else
+      {
+         char    telescop[HPE_LEN_80];
+         char    datamode[HPE_LEN_80];
+         char    detnam[HPE_LEN_80]; 
+         double  time_val;
+         double  evt_ra_nom, evt_dec_nom ;   /* 11/2002 */
+
+         for (rr = evtin_p->num_cols; rr--; )
+         {
+            inp_p->scl_xsts |= (evtin_p->mapping[rr] == HDET_AMP_SF);
+         }
 
 /****
          if (dmKeyRead_d(evtin_p->extension, inp_p->time_start, &time_val) 
@@ -369,8 +414,6 @@ void hrc_process_setup_input_file(
 
          /* determine if data dependencies have been met */
          dependency_check_hrc(inp_p, stat_p, hpe_err_p);
-
-         free(in_names); 
       }
 
 } /* end: hrc_process_setup_input_file() */
@@ -49,6 +49,8 @@ JCC(4/2003)-add WIDTHRES key for tapRing
 (8/2005)-fixed stkExpand for '/path/a,/path/b' format
 10/2009-dph/fap new gain files affect PI (see 'Notes on outCol PI')
 1/2010-add hpeSetRang_s and hpe_set_ranges.
+10/2026-compile the write plan of the output columns (compile_write_plan).
+10/2026-buffer HDET_BLOCK_ROWS output rows per column.
 *H***********************************************************************/
  
 /* hrc_process_events.h  includes delib.h */
@@ -390,6 +392,10 @@ void hrc_process_setup_output_file(
             { 
                /* JCC(2/2003) - remove EventKey from hrc_setup_columns for new hdrlib */
                hrc_setup_columns(evtout_p, inp_p, out_names, hpe_err_p); 
+
+               /* (10/2026) writer, event field and row buffer of each */
+               /* output column                                         */
+               compile_write_plan(evtout_p, HDET_BLOCK_ROWS, hpe_err_p);
    
                /* write history comments */
 	       put_param_hist_info(evtout_p->extension, "hrc_process_events", 
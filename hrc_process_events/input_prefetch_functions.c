@@ -0,0 +1,345 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: input_prefetch_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file input_prefetch_functions.c contains the following modules
+  used by hrc_process_events() to open the next input file of the stack
+  while the current one is processed (prefetch = yes):
+
+        allocate_input_prefetch()
+        start_input_prefetch()
+        take_input_prefetch()
+        deallocate_input_prefetch()
+
+  Once an input file is set up, start_input_prefetch() starts a thread
+  which opens the next file of the stack and sets up its columns
+  (open_input_event_file()) and, when batch=yes, reads its first block
+  of rows. When the next file comes up, take_input_prefetch() waits for
+  the thread and hands the opened file to hrc_process_setup_input_file(),
+  which then only reads the header keys.
+
+* NOTES:
+
+  The prefetch thread neither changes the parameters nor adds to the
+  error list. If it could not open the file, allocate the block or read
+  the rows, the file (or block) is dropped and opened (or read) again
+  by the calling thread, which reports the error.
+
+  The datamodel is not thread safe, so the prefetch thread holds the
+  datamodel lock (lock_datamodel(), see event_writer_functions.c) while
+  it opens the file and reads the block. The calling thread holds that
+  lock while it processes the stack and releases it during the stages
+  shared out over a batch and while it waits for a thread (the joins
+  below), which is when the next file is opened.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - map the file opened ahead when fastread is set.
+  10/2026 - read only the input fields used by the run.
+  10/2026 - read the first block of the time window (tmin/tmax).
+  10/2026 - open the file and read the block holding the datamodel lock.
+*H***********************************************************************/
+
+#include <time.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef ADC_COOR_DEFS_H
+#include "adc_corr_defs.h"
+#define ADC_COOR_DEFS_H
+#endif
+
+#ifndef EVENT_BATCH_DEFS_H
+#include "event_batch_defs.h"
+#endif
+
+static void  drop_input_prefetch(HPE_PREFETCH_P_T);
+static void* prefetch_thread_main(void*);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_input_prefetch() sets up the input prefetch. A
+  NULL pointer is returned, and an error added to the error list, if
+  the memory could not be allocated; the input files are then opened by
+  the calling thread.
+
+*************************************************************************/
+
+HPE_PREFETCH_P_T allocate_input_prefetch(
+   INPUT_PARMS_P_T inp_p,     /* I - input parameters                 */
+   dsErrList*      err_p)     /* O - error list pointer               */
+{
+   HPE_PREFETCH_P_T pf_p;
+
+   if ((pf_p = (HPE_PREFETCH_P_T) calloc(1, sizeof(HPE_PREFETCH_T))) == NULL)
+   {
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the input prefetch.");
+   }
+   else
+   {
+      pf_p->block_rows = (inp_p->batch) ? HDET_BLOCK_ROWS : 0;
+      pf_p->rowstart = inp_p->rowstart;
+      pf_p->rowstop = inp_p->rowstop;
+      pf_p->tmin = inp_p->tmin;
+      pf_p->tmax = inp_p->tmax;
+      pf_p->fastread = (inp_p->fastread && inp_p->batch);
+      pf_p->read_field = inp_p->read_field;
+   }
+
+   return (pf_p);
+} /* end: allocate_input_prefetch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine start_input_prefetch() starts a thread which opens the
+  specified input file. The prefetch takes over the file name, which
+  may be NULL (end of the stack). If the thread could not be started,
+  the file is opened later by the calling thread.
+
+*************************************************************************/
+
+void start_input_prefetch(
+   HPE_PREFETCH_P_T pf_p,     /* I/O - input prefetch                 */
+   char*            file)     /* I   - input file name (freed here)   */
+{
+   if (pf_p == NULL)
+   {
+      if (file != NULL)
+      {
+         free(file);
+      }
+      return;
+   }
+
+   drop_input_prefetch(pf_p);
+
+   if (file != NULL)
+   {
+      pf_p->file = file;
+      pf_p->evt.file = file;
+      pf_p->evt.fastread = pf_p->fastread;
+      pf_p->evt.read_field = pf_p->read_field;
+
+      if (pthread_create(&pf_p->tid, NULL, prefetch_thread_main, pf_p) == 0)
+      {
+         pf_p->running = TRUE;
+         pf_p->num_started++;
+      }
+      else
+      {
+         drop_input_prefetch(pf_p);
+      }
+   }
+} /* end: start_input_prefetch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine take_input_prefetch() waits for the prefetch thread
+  (releasing the datamodel lock meanwhile) and, if it opened the
+  specified input file, moves the opened file into the input file info
+  (setting evtin_p->prefetched) and, if read, its first block of rows
+  into *blk_pp. FALSE is returned if the file was not opened ahead.
+
+*************************************************************************/
+
+boolean take_input_prefetch(
+   HPE_PREFETCH_P_T pf_p,     /* I/O - input prefetch                 */
+   EVENT_SETUP_P_T  evtin_p,  /* I/O - input event file info          */
+   EVENT_BLOCK_P_T* blk_pp)   /* O   - first block of rows (or NULL)  */
+{
+   struct timespec t0;
+   struct timespec t1;
+   char*   file;
+   boolean taken = FALSE;
+
+   if ((pf_p == NULL) || !pf_p->running)
+   {
+      return (FALSE);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &t0);
+   unlock_datamodel();
+   pthread_join(pf_p->tid, NULL);
+   lock_datamodel();
+   pf_p->running = FALSE;
+   clock_gettime(CLOCK_MONOTONIC, &t1);
+   pf_p->wait_s += (double) (t1.tv_sec - t0.tv_sec) +
+                   (1.0e-9 * (double) (t1.tv_nsec - t0.tv_nsec));
+
+   if (pf_p->opened && (strcmp(pf_p->file, evtin_p->file) == 0))
+   {
+      file = evtin_p->file;
+      *evtin_p = pf_p->evt;
+      evtin_p->file = file;
+      evtin_p->prefetched = TRUE;
+      memset(&pf_p->evt, 0, sizeof(EVENT_SETUP_T));
+
+      *blk_pp = pf_p->blk_p;
+      pf_p->blk_p = NULL;
+
+      pf_p->num_used++;
+      taken = TRUE;
+   }
+
+   drop_input_prefetch(pf_p);
+
+   return (taken);
+} /* end: take_input_prefetch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_input_prefetch() waits for the prefetch thread,
+  closes a file opened ahead but not used, writes the number of files
+  opened ahead and the time waited for them to the logfile (verbose > 0)
+  and frees the prefetch, setting its pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_input_prefetch(
+   HPE_PREFETCH_P_T* pf_pp,   /* I/O - input prefetch pointer         */
+   FILE*             log_p,   /* I   - debug log                      */
+   int               debug)   /* I   - debug level                    */
+{
+   HPE_PREFETCH_P_T pf_p = *pf_pp;
+
+   if (pf_p == NULL)
+   {
+      return;
+   }
+
+   drop_input_prefetch(pf_p);
+
+   if ((debug > DEBUG_LEVEL_0) && (log_p != NULL))
+   {
+      fprintf(log_p, "\n ============ INPUT PREFETCH ===========\n");
+      fprintf(log_p, "FILES   opened ahead = %ld   used = %ld"
+              "   waited = %.3f s\n", pf_p->num_started, pf_p->num_used,
+              pf_p->wait_s);
+   }
+
+   free(pf_p);
+   *pf_pp = NULL;
+} /* end: deallocate_input_prefetch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine drop_input_prefetch() waits for the prefetch thread, if
+  running (releasing the datamodel lock meanwhile), and closes and frees
+  whatever it opened.
+
+*************************************************************************/
+
+static void drop_input_prefetch(
+   HPE_PREFETCH_P_T pf_p)     /* I/O - input prefetch                 */
+{
+   if (pf_p->running)
+   {
+      unlock_datamodel();
+      pthread_join(pf_p->tid, NULL);
+      lock_datamodel();
+      pf_p->running = FALSE;
+   }
+
+   deallocate_event_block(&pf_p->blk_p);
+   hrc_process_evt_file_cleanup(&pf_p->evt);
+   memset(&pf_p->evt, 0, sizeof(EVENT_SETUP_T));
+   pf_p->opened = FALSE;
+
+   if (pf_p->file != NULL)
+   {
+      free(pf_p->file);
+      pf_p->file = NULL;
+   }
+} /* end: drop_input_prefetch */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine prefetch_thread_main() is run by the prefetch thread.
+  Holding the datamodel lock, it opens the input file, sets up its
+  columns and, if block_rows > 0, reads the first block of rows to be
+  processed.
+
+*************************************************************************/
+
+static void* prefetch_thread_main(
+   void* arg)                 /* I - input prefetch                   */
+{
+   HPE_PREFETCH_P_T pf_p = (HPE_PREFETCH_P_T) arg;
+   EVENT_SETUP_P_T  evtin_p = &pf_p->evt;
+
+   lock_datamodel();
+   pf_p->opened = open_input_event_file(evtin_p);
+
+   if (pf_p->opened && (pf_p->block_rows > 0) &&
+       (dmTableGetRowNo(evtin_p->extension) != dmBADROW))
+   {
+      /* same rows as the first block read by hrc_process_events() */
+      long first_row = pf_p->rowstart;
+
+      evtin_p->num_rows = dmTableGetNoRows(evtin_p->extension);
+      if ((pf_p->rowstop > 0) && (pf_p->rowstop < evtin_p->num_rows))
+      {
+         evtin_p->num_rows = pf_p->rowstop;
+      }
+      if ((pf_p->tmin > 0.0) || (pf_p->tmax > 0.0))
+      {
+         find_time_window(evtin_p, pf_p->tmin, pf_p->tmax, &first_row);
+      }
+
+      if ((first_row <= evtin_p->num_rows) &&
+          ((pf_p->blk_p = allocate_event_block(evtin_p, pf_p->block_rows,
+                                               NULL)) != NULL) &&
+          (load_event_block(evtin_p, pf_p->blk_p, first_row, NULL) == 0))
+      {
+         deallocate_event_block(&pf_p->blk_p);
+      }
+   }
+   unlock_datamodel();
+
+   return (NULL);
+} /* end: prefetch_thread_main */
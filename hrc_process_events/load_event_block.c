@@ -0,0 +1,355 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: load_event_block.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file load_event_block.c contains the following modules used by
+  hrc_process_events() to read the input event file a block of rows
+  at a time instead of one cell at a time:
+
+        allocate_event_block()
+        load_event_block()
+        deallocate_event_block()
+        event_block_kind()
+
+  Each input column component is read with a single dmGetScalars call
+  per block into a contiguous buffer of the type load_event_data()
+  requests for that column, so the values seen by the event record are
+  identical to the per-cell dmGetScalar path. Bit columns and vector
+  columns are left to load_event_data(), which reads them from the
+  current row. When the input file is memory mapped (fastread = yes),
+  the columns it can decode are read from the map instead
+  (read_fits_map_column()).
+
+* NOTES:
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - no error is added if the error list pointer is NULL (the
+            prefetch thread reads the first block of the next file).
+  10/2026 - decode the columns of a memory mapped FITS file directly.
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine event_block_kind() returns the buffer type (HDET_BLK_*)
+  used to hold an input column with the specified mapping and data type.
+  The buffer type must match the dmGetScalar accessor load_event_data()
+  uses for the same mapping.
+
+*************************************************************************/
+
+short event_block_kind(
+   short      mapping,      /* I - HDET_* mapping of the column       */
+   dmDataType type)         /* I - data type of the column            */
+{
+   short kind;
+
+   switch (mapping)
+   {
+      case HDET_TIME:
+         kind = HDET_BLK_DOUBLE;
+      break;
+
+      case HDET_MJR_FRAME:
+      case HDET_MNR_FRAME:
+      case HDET_RAW_X:
+      case HDET_RAW_Y:
+      case HDET_FPZ:
+      case HDET_TICK:
+      case HDET_SCIFR:
+         kind = HDET_BLK_LONG;
+      break;
+
+      case HDET_STATUS:
+         /* 32 bit status columns are assembled from bits row by row */
+         kind = (type == dmLONG) ? HDET_BLK_LONG : HDET_BLK_ROW;
+      break;
+
+      case HDET_VETO_STATUS:
+      case HDET_VETO_STT:
+      case HDET_E_TRIG:
+      case HDET_DET_ID:
+         kind = (type == dmBIT) ? HDET_BLK_ROW : HDET_BLK_SHORT;
+      break;
+
+      case HDET_SKY:
+         kind = HDET_BLK_ROW;
+      break;
+
+      case HDET_EVENT:
+      case HDET_CP_X:
+      case HDET_CP_Y:
+      case HDET_AX_1:
+      case HDET_AX_2:
+      case HDET_AX_3:
+      case HDET_AY_1:
+      case HDET_AY_2:
+      case HDET_AY_3:
+      case HDET_PHA:
+      case HDET_EVENT_STATUS:
+      case HDET_X_POS:
+      case HDET_Y_POS:
+      case HDET_SUMAMPS:
+      case HDET_CHIP_ID:
+      case HDET_DUMMY:
+      case HDET_PI:
+      case HDET_PHASCALE:
+      case HDET_RAWPHA:
+      case HDET_DET_X:
+      case HDET_DET_Y:
+      case HDET_TDET_X:
+      case HDET_TDET_Y:
+      case HDET_SKY_X:
+      case HDET_SKY_Y:
+      case HDET_CHIP_X:
+      case HDET_CHIP_Y:
+      case HDET_EVTCTR:
+      case HDET_AMP_SF:
+      case HDET_SUBMJF:
+      case HDET_MRF:
+      case HDET_STOPMNF:
+         kind = HDET_BLK_SHORT;
+      break;
+
+      default:
+         /* column is not loaded into the event record */
+         kind = HDET_BLK_SKIP;
+      break;
+   }
+
+   return (kind);
+} /* end: event_block_kind */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine allocate_event_block() allocates an event block able to
+  hold 'size' rows of every input column that load_event_data() uses.
+  A NULL pointer is returned and an error is added to the error list (if
+  any) if the memory could not be allocated.
+
+*************************************************************************/
+
+EVENT_BLOCK_P_T allocate_event_block(
+   EVENT_SETUP_P_T evtin_p,   /* I - input event file information    */
+   long            size,      /* I - number of rows per block        */
+   dsErrList*      err_p)     /* O - error list pointer              */
+{
+   EVENT_BLOCK_P_T blk_p = NULL;
+   boolean alloc_failure = FALSE;
+   int     cc;
+
+   if ((blk_p = (EVENT_BLOCK_P_T) calloc(1, sizeof(EVENT_BLOCK_T))) != NULL)
+   {
+      blk_p->size = size;
+      blk_p->num_cols = evtin_p->num_cols;
+      blk_p->kind = (short*) calloc(evtin_p->num_cols, sizeof(short));
+      blk_p->buf = (void**) calloc(evtin_p->num_cols, sizeof(void*));
+
+      if ((blk_p->kind == NULL) || (blk_p->buf == NULL))
+      {
+         alloc_failure = TRUE;
+      }
+
+      for (cc = 0; (cc < evtin_p->num_cols) && !alloc_failure; cc++)
+      {
+         blk_p->kind[cc] = event_block_kind(evtin_p->mapping[cc],
+                                            evtin_p->types[cc]);
+         switch (blk_p->kind[cc])
+         {
+            case HDET_BLK_SHORT:
+               blk_p->buf[cc] = calloc(size, sizeof(short));
+            break;
+
+            case HDET_BLK_LONG:
+               blk_p->buf[cc] = calloc(size, sizeof(long));
+            break;
+
+            case HDET_BLK_DOUBLE:
+               blk_p->buf[cc] = calloc(size, sizeof(double));
+            break;
+
+            case HDET_BLK_ROW:
+               blk_p->row_access = TRUE;
+            break;
+
+            default:
+            break;
+         }
+
+         if ((blk_p->kind[cc] != HDET_BLK_SKIP) &&
+             (blk_p->kind[cc] != HDET_BLK_ROW) && (blk_p->buf[cc] == NULL))
+         {
+            alloc_failure = TRUE;
+         }
+      }
+   }
+   else
+   {
+      alloc_failure = TRUE;
+   }
+
+   if (alloc_failure)
+   {
+      deallocate_event_block(&blk_p);
+      if (err_p != NULL)
+      {
+         dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+            "ERROR: Memory allocation failed setting up input event block.");
+      }
+   }
+
+   return (blk_p);
+} /* end: allocate_event_block */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine load_event_block() reads up to blk_p->size rows, starting
+  at table row 'first_row', of every buffered input column. The number
+  of rows loaded is returned; 0 is returned at the end of the table or
+  if a column could not be read, in which case an error is added to the
+  error list (if any).
+
+*************************************************************************/
+
+long load_event_block(
+   EVENT_SETUP_P_T evtin_p,   /* I   - input event file information  */
+   EVENT_BLOCK_P_T blk_p,     /* I/O - event block                   */
+   long            first_row, /* I   - first table row to load       */
+   dsErrList*      err_p)     /* O   - error list pointer            */
+{
+   long nrows = evtin_p->num_rows - first_row + 1;
+   long nread = 0;
+   int  cc;
+
+   if (nrows > blk_p->size)
+   {
+      nrows = blk_p->size;
+   }
+   if (nrows < 0)
+   {
+      nrows = 0;
+   }
+
+   for (cc = 0; (cc < blk_p->num_cols) && (nrows > 0); cc++)
+   {
+      if ((blk_p->buf[cc] != NULL) &&
+          read_fits_map_column(evtin_p->fits_p, cc, blk_p->kind[cc],
+                               blk_p->buf[cc], first_row, nrows))
+      {
+         /* decoded from the memory map (fastread = yes) */
+         continue;
+      }
+
+      switch (blk_p->kind[cc])
+      {
+         case HDET_BLK_SHORT:
+            nread = dmGetScalars_s(evtin_p->desc[cc],
+                       (short*) blk_p->buf[cc], first_row, nrows);
+         break;
+
+         case HDET_BLK_LONG:
+            nread = dmGetScalars_l(evtin_p->desc[cc],
+                       (long*) blk_p->buf[cc], first_row, nrows);
+         break;
+
+         case HDET_BLK_DOUBLE:
+            nread = dmGetScalars_d(evtin_p->desc[cc],
+                       (double*) blk_p->buf[cc], first_row, nrows);
+         break;
+
+         default:
+            nread = nrows;
+         break;
+      }
+
+      if (nread != nrows)
+      {
+         if (err_p != NULL)
+         {
+            dsErrAdd(err_p, dsGENERICERR, Individual, Custom,
+               "ERROR: Unable to read rows %ld to %ld of %s.",
+               first_row, first_row + nrows - 1, evtin_p->file);
+         }
+         nrows = 0;
+      }
+   }
+
+   blk_p->first_row = first_row;
+   blk_p->num_rows = nrows;
+
+   return (nrows);
+} /* end: load_event_block */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_event_block() frees the memory of an event
+  block and sets the block pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_event_block(
+   EVENT_BLOCK_P_T* blk_pp)   /* I/O - event block pointer           */
+{
+   int cc;
+
+   if (*blk_pp != NULL)
+   {
+      if ((*blk_pp)->buf != NULL)
+      {
+         for (cc = 0; cc < (*blk_pp)->num_cols; cc++)
+         {
+            if ((*blk_pp)->buf[cc] != NULL)
+            {
+               free((*blk_pp)->buf[cc]);
+            }
+         }
+         free((*blk_pp)->buf);
+      }
+      if ((*blk_pp)->kind != NULL)
+      {
+         free((*blk_pp)->kind);
+      }
+      free(*blk_pp);
+      *blk_pp = NULL;
+   }
+} /* end: deallocate_event_block */
@@ -34,6 +34,11 @@
  
 * NOTES:
 
+  If blk_p is not NULL the column values are taken from row blk_row of the
+  event block filled by load_event_block(); columns the block does not 
+  buffer are read from the table after positioning it on that row. If 
+  blk_p is NULL every value is read from the current row of the table.
+
   wmclaugh@cfa	Mar 28, 1996  First Version.
 
 * REVISION HISTORY:
@@ -45,6 +50,8 @@
                 outfile from hrc_correct_time).
   JCC(7/2003)-add a new function 'initial_status'
 10/2009 - fix rawpos (see Note)
+10/2026 - read column values from an event block (load_event_block.c)
+          instead of one dmGetScalar call per cell.
 *H**************************************************************************/
 
 #ifndef HRC_PROCESS_EVENTS_H
@@ -52,60 +59,78 @@
 #endif 
 
 
+/* local functions to get a column value of the event being loaded */
+static short  get_evt_s(EVENT_SETUP_P_T, EVENT_BLOCK_P_T, long, int);
+static long   get_evt_l(EVENT_SETUP_P_T, EVENT_BLOCK_P_T, long, int);
+static double get_evt_d(EVENT_SETUP_P_T, EVENT_BLOCK_P_T, long, int);
+
+
 void load_event_data(
    EVENT_SETUP_P_T evtin_p,    /* I - input file information               */
+   EVENT_BLOCK_P_T blk_p,      /* I - input rows block or NULL (see NOTES) */
+   long            blk_row,    /* I - index of the event in blk_p          */
    EVENT_REC_P_T  evt_p)       /* I/O structure holding event data         */
 {
    int count = 0; 
    boolean vstat = FALSE,  
            etrig = FALSE; 
 
+   /* columns that are not buffered are read from the current row */
+   if ((blk_p != NULL) && blk_p->row_access)
+   {
+      dmTableSetRow(evtin_p->extension, blk_p->first_row + blk_row);
+   }
+
    while (count < evtin_p->num_cols)
    {
       switch (evtin_p->mapping[count])    
       {
          case HDET_TIME:
-            evt_p->time = dmGetScalar_d(evtin_p->desc[count]); 
+            evt_p->time = get_evt_d(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_MJR_FRAME: 
-            evt_p->major_frame = dmGetScalar_l(evtin_p->desc[count]); 
+            evt_p->major_frame = 
+               get_evt_l(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_MNR_FRAME: 
-            evt_p->minor_frame = dmGetScalar_l(evtin_p->desc[count]); 
+            evt_p->minor_frame = 
+               get_evt_l(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_EVENT: 
-            evt_p->event = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->event = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_CP_X: 
-            evt_p->cp[HDET_PLANE_X] = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->cp[HDET_PLANE_X] = 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_CP_Y: 
-            evt_p->cp[HDET_PLANE_Y] = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->cp[HDET_PLANE_Y] = 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
          /* JCC(5/11/00) - begin */
          case HDET_AX_1: 
             evt_p->amps_sh[HDET_PLANE_X][HDET_1ST_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             evt_p->amps_dd[HDET_PLANE_X][HDET_1ST_AMP] = 
                (double)(evt_p->amps_sh[HDET_PLANE_X][HDET_1ST_AMP]) ;
          break;
 
          case HDET_AX_2: 
             evt_p->amps_sh[HDET_PLANE_X][HDET_2ND_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             evt_p->amps_dd[HDET_PLANE_X][HDET_2ND_AMP] = 
                (double)(evt_p->amps_sh[HDET_PLANE_X][HDET_2ND_AMP]) ;
          break;
          
          case HDET_AX_3: 
             evt_p->amps_sh[HDET_PLANE_X][HDET_3RD_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             /* evt_p->amps_3RD_raw[HDET_PLANE_X] = evt_p->amps[HDET_PLANE_X][HDET_3RD_AMP] ;*/
             evt_p->amps_dd[HDET_PLANE_X][HDET_3RD_AMP] = 
                (double)(evt_p->amps_sh[HDET_PLANE_X][HDET_3RD_AMP]) ; 
@@ -113,21 +138,21 @@ void load_event_data(
          
          case HDET_AY_1: 
             evt_p->amps_sh[HDET_PLANE_Y][HDET_1ST_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             evt_p->amps_dd[HDET_PLANE_Y][HDET_1ST_AMP] =
                (double)(evt_p->amps_sh[HDET_PLANE_Y][HDET_1ST_AMP]) ; 
          break;
          
          case HDET_AY_2: 
             evt_p->amps_sh[HDET_PLANE_Y][HDET_2ND_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             evt_p->amps_dd[HDET_PLANE_Y][HDET_2ND_AMP] =
                (double)(evt_p->amps_sh[HDET_PLANE_Y][HDET_2ND_AMP]) ; 
          break;
 
          case HDET_AY_3: 
             evt_p->amps_sh[HDET_PLANE_Y][HDET_3RD_AMP] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
             /* evt_p->amps_3RD_raw[HDET_PLANE_Y] = evt_p->amps[HDET_PLANE_Y][HDET_3RD_AMP] ; */
             evt_p->amps_dd[HDET_PLANE_Y][HDET_3RD_AMP] =
                (double)(evt_p->amps_sh[HDET_PLANE_Y][HDET_3RD_AMP]) ;
@@ -135,7 +160,7 @@ void load_event_data(
          /* JCC(5/11/00) - end   */
 
          case HDET_PHA: 
-            evt_p->pha = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->pha = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_VETO_STATUS: 
@@ -145,7 +170,8 @@ void load_event_data(
             }
             else
             {
-               evt_p->veto_status = dmGetScalar_s(evtin_p->desc[count]); 
+               evt_p->veto_status = 
+                  get_evt_s(evtin_p, blk_p, blk_row, count); 
             } 
 
             if (!vstat)
@@ -165,7 +191,7 @@ void load_event_data(
          break;
 
          case HDET_EVENT_STATUS: 
-            evt_p->event_status = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->event_status = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          /*----------------------------------------------------------*/
@@ -177,7 +203,7 @@ void load_event_data(
             if (evtin_p->types[count] == dmLONG)
             {  
                /* add  "|"   */
-               evt_p->status |= dmGetScalar_l(evtin_p->desc[count]);
+               evt_p->status |= get_evt_l(evtin_p, blk_p, blk_row, count);
             } 
             else
             {
@@ -192,35 +218,35 @@ void load_event_data(
          break; 
 
          case HDET_X_POS:
-            evt_p->xpos = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->xpos = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_Y_POS:
-            evt_p->ypos = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->ypos = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
  
          case HDET_SUMAMPS:
-            evt_p->sum_amps = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->sum_amps = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_CHIP_ID:
-            evt_p->chipid = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->chipid = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_DUMMY:
-            evt_p->dummy = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->dummy = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_PI:
-            evt_p->pi = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->pi = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_PHASCALE:
-            evt_p->phascale = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->phascale = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_RAWPHA:
-            evt_p->rawpha = dmGetScalar_s(evtin_p->desc[count]); 
+            evt_p->rawpha = get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
 
@@ -232,43 +258,43 @@ void load_event_data(
  *   Therefore, this fix should NOT affect any hpe's output.
  */
          case HDET_RAW_X:
-evt_p->rawpos[HDET_PLANE_X]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change _s to _l*/
+evt_p->rawpos[HDET_PLANE_X]=get_evt_l(evtin_p, blk_p, blk_row, count);/*10/2009-change _s to _l*/
          break; 
 
          case HDET_RAW_Y:
-evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change _s to _l*/
+evt_p->rawpos[HDET_PLANE_Y]=get_evt_l(evtin_p, blk_p, blk_row, count);/*10/2009-change _s to _l*/
          break; 
 /*end:*/
 
 
          case HDET_DET_X:
             evt_p->detpos[HDET_PLANE_X] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_DET_Y:
             evt_p->detpos[HDET_PLANE_Y] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_TDET_X:
             evt_p->tdetpos[HDET_PLANE_X] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_TDET_Y:
             evt_p->tdetpos[HDET_PLANE_Y] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_SKY_X:
             evt_p->skypos[HDET_PLANE_X] =
-               dmGetScalar_s(evtin_p->desc[count]);
+               get_evt_s(evtin_p, blk_p, blk_row, count);
          break;
  
          case HDET_SKY_Y:
             evt_p->skypos[HDET_PLANE_Y] =
-               dmGetScalar_s(evtin_p->desc[count]);
+               get_evt_s(evtin_p, blk_p, blk_row, count);
          break;
 
          case HDET_SKY:
@@ -277,37 +303,37 @@ evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change
 
          case HDET_FPZ:
             evt_p->skypos[HDET_PLANE_Z] = 
-               dmGetScalar_l(evtin_p->desc[count]); 
+               get_evt_l(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_CHIP_X:
             evt_p->chippos[HDET_PLANE_X] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_CHIP_Y:
             evt_p->chippos[HDET_PLANE_Y] = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
    
          case HDET_TICK:
             evt_p->tick = 
-               dmGetScalar_l(evtin_p->desc[count]); 
+               get_evt_l(evtin_p, blk_p, blk_row, count); 
          break; 
    
          case HDET_SCIFR:
             evt_p->scifr = 
-               dmGetScalar_l(evtin_p->desc[count]); 
+               get_evt_l(evtin_p, blk_p, blk_row, count); 
          break; 
    
          case HDET_EVTCTR:
             evt_p->evtctr = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
    
          case HDET_AMP_SF:
             evt_p->amp_sf = 
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_VETO_STT:
@@ -318,7 +344,7 @@ evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change
             else
             {
                evt_p->veto_stt = 
-                  dmGetScalar_s(evtin_p->desc[count]); 
+                  get_evt_s(evtin_p, blk_p, blk_row, count); 
             } 
             if (!vstat)
             {
@@ -341,14 +367,14 @@ evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change
             else 
             {
             
-               evt_p->e_trig = dmGetScalar_s(evtin_p->desc[count]); 
+               evt_p->e_trig = get_evt_s(evtin_p, blk_p, blk_row, count); 
             } 
             etrig = TRUE; 
          break; 
    
          case HDET_SUBMJF:
             evt_p->submjf =
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break; 
 
          case HDET_DET_ID:
@@ -358,18 +384,18 @@ evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change
             } 
             else
             {
-               evt_p->det_id = dmGetScalar_s(evtin_p->desc[count]); 
+               evt_p->det_id = get_evt_s(evtin_p, blk_p, blk_row, count); 
             } 
          break;
 
          case HDET_MRF:
             evt_p->mrf =
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
          case HDET_STOPMNF:
             evt_p->stopmnf =
-               dmGetScalar_s(evtin_p->desc[count]); 
+               get_evt_s(evtin_p, blk_p, blk_row, count); 
          break;
 
    
@@ -399,6 +425,52 @@ evt_p->rawpos[HDET_PLANE_Y]=dmGetScalar_l(evtin_p->desc[count]);/*10/2009-change
 } /* load_event_data */
 
 
+/*******************************************************************
+ * 10/2026
+ * -return a column value of the event at blk_row of the event block.
+ *  Columns that are not buffered in the block (or all columns if no
+ *  block is used) are read from the current row of the input table.
+ *******************************************************************/
+static short get_evt_s(
+   EVENT_SETUP_P_T evtin_p,    /* I - input file information */
+   EVENT_BLOCK_P_T blk_p,      /* I - input rows block       */
+   long            blk_row,    /* I - row index in blk_p     */
+   int             col)        /* I - input column index     */
+{
+   if ((blk_p != NULL) && (blk_p->kind[col] == HDET_BLK_SHORT))
+   {
+      return (((short*) blk_p->buf[col])[blk_row]);
+   }
+   return (dmGetScalar_s(evtin_p->desc[col]));
+}
+
+static long get_evt_l(
+   EVENT_SETUP_P_T evtin_p,    /* I - input file information */
+   EVENT_BLOCK_P_T blk_p,      /* I - input rows block       */
+   long            blk_row,    /* I - row index in blk_p     */
+   int             col)        /* I - input column index     */
+{
+   if ((blk_p != NULL) && (blk_p->kind[col] == HDET_BLK_LONG))
+   {
+      return (((long*) blk_p->buf[col])[blk_row]);
+   }
+   return (dmGetScalar_l(evtin_p->desc[col]));
+}
+
+static double get_evt_d(
+   EVENT_SETUP_P_T evtin_p,    /* I - input file information */
+   EVENT_BLOCK_P_T blk_p,      /* I - input rows block       */
+   long            blk_row,    /* I - row index in blk_p     */
+   int             col)        /* I - input column index     */
+{
+   if ((blk_p != NULL) && (blk_p->kind[col] == HDET_BLK_DOUBLE))
+   {
+      return (((double*) blk_p->buf[col])[blk_row]);
+   }
+   return (dmGetScalar_d(evtin_p->desc[col]));
+}
+
+
 /*******************************************************************
  *JCC(7/2003)
  * -initalize status bits 6 to 15 and 26 
@@ -0,0 +1,93 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+ 
+* FILE NAME: t_hpe_merge_events.c
+ 
+* DEVELOPEMENT: tools
+ 
+* DESCRIPTION:
+ 
+  Unix main for the hpe_merge_events program, which merges the partial
+  event files written by hrc_process_events runs on separate row ranges
+  of the same input.
+
+* NOTES:
+ 
+* REVISION HISTORY:
+  10/2026 - initial version.
+ 
+*H***********************************************************************/
+
+
+#include <stdio.h>
+#include <parameter.h>
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+#ifndef HPE_MERGE_DEFS_H
+#include "hpe_merge_defs.h"
+#endif
+
+
+int main(int argc, char** argv)
+{
+  dsErrGroup groups_to_add_t = dsPTGRPERR;
+  dsErrCode fail_status_t = dsNOERR;
+
+  /* set the jump buffer, for the error lib.  The error library performs
+     signal handling, and must have a place to jump to. */
+  if(setjmp(dserr_jmpbuf) == 0)
+  {
+
+    /* init error handling routine */
+    if((fail_status_t = dsErrInitLib(groups_to_add_t, argv[0])) == dsNOERR)
+    {
+      /* OPEN THE PRAMETER FILE */
+      if(clinit(argv, argc, "rw") == NULL)
+      {
+         fail_status_t = dsOPENPARAMFERR;
+         err_msg(dsOPENPARAMFSTDMSG, "hpe_merge_events.par");
+	 err_msg("ERROR: Parameter library error: %s.\n", paramerrstr());
+      }
+      else
+      {    
+         /* EXECUTE OUR PROGRAM */ 
+         fail_status_t = hpe_merge_events();
+    
+         /* CLOSE PARAMETER FILE AND RETURN TO THE OS */
+         clclose();
+      }
+
+      dsErrCloseLib();
+    }
+
+  } /* end if(setjmp) */
+  else
+  {
+    fail_status_t = dsGENERICERR;
+  }
+
+
+  return (fail_status_t); 
+}
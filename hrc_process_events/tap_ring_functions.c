@@ -57,11 +57,17 @@
 *JCC(7/2003)-reset status bit before reapply tap ring corr.;
 * (11/2008) - add hpe_gt for bugfix.
 (1/2009)-updated comments.
+* 10/2026 - add check_tap_ring_batch(); the same correction on a range of
+*           events, with pow()/sin() evaluated over the corrected axes
+*           together (hpe_fast_pow/hpe_fast_sin when fastmath=yes).
 *H***********************************************************************/
 #ifndef HRC_PROCESS_EVENTS_H
 #include "hrc_process_events.h"
 #endif
 
+/* events per pass of check_tap_ring_batch() (2 axes each) */
+#define TRING_BATCH_CHUNK  64
+
 /**********************************************************************
  * open_tap_ring_file :
  *    Get the column values from the tap ring coefficients file ; 
@@ -381,3 +387,161 @@ void check_tap_ring(
 
    } /* end: for (ii) */
 } /* end: check_tap_ring */
+
+
+/**********************************************************************
+ * check_tap_ring_batch :
+ *
+ *    Applies the tap ring correction of check_tap_ring() to num_evt
+ *    consecutive events, TRING_BATCH_CHUNK events at a time :
+ *         (1)  the conditions are checked for both axes of each event,
+ *              the status bits and amps_tap_flag set, and the axes
+ *              to correct collected ;
+ *         (2)  pow(A2/A1, GAMMA) and sin(theta) are computed for the
+ *              collected axes together, by pow()/sin() or, when
+ *              fastmath=yes, by hpe_fast_pow()/hpe_fast_sin() ;
+ *         (3)  the corrected A3 is computed and clamped to 0..4095.
+ *
+ *    With fastmath=no the amplitudes are the same as check_tap_ring().
+ ***********************************************************************/
+void check_tap_ring_batch(
+    INPUT_PARMS_P_T  inp_p,    /*i: obs_widthres, evt_widthres, fastmath */
+    EVENT_REC_P_T    evt_p,    /*u: first event record                    */
+    long             num_evt,  /*i: number of events                      */
+    TRING_COEFFS_P_T tring_coeffs_p  /* i */  )
+{
+  static const short axis_idx[2] = { HDET_PLANE_X, HDET_PLANE_Y };
+  static const HRC_STATUS_T bad_bit_mask[2] =
+                           { HDET_U_TAP_RING_STS, HDET_V_TAP_RING_STS };
+  static const HRC_STATUS_T widthExceedBit[2] =
+                           { HDET_U_WIALIGN_STS, HDET_V_WIALIGN_STS };
+
+  short  coeffs_idx[2];
+  short  WIDTHRES ;
+  short  pp ;
+  long   first, num_chunk, ii, kk, num_sel ;
+
+  /* the axes to correct in a chunk: (event << 1) | axis */
+  long   sel_index[2 * TRING_BATCH_CHUNK];
+  double ratio[2 * TRING_BATCH_CHUNK];      /* A2/A1               */
+  double gamma[2 * TRING_BATCH_CHUNK];      /* GAMMA of the axis   */
+  double powv[2 * TRING_BATCH_CHUNK];       /* (A2/A1)**GAMMA      */
+  double theta[2 * TRING_BATCH_CHUNK];      /* in radian           */
+  double sinv[2 * TRING_BATCH_CHUNK];       /* sin(theta)          */
+
+  EVENT_REC_P_T e_p;
+  double AMP1, AMP2, AMP3, ttt ;
+  int    sel ;
+
+  coeffs_idx[0] = tring_coeffs_p->U_index;
+  coeffs_idx[1] = tring_coeffs_p->V_index;
+
+  /* obs par overwrites evt1 (see check_tap_ring) */
+  if (inp_p->obs_widthres != NEG_9999 )
+      WIDTHRES =  inp_p->obs_widthres ;
+  else
+      WIDTHRES =  inp_p->evt_widthres ;
+
+  for (first = 0; first < num_evt; first += TRING_BATCH_CHUNK)
+  {
+     num_chunk = get_min(num_evt - first, TRING_BATCH_CHUNK);
+
+     /*--------------------------------------------------
+      * (1) check the conditions of each axis
+      *--------------------------------------------------*/
+     num_sel = 0;
+     for (ii = 0, e_p = &evt_p[first]; ii < num_chunk; ii++, e_p++)
+     {
+        for (pp = 0; pp < 2; pp++)
+        {
+           AMP1 = e_p->amps_dd[axis_idx[pp]][HDET_1ST_AMP];
+           AMP2 = e_p->amps_dd[axis_idx[pp]][HDET_2ND_AMP];
+           AMP3 = e_p->amps_dd[axis_idx[pp]][HDET_3RD_AMP];
+           ttt = tring_coeffs_p->THRESH12[coeffs_idx[pp]] * AMP2 +
+                 tring_coeffs_p->OFFSET[coeffs_idx[pp]] ;
+
+           sel = ((AMP1 >= 0.0) && (AMP2 >= 0.0) && (AMP3 >= 0.0) &&
+                  (e_p->amp_sf == 3) && (hpe_gt(AMP1,AMP3) == 1) &&
+                  (((WIDTHRES != 2) && (hpe_gt(AMP1,ttt) == 1)) ||
+                   ((WIDTHRES == 2) &&
+                    ((widthExceedBit[pp] & e_p->status) == 0))));
+
+           /* reset the status bit before reapplying the correction */
+           e_p->status &= (~bad_bit_mask[pp]) ;
+           e_p->amps_tap_flag[axis_idx[pp]] = (short) sel ;
+
+           if (sel)
+           {
+              e_p->status |= bad_bit_mask[pp];
+              sel_index[num_sel] = ((first + ii) << 1) | pp;
+              ratio[num_sel] = AMP2/AMP1;
+              gamma[num_sel] = tring_coeffs_p->GAMMA[coeffs_idx[pp]];
+              num_sel++;
+           }
+           else
+           {
+              /* no correction: 0 <= A3 <= 4095 */
+              AMP3 = get_min(AMP3, 4095);
+              e_p->amps_dd[axis_idx[pp]][HDET_3RD_AMP] = get_max(AMP3, 0);
+           }
+        }
+     }
+
+     if (num_sel == 0)
+     {
+        continue;
+     }
+
+     /*--------------------------------------------------
+      * (2) pow and sin of the axes to correct
+      *--------------------------------------------------*/
+     if (inp_p->fastmath)
+     {
+        hpe_fast_pow(ratio, gamma, powv, num_sel);
+     }
+     else
+     {
+        for (kk = 0; kk < num_sel; kk++)
+        {
+           powv[kk] = pow(ratio[kk], gamma[kk]);
+        }
+     }
+
+     for (kk = 0; kk < num_sel; kk++)
+     {
+        pp = (short) (sel_index[kk] & 1);
+        AMP2 = evt_p[sel_index[kk] >> 1].amps_dd[axis_idx[pp]][HDET_2ND_AMP];
+        theta[kk] = 2.0*PI_RAD*(AMP2 -
+                    tring_coeffs_p->BETA[coeffs_idx[pp]]*(powv[kk]-1)) /
+                    (tring_coeffs_p->C[coeffs_idx[pp]]*AMP2 +
+                     tring_coeffs_p->D[coeffs_idx[pp]]) ;
+     }
+
+     if (inp_p->fastmath)
+     {
+        hpe_fast_sin(theta, sinv, num_sel);
+     }
+     else
+     {
+        for (kk = 0; kk < num_sel; kk++)
+        {
+           sinv[kk] = sin(theta[kk]);
+        }
+     }
+
+     /*--------------------------------------------------
+      * (3) corrected A3 : 0 <= A3' <= 4095
+      *--------------------------------------------------*/
+     for (kk = 0; kk < num_sel; kk++)
+     {
+        pp = (short) (sel_index[kk] & 1);
+        e_p = &evt_p[sel_index[kk] >> 1];
+        AMP2 = e_p->amps_dd[axis_idx[pp]][HDET_2ND_AMP];
+        AMP3 = e_p->amps_dd[axis_idx[pp]][HDET_3RD_AMP];
+        AMP3 = AMP3 - ((AMP2 + tring_coeffs_p->B[coeffs_idx[pp]]) /
+                       tring_coeffs_p->A[coeffs_idx[pp]]) * sinv[kk] ;
+        AMP3 = get_min(AMP3, 4095);
+        e_p->amps_dd[axis_idx[pp]][HDET_3RD_AMP] = get_max(AMP3, 0);
+     }
+  } /* end: for (first) */
+} /* end: check_tap_ring_batch */
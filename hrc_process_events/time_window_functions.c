@@ -0,0 +1,338 @@
+/*
+**  Copyright (C) 2026  Smithsonian Astrophysical Observatory
+*/
+
+/*                                                                          */
+/*  This program is free software; you can redistribute it and/or modify    */
+/*  it under the terms of the GNU General Public License as published by    */
+/*  the Free Software Foundation; either version 3 of the License, or       */
+/*  (at your option) any later version.                                     */
+/*                                                                          */
+/*  This program is distributed in the hope that it will be useful,         */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*  GNU General Public License for more details.                            */
+/*                                                                          */
+/*  You should have received a copy of the GNU General Public License along */
+/*  with this program; if not, write to the Free Software Foundation, Inc., */
+/*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.             */
+/*                                                                          */
+
+/*H***********************************************************************
+
+* FILE NAME: time_window_functions.c
+
+* DEVELOPEMENT: tools
+
+* DESCRIPTION:
+
+  The file time_window_functions.c contains the following modules used
+  by hrc_process_events() to process only the events of a time window
+  (tmin/tmax, gtifile):
+
+        load_time_window()
+        find_time_window()
+        outside_time_window()
+
+  load_time_window() bounds the window given by the tmin and tmax
+  parameters with the first START and last STOP time of the GTI file.
+  find_time_window() then narrows the row range of each input file to
+  the rows of the window, by a binary search of the TIME column, and
+  outside_time_window() tells the events of those rows which are not in
+  the window.
+
+* NOTES:
+
+  The TIME column of an input file is only nearly in order, so a binary
+  search may stop on the wrong side of an event out of time sequence.
+  The row range found is therefore widened, row by row, while the rows
+  next to it are still in the window, and an event of the range whose
+  TIME is not in the window is skipped (not processed or written). An
+  event out of time sequence within the window is still flagged
+  (HDET_SEQUENCE_STS) and counted as before.
+
+  Only the overall span of a GTI file (earliest START to latest STOP)
+  bounds the window; the events between its intervals are processed and
+  left to be filtered by the GTI downstream.
+
+* REVISION HISTORY:
+  10/2026 - initial version.
+  10/2026 - a GTI file without intervals and an empty time window are
+            fatal errors.
+  10/2026 - widen the rows found by the binary search while the next
+            rows are in the window; skip the events of the rows found
+            whose TIME is not in the window (outside_time_window).
+*H***********************************************************************/
+
+#ifndef HRC_PROCESS_EVENTS_H
+#include "hrc_process_events.h"
+#endif
+
+static double time_at_row(EVENT_SETUP_P_T, short, long);
+static long   first_row_after(EVENT_SETUP_P_T, short, double, boolean,
+                              long, long);
+static boolean in_window(double, double, double);
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine load_time_window() sets up the time window of the run
+  (inp_p->time_window). If a GTI file is given, the window is narrowed
+  to the span of its intervals (earliest START to latest STOP). A fatal
+  error is added to the error list if the GTI file can not be read or
+  the window is empty.
+
+*************************************************************************/
+
+void load_time_window(
+   INPUT_PARMS_P_T inp_p,     /* I/O - input parameters               */
+   dsErrList*      err_p)     /* O   - error list pointer             */
+{
+   dmBlock*      gti_p;
+   dmDescriptor* start_p;
+   dmDescriptor* stop_p;
+   long   num_gti;
+   long   rr;
+   double gti_start = 0.0;
+   double gti_stop = 0.0;
+   double tt;
+
+   if ((inp_p->gtifile[0] != '\0') &&
+       (ds_strcmp_cis(inp_p->gtifile, "none") != 0))
+   {
+      if ((gti_p = dmTableOpen(inp_p->gtifile)) == NULL)
+      {
+         dsErrAdd(err_p, dsOPENFILEFERR, Individual, Custom,
+            "ERROR: Could not open the GTI file %s.", inp_p->gtifile);
+         return;
+      }
+
+      if (((start_p = dmTableOpenColumn(gti_p, "START")) == NULL) ||
+          ((stop_p = dmTableOpenColumn(gti_p, "STOP")) == NULL) ||
+          ((num_gti = dmTableGetNoRows(gti_p)) < 1))
+      {
+         dsErrAdd(err_p, dsREADFILEFERR, Individual, Custom,
+            "ERROR: The GTI file %s has no START/STOP intervals.",
+            inp_p->gtifile);
+         dmTableClose(gti_p);
+         return;
+      }
+
+      for (rr = 1; rr <= num_gti; rr++)
+      {
+         dmTableSetRow(gti_p, rr);
+         tt = dmGetScalar_d(start_p);
+         if ((rr == 1) || (tt < gti_start))
+         {
+            gti_start = tt;
+         }
+         tt = dmGetScalar_d(stop_p);
+         if ((rr == 1) || (tt > gti_stop))
+         {
+            gti_stop = tt;
+         }
+      }
+      dmTableClose(gti_p);
+
+      if (gti_start > inp_p->tmin)
+      {
+         inp_p->tmin = gti_start;
+      }
+      if ((inp_p->tmax <= 0.0) || (gti_stop < inp_p->tmax))
+      {
+         inp_p->tmax = gti_stop;
+      }
+   }
+
+   inp_p->time_window = ((inp_p->tmin > 0.0) || (inp_p->tmax > 0.0));
+
+   if (inp_p->time_window && (inp_p->tmax > 0.0) &&
+       (inp_p->tmax < inp_p->tmin))
+   {
+      dsErrAdd(err_p, dsFINDPARAMFERR, Individual, Custom,
+         "ERROR: The time window is empty (tmin = %f, tmax = %f).",
+         inp_p->tmin, inp_p->tmax);
+   }
+} /* end: load_time_window */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine find_time_window() narrows the rows *first_row_p to
+  evtin_p->num_rows of an input file to the rows with tmin <= TIME <=
+  tmax (tmin/tmax 0 = no limit), found by a binary search, then widens
+  them while the rows just before and after are in the window. If no
+  row is in the window, *first_row_p is set past evtin_p->num_rows.
+  Nothing is changed if the file has no TIME column. The routine uses
+  neither the parameters nor the error list, so the prefetch thread can
+  call it.
+
+*************************************************************************/
+
+void find_time_window(
+   EVENT_SETUP_P_T evtin_p,   /* I/O - input event file info          */
+   double          tmin,      /* I   - earliest time (0 = no limit)   */
+   double          tmax,      /* I   - latest time (0 = no limit)     */
+   long*           first_row_p) /* I/O - first row to process         */
+{
+   short cc;
+   short time_col = -1;
+   long  first_row = *first_row_p;
+   long  last_row = evtin_p->num_rows;
+   long  row_lo = *first_row_p;     /* rows the window may take */
+   long  row_hi = evtin_p->num_rows;
+
+   for (cc = 0; (cc < evtin_p->num_cols) && (time_col < 0); cc++)
+   {
+      if (evtin_p->mapping[cc] == HDET_TIME)
+      {
+         time_col = cc;
+      }
+   }
+   if ((time_col < 0) || (first_row > last_row))
+   {
+      return;
+   }
+
+   if (tmin > 0.0)
+   {
+      first_row = first_row_after(evtin_p, time_col, tmin, FALSE,
+                                  first_row, last_row);
+   }
+   if ((tmax > 0.0) && (first_row <= last_row))
+   {
+      last_row = first_row_after(evtin_p, time_col, tmax, TRUE,
+                                 first_row, last_row) - 1;
+   }
+
+   /* a row out of time sequence may have misled the search */
+   if (first_row <= last_row)
+   {
+      while ((first_row > row_lo) &&
+             in_window(time_at_row(evtin_p, time_col, first_row - 1),
+                       tmin, tmax))
+      {
+         first_row--;
+      }
+      while ((last_row < row_hi) &&
+             in_window(time_at_row(evtin_p, time_col, last_row + 1),
+                       tmin, tmax))
+      {
+         last_row++;
+      }
+   }
+
+   *first_row_p = first_row;
+   evtin_p->num_rows = (first_row <= last_row) ? last_row : first_row - 1;
+} /* end: find_time_window */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine outside_time_window() returns TRUE if the time window of
+  the run is set and the specified event time is not in it. The events
+  of the rows found by find_time_window() are checked, since rows out of
+  time sequence within them may be outside the window.
+
+*************************************************************************/
+
+boolean outside_time_window(
+   INPUT_PARMS_P_T inp_p,     /* I - input parameters                 */
+   double          time)      /* I - event time                       */
+{
+   return (inp_p->time_window && !in_window(time, inp_p->tmin, inp_p->tmax));
+} /* end: outside_time_window */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine in_window() returns TRUE if tmin <= time <= tmax (tmin/tmax
+  0 = no limit).
+
+*************************************************************************/
+
+static boolean in_window(
+   double time,               /* I - event time                       */
+   double tmin,               /* I - earliest time (0 = no limit)     */
+   double tmax)               /* I - latest time (0 = no limit)       */
+{
+   return (((tmin <= 0.0) || (time >= tmin)) &&
+           ((tmax <= 0.0) || (time <= tmax)));
+} /* end: in_window */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine first_row_after() returns the first row of lo..hi whose
+  TIME is at or after (after = FALSE) or after (after = TRUE) time 'tt',
+  or hi+1 if there is none, by a binary search.
+
+*************************************************************************/
+
+static long first_row_after(
+   EVENT_SETUP_P_T evtin_p,   /* I - input event file info            */
+   short           time_col,  /* I - input column of TIME             */
+   double          tt,        /* I - time searched for                */
+   boolean         after,     /* I - TRUE = first row with TIME > tt  */
+   long            lo,        /* I - first row searched               */
+   long            hi)        /* I - last row searched                */
+{
+   long   mid;
+   long   found = hi + 1;
+   double row_time;
+
+   while (lo <= hi)
+   {
+      mid = lo + ((hi - lo) / 2);
+      row_time = time_at_row(evtin_p, time_col, mid);
+
+      if ((after) ? (row_time > tt) : (row_time >= tt))
+      {
+         found = mid;
+         hi = mid - 1;
+      }
+      else
+      {
+         lo = mid + 1;
+      }
+   }
+
+   return (found);
+} /* end: first_row_after */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine time_at_row() returns the TIME of a row of the input file,
+  read from the file's memory map if it has one (fastread).
+
+*************************************************************************/
+
+static double time_at_row(
+   EVENT_SETUP_P_T evtin_p,   /* I - input event file info            */
+   short           time_col,  /* I - input column of TIME             */
+   long            row)       /* I - table row                        */
+{
+   double row_time;
+
+   if (!read_fits_map_column(evtin_p->fits_p, time_col, HDET_BLK_DOUBLE,
+                             &row_time, row, 1))
+   {
+      dmTableSetRow(evtin_p->extension, row);
+      row_time = dmGetScalar_d(evtin_p->desc[time_col]);
+   }
+
+   return (row_time);
+} /* end: time_at_row */
@@ -27,10 +27,14 @@
 * DESCRIPTION: The routine write_hrc_events is called by hrc_process_events
   to write a specified event to an output qpoe file. The attributes which
   are to be output are specified in the hrc_process_events.par paramater
-  file. A mapping array is passed into this routine to facilitate the
-  output of the appropriate data fields. The routine does not return any
-  error status but adds detected errors onto the error list which is passed
-  in.
+  file. The routine compile_write_plan() turns the column mapping and
+  data types of the output file into a write plan (one store routine,
+  event record offset and row buffer per column). write_hrc_events()
+  stores each event in the row buffers and flush_hrc_events() writes a
+  block of rows with one dmSetScalars call per column (or per vector
+  component), or hands the block to the writer thread (writequeue > 0,
+  see event_writer_functions.c). The routines do not return any error
+  status but add detected errors onto the error list which is passed in.
  
 * NOTES:
  
@@ -42,734 +46,762 @@
   JCC(6/18/00)- add comment for HDET_STATUS .
   JCC(8/2/00)-add FLOAT for det,sky coords.
 10/2009-dph/fap new gain files affect PI (see 'Notes on outCol PI')
+10/2026-compile the mapping/type switch into a write plan once per output
+        file (compile_write_plan); the casts are unchanged.
+10/2026-buffer the output rows and write them a column at a time
+        (flush_hrc_events).
+10/2026-the row buffers of a plan are one set (buf) which may be handed
+        to the writer thread (queue_event_rows).
 *H***********************************************************************/
 
+#include <stddef.h>
+
 #ifndef HRC_PROCESS_EVENTS_H
 #include "hrc_process_events.h"
 #endif 
 
+/* offset of a field (and of one plane of a VEC2_DBLE) in EVENT_REC_T */
+#define EVT_OFF(field)        offsetof(EVENT_REC_T, field)
+#define EVT_OFF_PLANE(field, plane) \
+   (offsetof(EVENT_REC_T, field) + ((plane) * sizeof(double)))
 
-void write_hrc_events(
-   EVENT_SETUP_P_T evtout_p, /* I - output event file info              */
-   EVENT_REC_P_T   evt_p,    /* I - structure holding event data        */
-   dsErrList*      err_p)    /* O - error list pointer                  */
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The following routines store the event record field at 'src' in row
+  ii of a column buffer of 'size' rows. Their names give the field type
+  and the buffer type: s = short, us = unsigned short, uc = unsigned
+  char, l = long, d = double, f = float (held in a double buffer),
+  v = the 2 planes of a VEC2_DBLE (x in rows 0 to size-1, y in rows size
+  to 2*size-1); pix = cast with pix_double_to_short/long, trunc = plain
+  C cast.
+
+*************************************************************************/
+
+static void st_s_s(void* buf, long size, long ii, const char* src)
+{
+   ((short*) buf)[ii] = *(const short*) src;
+}
+
+static void st_us_s(void* buf, long size, long ii, const char* src)
+{
+   ((short*) buf)[ii] = *(const unsigned short*) src;
+}
+
+static void st_uc_s(void* buf, long size, long ii, const char* src)
 {
-   int count = 0;
+   ((short*) buf)[ii] = *(const unsigned char*) src;
+}
+
+static void st_uc_bit(void* buf, long size, long ii, const char* src)
+{
+   ((unsigned char*) buf)[ii] = *(const unsigned char*) src;
+}
+
+static void st_l_s(void* buf, long size, long ii, const char* src)
+{
+   /*11/2009: outCol maxPI=255||1023; SHORT dtype*/
+   ((short*) buf)[ii] = (short) *(const long*) src;
+}
+
+static void st_l_l(void* buf, long size, long ii, const char* src)
+{
+   ((long*) buf)[ii] = *(const long*) src;
+}
+
+static void st_status_bit(void* buf, long size, long ii, const char* src)
+{
+   /*----------------------------------------------------------
+    *JCC(6/16/00)-data type of 'status' is 'bit' (ie. x:status)
+    * 
+    * val[0] = (status & 0xff000000) >> 24;
+    *  This takes the high end value(0xff000000) from status
+    *  and shift it to the right for 3 bytes (24/8=3).
+    *---------------------------------------------------------*/
+   HRC_STATUS_T   status = *(const HRC_STATUS_T*) src;
+   unsigned char* val = (unsigned char*) buf + (4 * ii);
+
+   /* to avoid byte swapping on little endian platforms */ 
+   val[0] = (status & 0xff000000) >> 24;  
+   val[1] = (status & 0x00ff0000) >> 16;  
+   val[2] = (status & 0x0000ff00) >> 8;  
+   val[3] = status & 0x000000ff;  
+}
+
+static void st_d_d(void* buf, long size, long ii, const char* src)
+{
+   ((double*) buf)[ii] = *(const double*) src;
+}
 
-   while (count < evtout_p->num_cols)
+static void st_d_f(void* buf, long size, long ii, const char* src)
+{
+   ((double*) buf)[ii] = (float) *(const double*) src;
+}
+
+static void st_d_pix_s(void* buf, long size, long ii, const char* src)
+{
+   pix_double_to_short(*(const double*) src, FALSE, &((short*) buf)[ii]);
+}
+
+static void st_d_pix_l(void* buf, long size, long ii, const char* src)
+{
+   pix_double_to_long(*(const double*) src, FALSE, &((long*) buf)[ii]);
+}
+
+#ifdef AXLEN_WORKAROUND
+static void st_d_pix_l_axlen(void* buf, long size, long ii, const char* src)
+{
+   pix_double_to_long(*(const double*) src, FALSE, &((long*) buf)[ii]);
+   ((long*) buf)[ii] -= 28671; 
+}
+#endif 
+
+static void st_v_d(void* buf, long size, long ii, const char* src)
+{
+   const double* pos = (const double*) src;
+
+   ((double*) buf)[ii] = pos[HDET_PLANE_X];
+   ((double*) buf)[size + ii] = pos[HDET_PLANE_Y];
+}
+
+static void st_v_f(void* buf, long size, long ii, const char* src)
+{
+   const double* pos = (const double*) src;
+
+   ((double*) buf)[ii] = (float)(pos[HDET_PLANE_X]);
+   ((double*) buf)[size + ii] = (float)(pos[HDET_PLANE_Y]);
+}
+
+static void st_v_pix_s(void* buf, long size, long ii, const char* src)
+{
+   const double* pos = (const double*) src;
+
+   pix_double_to_short(pos[HDET_PLANE_X], FALSE, &((short*) buf)[ii]);
+   pix_double_to_short(pos[HDET_PLANE_Y], FALSE, &((short*) buf)[size + ii]);
+}
+
+static void st_v_pix_l(void* buf, long size, long ii, const char* src)
+{
+   const double* pos = (const double*) src;
+
+   pix_double_to_long(pos[HDET_PLANE_X], FALSE, &((long*) buf)[ii]);
+   pix_double_to_long(pos[HDET_PLANE_Y], FALSE, &((long*) buf)[size + ii]);
+}
+
+static void st_v_trunc_s(void* buf, long size, long ii, const char* src)
+{
+   const double* pos = (const double*) src;
+
+   ((short*) buf)[ii] = (float)(pos[HDET_PLANE_X]);
+   ((short*) buf)[size + ii] = (float)(pos[HDET_PLANE_Y]);
+}
+
+static void st_none(void* buf, long size, long ii, const char* src)
+{
+   /* column type not handled for this field- the cell is left as is */
+}
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine set_plan_column() sets the store routine, buffer type,
+  values per row and event record offset of a column of the plan.
+
+*************************************************************************/
+
+static void set_plan_column(
+   HPE_WRITE_COL_P_T col_p,   /* O - column of the write plan         */
+   HPE_STORE_FN_T    store,   /* I - store routine                    */
+   short             kind,    /* I - buffer type (HPE_WCOL_*)         */
+   short             width,   /* I - values per row                   */
+   size_t            offset)  /* I - offset of the field in the event */
+{
+   col_p->store = store;
+   col_p->kind = kind;
+   col_p->width = width;
+   col_p->offset = offset;
+} /* end: set_plan_column */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine write_plan_column() sets the plan of an output column with
+  the specified mapping and data type. The store routine is left NULL for
+  a mapping that can not be written. The casts are those of the per-row
+  switch this plan replaces, including its defaults (short for an
+  unexpected scalar type, nothing written for an unexpected vector type).
+
+*************************************************************************/
+
+static void write_plan_column(
+   short             mapping, /* I - HDET_* mapping of the column     */
+   dmDataType        type,    /* I - data type of the column          */
+   HPE_WRITE_COL_P_T col_p)   /* O - column of the write plan         */
+{
+   /* scalar short, long and double fields */
+   static const struct {
+      short  mapping;
+      short  kind;
+      size_t offset;
+   } direct[] = {
+      { HDET_TIME,         HPE_WCOL_DOUBLE, EVT_OFF(time) },
+      { HDET_MJR_FRAME,    HPE_WCOL_LONG,   EVT_OFF(major_frame) },
+      { HDET_MNR_FRAME,    HPE_WCOL_LONG,   EVT_OFF(minor_frame) },
+      { HDET_TICK,         HPE_WCOL_LONG,   EVT_OFF(tick) },
+      { HDET_SCIFR,        HPE_WCOL_LONG,   EVT_OFF(scifr) },
+      { HDET_EVENT,        HPE_WCOL_SHORT,  EVT_OFF(event) },
+      { HDET_CP_X,         HPE_WCOL_SHORT,  EVT_OFF(cp[HDET_PLANE_X]) },
+      { HDET_CP_Y,         HPE_WCOL_SHORT,  EVT_OFF(cp[HDET_PLANE_Y]) },
+      /* JCC (5/11/00) - raw amplitudes (amps_sh) */
+      { HDET_AX_1, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_X][HDET_1ST_AMP]) },
+      { HDET_AX_2, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_X][HDET_2ND_AMP]) },
+      { HDET_AX_3, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_X][HDET_3RD_AMP]) },
+      { HDET_AY_1, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_Y][HDET_1ST_AMP]) },
+      { HDET_AY_2, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_Y][HDET_2ND_AMP]) },
+      { HDET_AY_3, HPE_WCOL_SHORT,
+        EVT_OFF(amps_sh[HDET_PLANE_Y][HDET_3RD_AMP]) },
+      { HDET_PHA,          HPE_WCOL_SHORT,  EVT_OFF(pha) },
+      { HDET_X_POS,        HPE_WCOL_SHORT,  EVT_OFF(xpos) },
+      { HDET_Y_POS,        HPE_WCOL_SHORT,  EVT_OFF(ypos) },
+      { HDET_CHIP_ID,      HPE_WCOL_SHORT,  EVT_OFF(chipid) },
+      { HDET_DUMMY,        HPE_WCOL_SHORT,  EVT_OFF(dummy) },
+      { HDET_PHASCALE,     HPE_WCOL_SHORT,  EVT_OFF(phascale) },
+      { HDET_RAWPHA,       HPE_WCOL_SHORT,  EVT_OFF(rawpha) },
+      { HDET_EVTCTR,       HPE_WCOL_SHORT,  EVT_OFF(evtctr) },
+      { HDET_AMP_SF,       HPE_WCOL_SHORT,  EVT_OFF(amp_sf) },
+      { HDET_SUBMJF,       HPE_WCOL_SHORT,  EVT_OFF(submjf) },
+      { HDET_STOPMNF,      HPE_WCOL_SHORT,  EVT_OFF(stopmnf) },
+      { HDET_MRF,          HPE_WCOL_SHORT,  EVT_OFF(mrf) }
+   };
+   size_t nn;
+   size_t off;
+
+   memset(col_p->cpt, 0, sizeof(col_p->cpt));
+   set_plan_column(col_p, NULL, HPE_WCOL_NONE, 1, 0);
+
+   for (nn = 0; nn < sizeof(direct) / sizeof(direct[0]); nn++)
    {
-      switch (evtout_p->mapping[count])
+      if (direct[nn].mapping == mapping)
       {
-         case HDET_TIME:
-            dmSetScalar_d(evtout_p->desc[count], evt_p->time); 
-         break;
-
-         case HDET_MJR_FRAME:
-            dmSetScalar_l(evtout_p->desc[count], evt_p->major_frame); 
-         break;
-
-         case HDET_MNR_FRAME:
-            dmSetScalar_l(evtout_p->desc[count], evt_p->minor_frame); 
-         break;
-
-         case HDET_EVENT:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->event); 
-         break;
-
-         case HDET_CP_X:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->cp[HDET_PLANE_X]); 
-         break;
-
-         case HDET_CP_Y:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->cp[HDET_PLANE_Y]); 
-         break;
-
-         /* JCC (5/11/00) - begin */
-         case HDET_AX_1:
-            dmSetScalar_s(evtout_p->desc[count], 
-               evt_p->amps_sh[HDET_PLANE_X][HDET_1ST_AMP]); 
-         break;
-
-         case HDET_AX_2:
-            dmSetScalar_s(evtout_p->desc[count], 
-               evt_p->amps_sh[HDET_PLANE_X][HDET_2ND_AMP]); 
-         break;
-
-         case HDET_AX_3:
-            dmSetScalar_s(evtout_p->desc[count],
-               evt_p->amps_sh[HDET_PLANE_X][HDET_3RD_AMP]); 
- /* dmSetScalar_s(evtout_p->desc[count], evt_p->amps_3RD_raw[HDET_PLANE_X]); */
-         break;
-
-         case HDET_AY_1:
-            dmSetScalar_s(evtout_p->desc[count], 
-               evt_p->amps_sh[HDET_PLANE_Y][HDET_1ST_AMP]); 
-         break;
-
-         case HDET_AY_2:
-            dmSetScalar_s(evtout_p->desc[count], 
-               evt_p->amps_sh[HDET_PLANE_Y][HDET_2ND_AMP]); 
-         break;
-
-         case HDET_AY_3:
-            dmSetScalar_s(evtout_p->desc[count], 
-               evt_p->amps_sh[HDET_PLANE_Y][HDET_3RD_AMP]); 
- /* dmSetScalar_s( evtout_p->desc[count], evt_p->amps_3RD_raw[HDET_PLANE_Y]); */
-         break; 
-         /* JCC (5/11/00) - end */
-
-         case HDET_PHA:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->pha); 
-         break;
-
-         case HDET_VETO_STATUS:
-            if (evtout_p->types[count] == dmBIT)
-            {
-               dmSetArray_bit(evtout_p->desc[count], &evt_p->veto_status, 1);
-            }
-            else
-            {
-               dmSetScalar_s(evtout_p->desc[count], evt_p->veto_status); 
-            }
-         break;
-
-         case HDET_EVENT_STATUS:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->event_status); 
-         break;
-
-         case HDET_STATUS:        /*output column 'status' */ 
-            if (evtout_p->types[count] == dmBIT) 
-            {
-               /*----------------------------------------------------------
-                *JCC(6/16/00)-data type of 'status' is 'bit' (ie. x:status)
-                * 
-                * val[0] = (evt_p->status & 0xff000000) >> 24;
-                *  This takes the high end value(0xff000000) from status
-                *  and shift it to the right for 3 bytes (24/8=3).
-                *---------------------------------------------------------*/
-               unsigned char val[4];
-
-               /* to avoid byte swapping on little endian platforms */ 
-               val[0] = (evt_p->status & 0xff000000) >> 24;  
-               val[1] = (evt_p->status & 0x00ff0000) >> 16;  
-               val[2] = (evt_p->status & 0x0000ff00) >> 8;  
-               val[3] = evt_p->status & 0x000000ff;  
-
-               dmSetArray_bit(evtout_p->desc[count], val, 4); 
-            } 
-            else
-            {
-               /*----------------------------------------------------------
-                *JCC(6/16/00)-data type of 'status' is 'long' (ie. l:status)
-                *---------------------------------------------------------*/
-               dmSetScalar_l(evtout_p->desc[count], evt_p->status); 
-            } 
-         break; 
-
-         case HDET_X_POS:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->xpos); 
-         break;
-
-         case HDET_Y_POS:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->ypos); 
-         break;
-
-         case HDET_SUMAMPS:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->sum_amps); 
-         break;
-
-         case HDET_CHIP_ID:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->chipid); 
-         break;
-
-         case HDET_DUMMY:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->dummy); 
-         break;
-
-         case HDET_PI: /*11/2009: outCol maxPI=255||1023; SHORT dtype*/
-            dmSetScalar_s(evtout_p->desc[count], (short)evt_p->pi);
-         break;
-
-         case HDET_PHASCALE:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->phascale); 
-         break;
-
-         case HDET_RAWPHA:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->rawpha); 
-         break;
-
-         case HDET_TICK:
-            dmSetScalar_l(evtout_p->desc[count], evt_p->tick); 
-         break;
-
-         case HDET_SCIFR:
-            dmSetScalar_l(evtout_p->desc[count], evt_p->scifr); 
-         break;
-
-         case HDET_EVTCTR:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->evtctr); 
-         break;
-
-         case HDET_RAW_X:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->rawpos[HDET_PLANE_X]);
-               break;
- 
-               case dmLONG:
-               {
-                  long cast_val;
- 
-                  pix_double_to_long(evt_p->rawpos[HDET_PLANE_X],
-                                     FALSE, &cast_val);
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break;
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val;
- 
-                  pix_double_to_short(evt_p->rawpos[HDET_PLANE_X],
-                                      FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_RAW_Y:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->rawpos[HDET_PLANE_Y]);
-               break;
- 
-               case dmLONG:
-               {
-                  long cast_val;
- 
-                  pix_double_to_long(evt_p->rawpos[HDET_PLANE_Y],
-                                     FALSE, &cast_val);
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break;
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val;
- 
-                  pix_double_to_short(evt_p->rawpos[HDET_PLANE_Y],
-                                      FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_RAW:
-            switch (evtout_p->types[count])
-            {
-               case dmSHORT:
-               {
-                  short casted_val[2];
- 
-                  pix_double_to_short(evt_p->rawpos[HDET_PLANE_X],
-                                      FALSE, &casted_val[0]);
-                  pix_double_to_short(evt_p->rawpos[HDET_PLANE_Y],
-                                      FALSE, &casted_val[1]);
-                  dmSetVector_s(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmLONG:
-               {
-                  long casted_val[2];
- 
-                  pix_double_to_long(evt_p->rawpos[HDET_PLANE_X],
-                                     FALSE, &casted_val[0]);
-                  pix_double_to_long(evt_p->rawpos[HDET_PLANE_Y],
-                                     FALSE, &casted_val[1]);
-                  dmSetVector_l(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmDOUBLE:
-                  dmSetVector_d(evtout_p->desc[count], evt_p->rawpos, 2);
-               break;
- 
-               default:
-               break;
-            } /* end switch */
-         break; 
-
-         case HDET_DET_X:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->detpos[HDET_PLANE_X]);
-               break;
-
-               case dmFLOAT:
-               {
-                  float cast_val;
-
-                  cast_val = (float)(evt_p->detpos[HDET_PLANE_X]) ;
-                  dmSetScalar_f(evtout_p->desc[count], cast_val);
-               }
-               break;
-
-               case dmLONG:
-               {
-                  long cast_val; 
-
-                  pix_double_to_long(evt_p->detpos[HDET_PLANE_X], 
-                                     FALSE, &cast_val);
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val; 
-
-                  pix_double_to_short(evt_p->detpos[HDET_PLANE_X], 
-                                      FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_DET_Y:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->detpos[HDET_PLANE_Y]);
-               break;
-
-               case dmFLOAT:
-               {
-                  float cast_val;
-
-                  cast_val = (float)(evt_p->detpos[HDET_PLANE_Y]);
-                  dmSetScalar_f(evtout_p->desc[count], cast_val);
-               }
-               break;
-
-               case dmLONG:
-               {
-                  long cast_val; 
-
-                  pix_double_to_long(evt_p->detpos[HDET_PLANE_Y], 
-                                      FALSE, &cast_val);
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val; 
-
-                  pix_double_to_short(evt_p->detpos[HDET_PLANE_Y], 
-                                      FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_DET:
+         set_plan_column(col_p,
+            (direct[nn].kind == HPE_WCOL_DOUBLE) ? st_d_d :
+            (direct[nn].kind == HPE_WCOL_LONG)   ? st_l_l : st_s_s,
+            direct[nn].kind, 1, direct[nn].offset);
+         return;
+      }
+   }
+
+   switch (mapping)
+   {
+      case HDET_EVENT_STATUS:
+         set_plan_column(col_p, st_us_s, HPE_WCOL_SHORT, 1,
+                         EVT_OFF(event_status));
+      break;
+
+      case HDET_SUMAMPS:
+         set_plan_column(col_p, st_us_s, HPE_WCOL_SHORT, 1,
+                         EVT_OFF(sum_amps));
+      break;
+
+      case HDET_PI: /*11/2009: outCol maxPI=255||1023; SHORT dtype*/
+         set_plan_column(col_p, st_l_s, HPE_WCOL_SHORT, 1, EVT_OFF(pi));
+      break;
+
+      case HDET_VETO_STATUS:
+      case HDET_E_TRIG:
+      case HDET_VETO_STT:
+      case HDET_DET_ID:
+         off = (mapping == HDET_VETO_STATUS) ? EVT_OFF(veto_status) :
+               (mapping == HDET_E_TRIG)      ? EVT_OFF(e_trig) :
+               (mapping == HDET_VETO_STT)    ? EVT_OFF(veto_stt) :
+                                               EVT_OFF(det_id);
+         if (type == dmBIT)
          {
-            switch (evtout_p->types[count])
-            {
-               case dmSHORT:
-               {
-                  short casted_val[2];
- 
-                  pix_double_to_short(evt_p->detpos[HDET_PLANE_X],
-                                      FALSE, &casted_val[0]);
-                  pix_double_to_short(evt_p->detpos[HDET_PLANE_Y],
-                                      FALSE, &casted_val[1]);
-                  dmSetVector_s(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmLONG:
-               {
-                  long casted_val[2];
- 
-                  pix_double_to_long(evt_p->detpos[HDET_PLANE_X],
-                                     FALSE, &casted_val[0]);
-                  pix_double_to_long(evt_p->detpos[HDET_PLANE_Y],
-                                     FALSE, &casted_val[1]);
-                  dmSetVector_l(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmDOUBLE:
-                  dmSetVector_d(evtout_p->desc[count], evt_p->detpos, 2);
-               break;
- 
-               case dmFLOAT:
-               {
-                  float casted_val[2];
-
-                  casted_val[0] = (float)(evt_p->detpos[HDET_PLANE_X]);
-                  casted_val[1] = (float)(evt_p->detpos[HDET_PLANE_Y]);
-                  dmSetVector_f(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               default:
-               break;
-            } /* end switch */
+            set_plan_column(col_p, st_uc_bit, HPE_WCOL_BIT, 1, off);
          }
-         break;
-
-         case HDET_TDET_X:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->tdetpos[HDET_PLANE_X]);
-               break;
-
-               case dmLONG:
-               {
-                  long cast_val;
-
-                  pix_double_to_long(evt_p->tdetpos[HDET_PLANE_X], FALSE,
-                                     &cast_val);  
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val;
-
-                  pix_double_to_short(evt_p->tdetpos[HDET_PLANE_X], FALSE,
-                                      &cast_val);  
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
- 
-         case HDET_TDET_Y:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count],
-                                evt_p->tdetpos[HDET_PLANE_Y]);
-               break;
-
-               case dmLONG:
-               {
-                  long cast_val; 
-
-                  pix_double_to_long(evt_p->tdetpos[HDET_PLANE_Y], FALSE,
-                                     &cast_val);  
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
- 
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val; 
-
-                  pix_double_to_short(evt_p->tdetpos[HDET_PLANE_Y], FALSE,
-                                      &cast_val);  
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_TDET:
+         else
          {
-            switch (evtout_p->types[count])
-            {
-               case dmSHORT:
-               {
-                  short casted_val[2];
- 
-                  pix_double_to_short(evt_p->tdetpos[HDET_PLANE_X],
-                                      FALSE, &casted_val[0]);
-                  pix_double_to_short(evt_p->tdetpos[HDET_PLANE_Y],
-                                      FALSE, &casted_val[1]);
-                  dmSetVector_s(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmLONG:
-               {
-                  long casted_val[2];
-
-                  pix_double_to_long(evt_p->tdetpos[HDET_PLANE_X],
-                                     FALSE, &casted_val[0]);
-                  pix_double_to_long(evt_p->tdetpos[HDET_PLANE_Y],
-                                     FALSE, &casted_val[1]);
-                  dmSetVector_l(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmDOUBLE:
-                  dmSetVector_d(evtout_p->desc[count], evt_p->tdetpos, 2);
-               break;
- 
-               default:
-               break;
-            } /* end switch */
+            set_plan_column(col_p, st_uc_s, HPE_WCOL_SHORT, 1, off);
          }
-         break;
-
-         case HDET_SKY_X:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count], 
-                                evt_p->skypos[HDET_PLANE_X]);
-               break;
-
-               case dmFLOAT:
-               {
-                  float cast_val;
-
-                  cast_val = (float)(evt_p->skypos[HDET_PLANE_X]);
-                  dmSetScalar_f(evtout_p->desc[count], cast_val);
-               }
-               break;
-
-               case dmLONG:  
-               {
-                  long cast_val;
-
-                  pix_double_to_long(evt_p->skypos[HDET_PLANE_X],
-                                     FALSE, &cast_val);
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
-
-               case dmSHORT: /* fallthrough intented */ 
-               default: 
-               {
-                  short cast_val;
-
-                  pix_double_to_short(evt_p->skypos[HDET_PLANE_X], 
-                                      FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break; 
-            }
-         break;
- 
-         case HDET_SKY_Y:
-            switch(evtout_p->types[count])
-            {
-               case dmDOUBLE:
-                  dmSetScalar_d(evtout_p->desc[count], 
-                                evt_p->skypos[HDET_PLANE_Y]);
-               break;
-
-               case dmFLOAT:
-               {
-                  float cast_val;
-
-                  cast_val = (float)(evt_p->skypos[HDET_PLANE_Y]);
-                  dmSetScalar_f(evtout_p->desc[count], cast_val);
-               }
-               break;
-
-               case dmLONG:
-               {
-                  long cast_val;
-
-                  pix_double_to_long(evt_p->skypos[HDET_PLANE_Y], 
-                                     FALSE, &cast_val);
+      break;
+
+      case HDET_STATUS:        /*output column 'status' */ 
+         /*JCC(6/16/00)-'status' is either bit (x:status) or long (l:status)*/
+         if (type == dmBIT)
+         {
+            set_plan_column(col_p, st_status_bit, HPE_WCOL_BIT, 4,
+                            EVT_OFF(status));
+         }
+         else
+         {
+            set_plan_column(col_p, st_l_l, HPE_WCOL_LONG, 1,
+                            EVT_OFF(status));
+         }
+      break;
+
+      case HDET_RAW_X:
+      case HDET_RAW_Y:
+      case HDET_TDET_X:
+      case HDET_TDET_Y:
+      case HDET_DET_X:
+      case HDET_DET_Y:
+      case HDET_SKY_X:
+      case HDET_SKY_Y:
+         switch (mapping)
+         {
+            case HDET_RAW_X:  off = EVT_OFF_PLANE(rawpos, HDET_PLANE_X);  break;
+            case HDET_RAW_Y:  off = EVT_OFF_PLANE(rawpos, HDET_PLANE_Y);  break;
+            case HDET_TDET_X: off = EVT_OFF_PLANE(tdetpos, HDET_PLANE_X); break;
+            case HDET_TDET_Y: off = EVT_OFF_PLANE(tdetpos, HDET_PLANE_Y); break;
+            case HDET_DET_X:  off = EVT_OFF_PLANE(detpos, HDET_PLANE_X);  break;
+            case HDET_DET_Y:  off = EVT_OFF_PLANE(detpos, HDET_PLANE_Y);  break;
+            case HDET_SKY_X:  off = EVT_OFF_PLANE(skypos, HDET_PLANE_X);  break;
+            default:          off = EVT_OFF_PLANE(skypos, HDET_PLANE_Y);  break;
+         }
+
+         if (type == dmDOUBLE)
+         {
+            set_plan_column(col_p, st_d_d, HPE_WCOL_DOUBLE, 1, off);
+         }
+         else if ((type == dmFLOAT) &&
+                  (mapping != HDET_RAW_X) && (mapping != HDET_RAW_Y) &&
+                  (mapping != HDET_TDET_X) && (mapping != HDET_TDET_Y))
+         {
+            /* JCC(8/2/00)-FLOAT for det,sky coords */
+            set_plan_column(col_p, st_d_f, HPE_WCOL_DOUBLE, 1, off);
+         }
+         else if (type == dmLONG)
+         {
 #ifdef AXLEN_WORKAROUND
-                  cast_val -= 28671; 
+            set_plan_column(col_p, (mapping == HDET_SKY_Y) ?
+                            st_d_pix_l_axlen : st_d_pix_l,
+                            HPE_WCOL_LONG, 1, off);
+#else
+            set_plan_column(col_p, st_d_pix_l, HPE_WCOL_LONG, 1, off);
 #endif 
-                  dmSetScalar_l(evtout_p->desc[count], cast_val);
-               }
-               break; 
-
-               case dmSHORT: /* fallthrough intented */
-               default:
-               {
-                  short cast_val;
-
-                  pix_double_to_short(evt_p->skypos[HDET_PLANE_Y], 
-                                         FALSE, &cast_val);
-                  dmSetScalar_s(evtout_p->desc[count], cast_val);
-               }
-               break;
-            }
-         break;
-
-         case HDET_SKY:
+         }
+         else
          {
-            switch (evtout_p->types[count])
-            {
-               case dmSHORT:
-               {
-                  short casted_val[2];
- 
-                  casted_val[0] = (float)(evt_p->skypos[HDET_PLANE_X]);
-                  casted_val[1] = (float)(evt_p->skypos[HDET_PLANE_Y]);
-                  dmSetVector_s(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmLONG:
-               {
-                  long casted_val[2];
- 
-                  pix_double_to_long(evt_p->skypos[HDET_PLANE_X],
-                                     FALSE, &casted_val[0]);
-                  pix_double_to_long(evt_p->skypos[HDET_PLANE_Y],
-                                     FALSE, &casted_val[1]);
-                  dmSetVector_l(evtout_p->desc[count], casted_val, 2);
-               }
-               break;
- 
-               case dmDOUBLE:
-                  dmSetVector_d(evtout_p->desc[count], evt_p->skypos, 2);
-               break;
- 
-               case dmFLOAT:
-               {
-                  float casted_val[2];
-
-                  casted_val[0] = (float)(evt_p->skypos[HDET_PLANE_X]);
-                  casted_val[1] = (float)(evt_p->skypos[HDET_PLANE_Y]);
-                  dmSetVector_f(evtout_p->desc[count], casted_val, 2); 
-               }
-               break;
- 
-               default:
-               break;
-            } /* end switch */
+            /* dmSHORT and any other type */
+            set_plan_column(col_p, st_d_pix_s, HPE_WCOL_SHORT, 1, off);
          }
-         break;
+      break;
+
+      case HDET_RAW:
+      case HDET_TDET:
+      case HDET_DET:
+      case HDET_SKY:
+         off = (mapping == HDET_RAW)  ? EVT_OFF(rawpos) :
+               (mapping == HDET_TDET) ? EVT_OFF(tdetpos) :
+               (mapping == HDET_DET)  ? EVT_OFF(detpos) : EVT_OFF(skypos);
 
-         case HDET_FPZ:
+         if (type == dmSHORT)
+         {
+            /* a short sky vector is truncated, not rounded with pixlib */
+            set_plan_column(col_p, (mapping == HDET_SKY) ? st_v_trunc_s :
+                            st_v_pix_s, HPE_WCOL_SHORT, 2, off);
+         }
+         else if (type == dmLONG)
+         {
+            set_plan_column(col_p, st_v_pix_l, HPE_WCOL_LONG, 2, off);
+         }
+         else if (type == dmDOUBLE)
+         {
+            set_plan_column(col_p, st_v_d, HPE_WCOL_DOUBLE, 2, off);
+         }
+         else if ((type == dmFLOAT) &&
+                  ((mapping == HDET_DET) || (mapping == HDET_SKY)))
+         {
+            set_plan_column(col_p, st_v_f, HPE_WCOL_DOUBLE, 2, off);
+         }
+         else
          {
-            long cast_val;
+            set_plan_column(col_p, st_none, HPE_WCOL_NONE, 2, off);
+         }
+      break;
+
+      case HDET_FPZ:
+         /* skypos[HDET_PLANE_Z], as written by the per-row switch */
+         set_plan_column(col_p, st_d_pix_l, HPE_WCOL_LONG, 1,
+                         EVT_OFF_PLANE(skypos, HDET_PLANE_Z));
+      break;
+
+      case HDET_CHIP_X:
+      case HDET_CHIP_Y:
+         set_plan_column(col_p, st_d_pix_s, HPE_WCOL_SHORT, 1,
+                         EVT_OFF_PLANE(chippos, (mapping == HDET_CHIP_X) ?
+                                       HDET_PLANE_X : HDET_PLANE_Y));
+      break;
+
+      case HDET_CHIP:
+         set_plan_column(col_p, st_v_pix_s, HPE_WCOL_SHORT, 2,
+                         EVT_OFF(chippos));
+      break;
+
+      default:
+         /* unknown data field for output- store stays NULL */
+      break;
+   }
+} /* end: write_plan_column */
+
+
+/*************************************************************************
+
+* DESCRIPTION
 
-            pix_double_to_long(evt_p->skypos[HDET_PLANE_Z], 
-                               FALSE, &cast_val);
-            dmSetScalar_l(evtout_p->desc[count], cast_val); 
-         } 
-         break; 
+  The routine allocate_write_buffers() allocates a set of row buffers
+  (one per column, 'size' rows of 'width' values of the buffer type) for
+  a write plan. A NULL pointer is returned if the memory could not be
+  allocated.
 
-         case HDET_CHIP_X:
+*************************************************************************/
+
+void** allocate_write_buffers(
+   HPE_WRITE_PLAN_P_T plan_p) /* I - write plan                       */
+{
+   HPE_WRITE_COL_P_T col_p;
+   void**  buf;
+   boolean alloc_failure = FALSE;
+   size_t  val_size;
+   int     count;
+
+   if ((buf = (void**) calloc(plan_p->num_cols + 1, sizeof(void*))) == NULL)
+   {
+      return (NULL);
+   }
+
+   for (count = 0, col_p = plan_p->col;
+        (count < plan_p->num_cols) && !alloc_failure; count++, col_p++)
+   {
+      switch (col_p->kind)
+      {
+         case HPE_WCOL_SHORT:  val_size = sizeof(short);         break;
+         case HPE_WCOL_LONG:   val_size = sizeof(long);          break;
+         case HPE_WCOL_DOUBLE: val_size = sizeof(double);        break;
+         case HPE_WCOL_BIT:    val_size = sizeof(unsigned char); break;
+         default:              val_size = 0;                     break;
+      }
+
+      if ((val_size > 0) &&
+          ((buf[count] = calloc(plan_p->size * col_p->width, val_size))
+           == NULL))
+      {
+         alloc_failure = TRUE;
+      }
+   }
+
+   if (alloc_failure)
+   {
+      deallocate_write_buffers(plan_p, &buf);
+   }
+
+   return (buf);
+} /* end: allocate_write_buffers */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_write_buffers() frees a set of row buffers of a
+  write plan and sets the set pointer to NULL.
+
+*************************************************************************/
+
+void deallocate_write_buffers(
+   HPE_WRITE_PLAN_P_T plan_p, /* I   - write plan                     */
+   void***            buf_pp) /* I/O - row buffer set pointer         */
+{
+   void** buf = *buf_pp;
+   int    count;
+
+   if (buf != NULL)
+   {
+      for (count = 0; count < plan_p->num_cols; count++)
+      {
+         if (buf[count] != NULL)
          {
-            short cast_val; 
+            free(buf[count]);
+         }
+      }
+      free(buf);
+      *buf_pp = NULL;
+   }
+} /* end: deallocate_write_buffers */
+
+
+/*************************************************************************
 
-            pix_double_to_short(evt_p->chippos[HDET_PLANE_X], FALSE,
-                                &cast_val); 
-            dmSetScalar_s(evtout_p->desc[count], cast_val);
+* DESCRIPTION
+
+  The routine compile_write_plan() builds the write plan of an output
+  event file from its column mapping, data types and descriptors, and
+  allocates row buffers of 'size' rows. It is called once the output
+  columns are created. FALSE is returned, and an error added to the
+  error list, if the memory could not be allocated.
+
+*************************************************************************/
+
+boolean compile_write_plan(
+   EVENT_SETUP_P_T evtout_p,  /* I/O - output event file info         */
+   long            size,      /* I   - number of rows per block       */
+   dsErrList*      err_p)     /* O   - error list pointer             */
+{
+   HPE_WRITE_PLAN_P_T plan_p;
+   HPE_WRITE_COL_P_T  col_p;
+   boolean alloc_failure = FALSE;
+   int     count;
+
+   deallocate_write_plan(&evtout_p->plan);
+
+   if (((plan_p = (HPE_WRITE_PLAN_P_T) calloc(1, sizeof(HPE_WRITE_PLAN_T)))
+        == NULL) ||
+       ((plan_p->col = (HPE_WRITE_COL_P_T) calloc(evtout_p->num_cols + 1,
+                          sizeof(HPE_WRITE_COL_T))) == NULL))
+   {
+      alloc_failure = TRUE;
+   }
+   else
+   {
+      plan_p->num_cols = evtout_p->num_cols;
+      plan_p->size = size;
+      plan_p->next_row = 1;
+      evtout_p->plan = plan_p;
+
+      for (count = 0; count < evtout_p->num_cols; count++)
+      {
+         col_p = &plan_p->col[count];
+         col_p->desc = evtout_p->desc[count];
+         write_plan_column(evtout_p->mapping[count], evtout_p->types[count],
+                           col_p);
+
+         /* vector columns are written a component at a time */
+         if ((col_p->width == 2) && (col_p->kind != HPE_WCOL_NONE) &&
+             (col_p->kind != HPE_WCOL_BIT))
+         {
+            col_p->cpt[HDET_PLANE_X] = dmGetCpt(col_p->desc, 1);
+            col_p->cpt[HDET_PLANE_Y] = dmGetCpt(col_p->desc, 2);
          }
-         break;
+      }
 
-         case HDET_CHIP_Y:
+      if ((plan_p->buf = allocate_write_buffers(plan_p)) == NULL)
+      {
+         alloc_failure = TRUE;
+      }
+   }
+
+   if (alloc_failure)
+   {
+      if (plan_p != NULL)
+      {
+         evtout_p->plan = plan_p;
+         deallocate_write_plan(&evtout_p->plan);
+      }
+      dsErrAdd(err_p, dsALLOCERR, Individual, Custom,
+         "ERROR: Memory allocation failed setting up the output write plan.");
+   }
+
+   return (!alloc_failure);
+} /* end: compile_write_plan */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine write_event_rows() writes nn rows, starting at table row
+  'first', from a set of row buffers of the output event file: one
+  dmSetScalars call per scalar column or vector component, and one
+  dmSetArray_bit call per row of a bit column (the scalar columns are
+  written first, so the rows exist). It is called by flush_hrc_events()
+  or by the writer thread.
+
+*************************************************************************/
+
+void write_event_rows(
+   EVENT_SETUP_P_T evtout_p,  /* I/O - output event file info         */
+   void**          buf,       /* I   - row buffer of each column      */
+   long            first,     /* I   - table row of the first row     */
+   long            nn)        /* I   - number of rows                 */
+{
+   HPE_WRITE_PLAN_P_T plan_p = evtout_p->plan;
+   HPE_WRITE_COL_P_T  col_p;
+   dmDescriptor* desc;
+   long off;
+   long ii;
+   int  count;
+   int  pp;
+
+   /* scalar columns and vector components */
+   for (count = 0, col_p = plan_p->col; count < plan_p->num_cols;
+        count++, col_p++)
+   {
+      if ((col_p->kind == HPE_WCOL_BIT) || (col_p->kind == HPE_WCOL_NONE))
+      {
+         continue;
+      }
+
+      for (pp = 0; pp < col_p->width; pp++)
+      {
+         desc = (col_p->width == 2) ? col_p->cpt[pp] : col_p->desc;
+         off = pp * plan_p->size;
+
+         switch (col_p->kind)
          {
-            short cast_val; 
+            case HPE_WCOL_SHORT:
+               dmSetScalars_s(desc, (short*) buf[count] + off, first, nn);
+            break;
+
+            case HPE_WCOL_LONG:
+               dmSetScalars_l(desc, (long*) buf[count] + off, first, nn);
+            break;
 
-            pix_double_to_short(evt_p->chippos[HDET_PLANE_Y], FALSE,
-                                &cast_val); 
-            dmSetScalar_s(evtout_p->desc[count], cast_val);
+            default:
+               dmSetScalars_d(desc, (double*) buf[count] + off, first, nn);
+            break;
          }
-         break;
+      }
+   }
 
-         case HDET_CHIP:
+   /* bit columns- a row at a time */
+   for (count = 0, col_p = plan_p->col; count < plan_p->num_cols;
+        count++, col_p++)
+   {
+      if (col_p->kind == HPE_WCOL_BIT)
+      {
+         for (ii = 0; ii < nn; ii++)
          {
-            short casted_val[2];
- 
-            pix_double_to_short(evt_p->chippos[HDET_PLANE_X],
-                                FALSE, &casted_val[0]);
-            pix_double_to_short(evt_p->chippos[HDET_PLANE_Y],
-                                FALSE, &casted_val[1]);
- 
-            dmSetVector_s(evtout_p->desc[count], casted_val, 2);
-         } 
-         break;
-
-
-         case HDET_AMP_SF:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->amp_sf);
-         break;
-
-         case HDET_E_TRIG:
-            if (evtout_p->types[count] == dmBIT)
-            {
-               dmSetArray_bit(evtout_p->desc[count], &evt_p->e_trig, 1); 
-            } 
-            else
-            {
-               dmSetScalar_s(evtout_p->desc[count], evt_p->e_trig);
-            } 
-
-         break; 
-
-         case HDET_VETO_STT:
-            if (evtout_p->types[count] == dmBIT)
-            {
-               dmSetArray_bit(evtout_p->desc[count], &evt_p->veto_stt, 1);
-            }
-            else
-            {
-               dmSetScalar_s(evtout_p->desc[count], evt_p->veto_stt);
-            } 
-         break;
-
-         case HDET_SUBMJF:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->submjf);
-         break; 
-
-         case HDET_DET_ID:
-            if (evtout_p->types[count] == dmBIT)
-            {
-               dmSetArray_bit(evtout_p->desc[count], &evt_p->det_id, 1);
-            }
-            else
-            {
-               dmSetScalar_s(evtout_p->desc[count], evt_p->det_id);
-            } 
-         break; 
-
-         case HDET_STOPMNF:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->stopmnf);
-         break; 
-
-         case HDET_MRF:
-            dmSetScalar_s(evtout_p->desc[count], evt_p->mrf);
-         break; 
-
-         default:
-            /* unknown data field for output */
-            dsErrAdd(err_p, dsHPEWRITEEVTERR, Accumulation, Generic,
-               evtout_p->file);
-         break; 
-      } /* end switch */
-
-      count++;
-   } /* end while */
-
-   /* write out event */ 
-   dmTablePutRow(evtout_p->extension, NULL);
-}
+            dmTableSetRow(evtout_p->extension, first + ii);
+            dmSetArray_bit(col_p->desc,
+               (unsigned char*) buf[count] + (ii * col_p->width),
+               col_p->width);
+         }
+      }
+   }
+} /* end: write_event_rows */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine flush_hrc_events() writes the buffered rows of an output
+  event file, or queues them for the writer thread if the file has one.
+
+*************************************************************************/
+
+void flush_hrc_events(
+   EVENT_SETUP_P_T evtout_p)  /* I/O - output event file info         */
+{
+   HPE_WRITE_PLAN_P_T plan_p = evtout_p->plan;
+
+   if ((plan_p == NULL) || (plan_p->num_rows == 0))
+   {
+      return;
+   }
+
+   if (plan_p->async_p != NULL)
+   {
+      /* hands over plan_p->buf and sets a free one in its place */
+      queue_event_rows(evtout_p);
+   }
+   else
+   {
+      write_event_rows(evtout_p, plan_p->buf, plan_p->next_row,
+                       plan_p->num_rows);
+   }
+
+   plan_p->next_row += plan_p->num_rows;
+   plan_p->num_rows = 0;
+} /* end: flush_hrc_events */
+
+
+/*************************************************************************
+
+* DESCRIPTION
+
+  The routine deallocate_write_plan() frees the write plan and its row
+  buffers and sets the plan pointer to NULL. Rows still buffered are not
+  written (see flush_hrc_events()).
+
+*************************************************************************/
+
+void deallocate_write_plan(
+   HPE_WRITE_PLAN_P_T* plan_pp)  /* I/O - write plan pointer          */
+{
+   HPE_WRITE_PLAN_P_T plan_p = *plan_pp;
+
+   if (plan_p != NULL)
+   {
+      /* the writer queue owns the other buffer sets */
+      detach_event_writer(plan_p);
+      deallocate_write_buffers(plan_p, &plan_p->buf);
+
+      if (plan_p->col != NULL)
+      {
+         free(plan_p->col);
+      }
+      free(plan_p);
+      *plan_pp = NULL;
+   }
+} /* end: deallocate_write_plan */
+
+
+/*************************************************************************
+
+* DESCRIPTION
 
+  The routine write_hrc_events() stores an event in the row buffers of
+  the output file by running its write plan over the event record. The
+  buffered rows are written when the buffers are full.
+
+*************************************************************************/
+
+void write_hrc_events(
+   EVENT_SETUP_P_T evtout_p, /* I - output event file info              */
+   EVENT_REC_P_T   evt_p,    /* I - structure holding event data        */
+   dsErrList*      err_p)    /* O - error list pointer                  */
+{
+   HPE_WRITE_PLAN_P_T plan_p = evtout_p->plan;
+   HPE_WRITE_COL_P_T  col_p;
+   const char* src = (const char*) evt_p;
+   int count;
+
+   /* no plan if the output columns could not be set up */
+   if (plan_p == NULL)
+   {
+      return;
+   }
+
+   for (count = 0, col_p = plan_p->col; count < plan_p->num_cols;
+        count++, col_p++)
+   {
+      if (col_p->store != NULL)
+      {
+         col_p->store(plan_p->buf[count], plan_p->size, plan_p->num_rows,
+                      src + col_p->offset);
+      }
+      else
+      {
+         /* unknown data field for output */
+         dsErrAdd(err_p, dsHPEWRITEEVTERR, Accumulation, Generic,
+            evtout_p->file);
+      }
+   }
+
+   if (++plan_p->num_rows == plan_p->size)
+   {
+      flush_hrc_events(evtout_p);
+   }
+} /* end: write_hrc_events */